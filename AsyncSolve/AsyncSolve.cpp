@@ -0,0 +1,110 @@
+#define _USE_MATH_DEFINES
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <vector>
+#include <string>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "AsyncSolve.hpp"
+
+/**
+ * @brief Print the report of an asynchronous solve from its statistics.
+ */
+template <typename TScalar>
+void printSolveStats(const SolveStats &stats, TScalar residual, VerificationMode verification)
+{
+    std::cout << "Status: " << solveStatusName(stats.status) << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * stats.wall.count()) << std::endl;
+    if (stats.status == SolveStatus::Completed)
+    {
+        std::cout << "GFLOP/s: " << stats.gflops << std::endl;
+        printResidual(residual, verification);
+    }
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Factor A asynchronously while the calling thread prepares the right hand sides, then solve L^T * X = B
+ * asynchronously with the factor, and check the factor bit for bit against the blocking API.
+ */
+template <std::size_t N, std::size_t NBlock, std::size_t K>
+void overlapFactorAndPreparation(VerificationMode verification)
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    SolveHandle<Matrix<float, N, N>> factorization = choleskyAsync<float, N, NBlock>(mat);
+
+    auto preparationStart = std::chrono::steady_clock::now();
+    Matrix<float, N, K> rhs = randomNormal<float, N, K>(11828, NormalStream, 1.0);
+    std::chrono::duration<double> preparation = std::chrono::steady_clock::now() - preparationStart;
+    const double progressAfterPreparation = factorization.progress();
+
+    std::size_t polls = 0;
+    while (!factorization.waitFor(std::chrono::milliseconds(5)))
+    {
+        ++polls;
+    }
+    SolveOutcome<Matrix<float, N, N>> factored = factorization.get();
+
+    std::cout << "Asynchronous parallel Cholesky, N = " << N << ", p = " << N / NBlock << std::endl;
+    std::cout << "Right hand sides prepared meanwhile, milliseconds: " << (int)(1000 * preparation.count()) << std::endl;
+    std::cout << "Progress when they were ready: " << (int)(100 * progressAfterPreparation) << "%" << std::endl;
+    std::cout << "Polls before completion: " << polls << std::endl;
+    printSolveStats(factored.stats, choleskyResidual(mat, factored.result, verification), verification);
+    if (factored.stats.status != SolveStatus::Completed)
+    {
+        std::cout << "FATAL ERROR: asynchronous factorization did not complete" << std::endl;
+        return;
+    }
+
+    Matrix<float, N, N> blockingResult;
+    std::vector<WorkerTimes> times{};
+    choleskyParallel<float, N, NBlock>(mat, blockingResult, false, times);
+    std::cout << "Bitwise identical to the blocking API: " << (factored.result.bitwiseEquals(blockingResult) ? "yes" : "no") << std::endl;
+    std::cout << std::endl;
+
+    Matrix<float, N, N> upper = factored.result.transpose();
+    SolveHandle<Matrix<float, N, K>> solve = backSubstitutionAsync<float, N, NBlock / 2, K>(upper, rhs);
+    SolveOutcome<Matrix<float, N, K>> solved = solve.get();
+    std::cout << "Asynchronous parallel back substitution with L^T, N = " << N << ", K = " << K << std::endl;
+    printSolveStats(solved.stats, solveResidual(upper, rhs, solved.result, verification), verification);
+}
+
+/**
+ * @brief Cancel a factorization once it is a quarter done and measure how long it takes to return.
+ */
+template <std::size_t N, std::size_t NBlock>
+void cancelFactorization()
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    SolveHandle<Matrix<float, N, N>> factorization = choleskyAsync<float, N, NBlock>(mat);
+    while (factorization.progress() < 0.25 && !factorization.ready())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto cancelStart = std::chrono::steady_clock::now();
+    factorization.cancel();
+    SolveOutcome<Matrix<float, N, N>> outcome = factorization.get();
+    std::chrono::duration<double> latency = std::chrono::steady_clock::now() - cancelStart;
+
+    std::cout << "Cancelled parallel Cholesky, N = " << N << ", p = " << N / NBlock << std::endl;
+    std::cout << "Progress when cancelled: " << (int)(100 * factorization.progress()) << "%" << std::endl;
+    std::cout << "Cancellation latency milliseconds: " << (int)(1000 * latency.count()) << std::endl;
+    printSolveStats(outcome.stats, 0.0f, VerificationMode::None);
+}
+
+int main(int argc, char **argv)
+{
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+    std::cout << std::endl;
+    overlapFactorAndPreparation<1024, 256, 102>(verification);
+    cancelFactorization<2048, 512>();
+}
@@ -0,0 +1,189 @@
+#ifndef ASYNCSOLVEHPP
+#define ASYNCSOLVEHPP
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/SolveControl.hpp"
+#include "../CholeskyParallel/Cholesky.hpp"
+#include "../BackSubstitutionParallel/BackSubstitution.hpp"
+
+/**
+ * @brief How an asynchronous solve ended.
+ */
+enum class SolveStatus
+{
+    Completed,
+    Cancelled,
+    Failed
+};
+
+inline const char *solveStatusName(SolveStatus status)
+{
+    switch (status)
+    {
+    case SolveStatus::Completed:
+        return "completed";
+    case SolveStatus::Cancelled:
+        return "cancelled";
+    default:
+        return "failed";
+    }
+}
+
+/**
+ * @brief Timing of an asynchronous solve, measured on the thread that ran it.
+ */
+struct SolveStats
+{
+    SolveStatus status = SolveStatus::Failed;
+    std::chrono::duration<double> wall{};
+    /** @brief Useful floating-point operations per second, in billions; 0 unless the solve completed. */
+    double gflops = 0;
+    /** @brief Wall and CPU time of every worker thread, when the solver records them. */
+    std::vector<WorkerTimes> workerTimes{};
+};
+
+/**
+ * @brief The result of an asynchronous solve and its statistics; result is only meaningful if the solve completed.
+ */
+template <typename TResult>
+struct SolveOutcome
+{
+    TResult result;
+    SolveStats stats;
+};
+
+/**
+ * @brief Handle to a solve running on its own thread: poll it, watch its progress, cancel it, or collect it.
+ *
+ * ready() never blocks, so the handle can be polled from an event loop or wrapped in an awaiter. Destroying the
+ * handle of a running solve cancels it and waits for its threads to return.
+ */
+template <typename TResult>
+class SolveHandle
+{
+private:
+    std::shared_ptr<SolveControl> control;
+    std::future<SolveOutcome<TResult>> outcome;
+
+public:
+    SolveHandle(std::shared_ptr<SolveControl> control, std::future<SolveOutcome<TResult>> outcome) : control(std::move(control)), outcome(std::move(outcome)){};
+
+    SolveHandle(SolveHandle &&) = default;
+    SolveHandle &operator=(SolveHandle &&) = delete;
+
+    ~SolveHandle()
+    {
+        if (outcome.valid())
+        {
+            control->cancel();
+        }
+    };
+
+    /**
+     * @brief Whether get() would return without blocking.
+     */
+    bool ready() const
+    {
+        return outcome.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+
+    /**
+     * @brief Wait at most timeout; return whether the solve is done.
+     */
+    template <typename TRep, typename TPeriod>
+    bool waitFor(const std::chrono::duration<TRep, TPeriod> &timeout) const
+    {
+        return outcome.wait_for(timeout) == std::future_status::ready;
+    };
+
+    /**
+     * @brief The fraction of the solve done so far, in [0, 1].
+     */
+    double progress() const
+    {
+        return control->progress();
+    };
+
+    /**
+     * @brief Ask the solve to stop; get() then reports SolveStatus::Cancelled unless it had already finished.
+     */
+    void cancel()
+    {
+        control->cancel();
+    };
+
+    /**
+     * @brief Wait for the solve and return its outcome; may only be called once.
+     */
+    SolveOutcome<TResult> get()
+    {
+        return outcome.get();
+    };
+};
+
+/**
+ * @brief Start the parallel Cholesky factorization A = L * L^T (choleskyParallel) on its own thread and return at
+ * once; the factor is the result of the outcome.
+ *
+ * mat is moved into the solve, so the caller may reuse or free its own copy while the factorization runs.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+SolveHandle<Matrix<TScalar, N, N>> choleskyAsync(Matrix<TScalar, N, N> mat, bool deterministic = false)
+{
+    std::shared_ptr<SolveControl> control = std::make_shared<SolveControl>();
+    std::future<SolveOutcome<Matrix<TScalar, N, N>>> outcome = std::async(std::launch::async, [control, mat = std::move(mat), deterministic]()
+                                                                          {
+                                                                              SolveOutcome<Matrix<TScalar, N, N>> solved{};
+                                                                              auto timerStart = std::chrono::steady_clock::now();
+                                                                              const bool finished = choleskyParallel<TScalar, N, NBlock>(mat, solved.result, deterministic, solved.stats.workerTimes, control.get());
+                                                                              solved.stats.wall = std::chrono::steady_clock::now() - timerStart;
+                                                                              if (finished)
+                                                                              {
+                                                                                  solved.stats.status = SolveStatus::Completed;
+                                                                                  solved.stats.gflops = (double)N * N * N / 3.0 / solved.stats.wall.count() / 1e9;
+                                                                              }
+                                                                              else
+                                                                              {
+                                                                                  solved.stats.status = control->cancelled() ? SolveStatus::Cancelled : SolveStatus::Failed;
+                                                                              }
+                                                                              return solved;
+                                                                          });
+    return SolveHandle<Matrix<TScalar, N, N>>(control, std::move(outcome));
+}
+
+/**
+ * @brief Start the parallel back substitution A * X = B for upper-triangular A (backSubstitutionParallel) on its
+ * own thread and return at once; X is the result of the outcome.
+ *
+ * mat and rhs are moved into the solve.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
+SolveHandle<Matrix<TScalar, N, K>> backSubstitutionAsync(Matrix<TScalar, N, N> mat, Matrix<TScalar, N, K> rhs, bool deterministic = false)
+{
+    std::shared_ptr<SolveControl> control = std::make_shared<SolveControl>();
+    std::future<SolveOutcome<Matrix<TScalar, N, K>>> outcome = std::async(std::launch::async, [control, mat = std::move(mat), rhs = std::move(rhs), deterministic]()
+                                                                          {
+                                                                              SolveOutcome<Matrix<TScalar, N, K>> solved{};
+                                                                              auto timerStart = std::chrono::steady_clock::now();
+                                                                              const bool finished = backSubstitutionParallel<TScalar, N, NBlock, K>(mat, rhs, solved.result, deterministic, control.get());
+                                                                              solved.stats.wall = std::chrono::steady_clock::now() - timerStart;
+                                                                              if (finished)
+                                                                              {
+                                                                                  solved.stats.status = SolveStatus::Completed;
+                                                                                  solved.stats.gflops = (double)N * N * K / solved.stats.wall.count() / 1e9;
+                                                                              }
+                                                                              else
+                                                                              {
+                                                                                  solved.stats.status = control->cancelled() ? SolveStatus::Cancelled : SolveStatus::Failed;
+                                                                              }
+                                                                              return solved;
+                                                                          });
+    return SolveHandle<Matrix<TScalar, N, K>>(control, std::move(outcome));
+}
+
+#endif
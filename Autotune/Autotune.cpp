@@ -0,0 +1,141 @@
+#define _USE_MATH_DEFINES
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "Autotune.hpp"
+
+/**
+ * @brief Number of right hand sides the back substitution is tuned with.
+ */
+constexpr std::size_t tuningRhs = 16;
+
+void printMeasurements(const std::vector<TunedParameters> &measured)
+{
+    for (const TunedParameters &candidate : measured)
+    {
+        std::cout << "  ";
+        printParameters(candidate);
+        std::cout << ": " << candidate.milliseconds << " ms" << std::endl;
+    }
+}
+
+template <std::size_t N>
+void tuneSize(TuningProfile &profile, std::size_t repetitions)
+{
+    const Matrix<float, N, N> mat = wishart<float, N, N>(11828, 10.0, 1.0);
+    std::vector<TunedParameters> measured = measureCholeskyCandidates<float, N>(mat, repetitions);
+    TunedParameters fastest = fastestCandidate(measured);
+    std::cout << "Cholesky, N = " << N << std::endl;
+    printMeasurements(measured);
+    std::cout << "Fastest: ";
+    printParameters(fastest);
+    std::cout << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    profile.set("cholesky", N, fastest);
+
+    const Matrix<float, N, N> upper = randomUpperTriangular<float, N>(11828, 100.0);
+    const Matrix<float, N, tuningRhs> rhs = randomNormal<float, N, tuningRhs>(11828, NormalStream, 1.0);
+    measured = measureBackSubstitutionCandidates<float, N, tuningRhs>(upper, rhs, repetitions);
+    fastest = fastestCandidate(measured);
+    std::cout << "Back substitution, N = " << N << ", K = " << tuningRhs << std::endl;
+    printMeasurements(measured);
+    std::cout << "Fastest: ";
+    printParameters(fastest);
+    std::cout << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    profile.set("backsub", N, fastest);
+}
+
+/**
+ * @brief Sweep every candidate for every tuned size and write the winners to this machine's profile, keeping the
+ * entries of other sizes that are already in it.
+ */
+void tune(std::size_t repetitions)
+{
+    const std::string path = hostProfilePath();
+    TuningProfile profile;
+    profile.load(path);
+    std::cout << std::endl;
+    tuneSize<256>(profile, repetitions);
+    tuneSize<512>(profile, repetitions);
+    tuneSize<1024>(profile, repetitions);
+    profile.save(path);
+    std::cout << "Profile with " << profile.size() << " entries written to " << path << std::endl;
+}
+
+/**
+ * @brief Solve with the configurations of this machine's profile and report them.
+ */
+template <std::size_t N>
+void runTuned(VerificationMode verification)
+{
+    const Matrix<float, N, N> mat = wishart<float, N, N>(11828, 10.0, 1.0);
+    Matrix<float, N, N> factor;
+    auto timerStart = std::chrono::steady_clock::now();
+    const bool factored = tunedCholesky(mat, factor);
+    std::chrono::duration<double> milliseconds = std::chrono::steady_clock::now() - timerStart;
+    std::cout << "Tuned Cholesky, N = " << N << " (";
+    printParameters(tunedCholeskyParameters<N>());
+    std::cout << ")" << std::endl;
+    if (!factored)
+    {
+        std::cout << "FATAL ERROR: tuned Cholesky failed" << std::endl;
+        return;
+    }
+    std::cout << "Milliseconds: " << (int)(1000 * milliseconds.count()) << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / milliseconds.count() / 1e9 << std::endl;
+    printResidual(choleskyResidual(mat, factor, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+
+    const Matrix<float, N, N> upper = randomUpperTriangular<float, N>(11828, 100.0);
+    const Matrix<float, N, tuningRhs> rhs = randomNormal<float, N, tuningRhs>(11828, NormalStream, 1.0);
+    Matrix<float, N, tuningRhs> result;
+    timerStart = std::chrono::steady_clock::now();
+    const bool solved = tunedBackSubstitution(upper, rhs, result);
+    milliseconds = std::chrono::steady_clock::now() - timerStart;
+    std::cout << "Tuned back substitution, N = " << N << ", K = " << tuningRhs << " (";
+    printParameters(tunedBackSubstitutionParameters<N>());
+    std::cout << ")" << std::endl;
+    if (!solved)
+    {
+        std::cout << "FATAL ERROR: tuned back substitution failed" << std::endl;
+        return;
+    }
+    std::cout << "Milliseconds: " << (int)(1000 * milliseconds.count()) << std::endl;
+    printResidual(solveResidual(upper, rhs, result, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mode = (argc > 1) ? argv[1] : "tune";
+    try
+    {
+        if (mode == "tune")
+        {
+            tune(2);
+            return 0;
+        }
+        std::cout << std::endl;
+        std::cout << "Profile " << hostProfilePath() << ": " << hostProfile().size() << " entries" << std::endl;
+        std::cout << std::endl;
+        constexpr VerificationMode verification = VerificationMode::Freivalds;
+        runTuned<256>(verification);
+        runTuned<512>(verification);
+        runTuned<1024>(verification);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "FATAL ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+}
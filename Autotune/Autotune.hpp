@@ -0,0 +1,454 @@
+#ifndef AUTOTUNEHPP
+#define AUTOTUNEHPP
+
+#include <map>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <unistd.h>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../CholeskyParallel/Cholesky.hpp"
+#include "../CholeskyParallel/RecursiveCholesky.hpp"
+#include "../BackSubstitutionParallel/BackSubstitution.hpp"
+#include "../FactorCache/FactorCache.hpp"
+
+/**
+ * @brief The parameters of one solver configuration, and how long it took when it was tuned.
+ *
+ * variant names the algorithm: "contiguous" (choleskyParallel, p = threads blocks of block columns), "blockcyclic"
+ * (choleskyBlockCyclic, blocks of block columns dealt to threads workers), "recursive" (recursiveCholesky),
+ * "blocks" (backSubstitutionParallel, p = threads blocks of block rows) or "inplace" (upperTriangularSolve on all
+ * hardware threads).
+ */
+struct TunedParameters
+{
+    std::string variant;
+    /** @brief Columns (rows for "blocks") per block; 0 for "recursive" and "inplace". */
+    std::size_t block = 0;
+    /**
+     * @brief Worker threads for "contiguous", "blockcyclic" and "blocks". For "recursive" this is the task depth
+     * instead (up to 2^threads concurrent tasks); "inplace" ignores it.
+     */
+    std::size_t threads = 0;
+    double milliseconds = 0;
+};
+
+inline void printParameters(const TunedParameters &parameters)
+{
+    std::cout << parameters.variant << ", block " << parameters.block << ", threads " << parameters.threads;
+}
+
+/**
+ * @brief The fastest configuration of every tuned solver and matrix size on one machine, stored as a text file with
+ * one line "solver N variant block threads milliseconds" per entry ('#' starts a comment line).
+ */
+class TuningProfile
+{
+private:
+    std::map<std::pair<std::string, std::size_t>, TunedParameters> entries{};
+
+public:
+    void set(const std::string &solver, std::size_t n, const TunedParameters &parameters)
+    {
+        entries[std::make_pair(solver, n)] = parameters;
+    };
+
+    /**
+     * @brief Look up the configuration tuned for solver at size n.
+     *
+     * @return false if that size was not tuned.
+     */
+    bool find(const std::string &solver, std::size_t n, TunedParameters &parameters) const
+    {
+        auto found = entries.find(std::make_pair(solver, n));
+        if (found == entries.end())
+        {
+            return false;
+        }
+        parameters = found->second;
+        return true;
+    };
+
+    std::size_t size() const
+    {
+        return entries.size();
+    };
+
+    /**
+     * @brief Merge the entries of a profile file into this profile.
+     *
+     * @return false if the file does not exist; throws std::runtime_error on a malformed line.
+     */
+    bool load(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string solver;
+            std::size_t n;
+            TunedParameters parameters;
+            if (!(fields >> solver >> n >> parameters.variant >> parameters.block >> parameters.threads >> parameters.milliseconds))
+            {
+                throw std::runtime_error("malformed line in tuning profile " + path + ": " + line);
+            }
+            set(solver, n, parameters);
+        }
+        return true;
+    };
+
+    /**
+     * @brief Write the profile; throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string &path) const
+    {
+        std::ofstream file(path);
+        file << "# solver N variant block threads milliseconds" << std::endl;
+        for (const auto &entry : entries)
+        {
+            const TunedParameters &parameters = entry.second;
+            file << entry.first.first << " " << entry.first.second << " " << parameters.variant << " " << parameters.block << " " << parameters.threads << " " << parameters.milliseconds << std::endl;
+        }
+        if (!file)
+        {
+            throw std::runtime_error("cannot write tuning profile " + path);
+        }
+    };
+};
+
+inline std::string hostName()
+{
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0')
+    {
+        return "unknown-host";
+    }
+    return name;
+}
+
+/**
+ * @brief The profile file of this machine: $TUNING_PROFILE if set, else tuning-<hostname>.txt in the working
+ * directory.
+ */
+inline std::string hostProfilePath()
+{
+    const char *path = std::getenv("TUNING_PROFILE");
+    return (path != nullptr) ? std::string(path) : "tuning-" + hostName() + ".txt";
+}
+
+/**
+ * @brief The profile of this machine, loaded from hostProfilePath() on first use; empty if there is no file yet.
+ */
+inline const TuningProfile &hostProfile()
+{
+    static const TuningProfile profile = []()
+    {
+        TuningProfile loaded;
+        loaded.load(hostProfilePath());
+        return loaded;
+    }();
+    return profile;
+}
+
+/**
+ * @brief Thread counts tried by the tuner: powers of two up to 8, and the hardware thread count.
+ */
+inline std::vector<std::size_t> tuningThreadCounts()
+{
+    std::vector<std::size_t> counts{1, 2, 4, 8};
+    const std::size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (std::find(counts.begin(), counts.end(), hardwareThreads) == counts.end())
+    {
+        counts.push_back(hardwareThreads);
+    }
+    return counts;
+}
+
+/**
+ * @brief Block widths the block-cyclic Cholesky is compiled for; runCholeskyVariant dispatches on them.
+ */
+constexpr std::size_t tunedCyclicBlocks[] = {16, 32, 64};
+
+/**
+ * @brief Factor A = L * L^T with the given configuration; only configurations produced by choleskyCandidates are
+ * compiled in.
+ *
+ * @return false if the configuration is not available for N or the factorization failed.
+ */
+template <typename TScalar, std::size_t N>
+bool runCholeskyVariant(const TunedParameters &parameters, const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result)
+{
+    static_assert(N % 64 == 0, "Tuned sizes must be multiples of 64");
+    std::vector<WorkerTimes> times{};
+    if (parameters.variant == "contiguous" && parameters.block * parameters.threads == N)
+    {
+        switch (parameters.threads)
+        {
+        case 2:
+            return choleskyParallel<TScalar, N, N / 2>(mat, result, false, times);
+        case 4:
+            return choleskyParallel<TScalar, N, N / 4>(mat, result, false, times);
+        case 8:
+            return choleskyParallel<TScalar, N, N / 8>(mat, result, false, times);
+        }
+    }
+    if (parameters.variant == "blockcyclic" && parameters.threads != 0)
+    {
+        switch (parameters.block)
+        {
+        case 16:
+            choleskyBlockCyclic<TScalar, N, 16>(mat, result, parameters.threads, false, times);
+            return true;
+        case 32:
+            choleskyBlockCyclic<TScalar, N, 32>(mat, result, parameters.threads, false, times);
+            return true;
+        case 64:
+            choleskyBlockCyclic<TScalar, N, 64>(mat, result, parameters.threads, false, times);
+            return true;
+        }
+    }
+    if (parameters.variant == "recursive")
+    {
+        return recursiveCholesky(mat, result, parameters.threads);
+    }
+    return false;
+}
+
+/**
+ * @brief Every configuration the tuner tries for the Cholesky factorization at size N.
+ */
+template <std::size_t N>
+std::vector<TunedParameters> choleskyCandidates()
+{
+    std::vector<TunedParameters> candidates{};
+    for (std::size_t p : {2, 4, 8})
+    {
+        candidates.push_back(TunedParameters{"contiguous", N / p, p});
+    }
+    for (std::size_t block : tunedCyclicBlocks)
+    {
+        for (std::size_t threads : tuningThreadCounts())
+        {
+            candidates.push_back(TunedParameters{"blockcyclic", block, threads});
+        }
+    }
+    for (std::size_t taskDepth = 0; taskDepth <= 3; ++taskDepth)
+    {
+        candidates.push_back(TunedParameters{"recursive", 0, taskDepth});
+    }
+    return candidates;
+}
+
+/**
+ * @brief The default Cholesky configuration for sizes without a profile entry.
+ */
+inline TunedParameters defaultCholeskyParameters()
+{
+    return TunedParameters{"recursive", 0, defaultRecursiveTaskDepth};
+}
+
+/**
+ * @brief Solve A * X = B for upper-triangular A with the given configuration (see runCholeskyVariant).
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+bool runBackSubstitutionVariant(const TunedParameters &parameters, const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    if (parameters.variant == "blocks" && parameters.block * parameters.threads == N)
+    {
+        switch (parameters.threads)
+        {
+        case 2:
+            return backSubstitutionParallel<TScalar, N, N / 2, K>(mat, rhs, result);
+        case 4:
+            return backSubstitutionParallel<TScalar, N, N / 4, K>(mat, rhs, result);
+        case 8:
+            return backSubstitutionParallel<TScalar, N, N / 8, K>(mat, rhs, result);
+        }
+    }
+    if (parameters.variant == "inplace")
+    {
+        upperTriangularSolve(mat, rhs, result);
+        return true;
+    }
+    return false;
+}
+
+template <std::size_t N>
+std::vector<TunedParameters> backSubstitutionCandidates()
+{
+    std::vector<TunedParameters> candidates{};
+    for (std::size_t p : {2, 4, 8})
+    {
+        candidates.push_back(TunedParameters{"blocks", N / p, p});
+    }
+    candidates.push_back(TunedParameters{"inplace", 0, 0});
+    return candidates;
+}
+
+inline TunedParameters defaultBackSubstitutionParameters()
+{
+    return TunedParameters{"inplace", 0, 0};
+}
+
+/**
+ * @brief Results with a larger percent residual than this are rejected by the tuner as broken.
+ */
+constexpr double tuningResidualLimit = 1.0;
+
+/**
+ * @brief Time every Cholesky candidate on mat, best of repetitions runs each.
+ *
+ * @return The candidates with their milliseconds; infinity for candidates that failed or gave a wrong factor.
+ */
+template <typename TScalar, std::size_t N>
+std::vector<TunedParameters> measureCholeskyCandidates(const Matrix<TScalar, N, N> &mat, std::size_t repetitions)
+{
+    std::vector<TunedParameters> candidates = choleskyCandidates<N>();
+    for (TunedParameters &candidate : candidates)
+    {
+        candidate.milliseconds = std::numeric_limits<double>::infinity();
+        for (std::size_t repetition = 0; repetition != repetitions; ++repetition)
+        {
+            Matrix<TScalar, N, N> result;
+            auto timerStart = std::chrono::steady_clock::now();
+            const bool succeeded = runCholeskyVariant(candidate, mat, result);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timerStart;
+            if (!succeeded || !(choleskyResidual(mat, result, VerificationMode::Freivalds) < tuningResidualLimit))
+            {
+                candidate.milliseconds = std::numeric_limits<double>::infinity();
+                break;
+            }
+            candidate.milliseconds = std::min(candidate.milliseconds, 1000 * elapsed.count());
+        }
+    }
+    return candidates;
+}
+
+/**
+ * @brief Time every back substitution candidate on mat and rhs (see measureCholeskyCandidates).
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+std::vector<TunedParameters> measureBackSubstitutionCandidates(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, std::size_t repetitions)
+{
+    std::vector<TunedParameters> candidates = backSubstitutionCandidates<N>();
+    for (TunedParameters &candidate : candidates)
+    {
+        candidate.milliseconds = std::numeric_limits<double>::infinity();
+        for (std::size_t repetition = 0; repetition != repetitions; ++repetition)
+        {
+            Matrix<TScalar, N, K> result;
+            auto timerStart = std::chrono::steady_clock::now();
+            const bool succeeded = runBackSubstitutionVariant(candidate, mat, rhs, result);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timerStart;
+            if (!succeeded || !(solveResidual(mat, rhs, result, VerificationMode::Freivalds) < tuningResidualLimit))
+            {
+                candidate.milliseconds = std::numeric_limits<double>::infinity();
+                break;
+            }
+            candidate.milliseconds = std::min(candidate.milliseconds, 1000 * elapsed.count());
+        }
+    }
+    return candidates;
+}
+
+/**
+ * @brief The fastest of the measured candidates.
+ */
+inline TunedParameters fastestCandidate(const std::vector<TunedParameters> &measured)
+{
+    return *std::min_element(measured.begin(), measured.end(), [](const TunedParameters &a, const TunedParameters &b)
+                             { return a.milliseconds < b.milliseconds; });
+}
+
+/**
+ * @brief Whether parameters name one of the candidates (variant, block and threads; the time is ignored).
+ */
+inline bool isCandidate(const std::vector<TunedParameters> &candidates, const TunedParameters &parameters)
+{
+    return std::any_of(candidates.begin(), candidates.end(), [&parameters](const TunedParameters &candidate)
+                       { return candidate.variant == parameters.variant && candidate.block == parameters.block && candidate.threads == parameters.threads; });
+}
+
+/**
+ * @brief Look up the Cholesky configuration tuned for size N in this machine's profile.
+ *
+ * @return false if N was not tuned, or its entry names a configuration that is not compiled in.
+ */
+template <std::size_t N>
+bool findTunedCholeskyParameters(TunedParameters &parameters)
+{
+    return hostProfile().find("cholesky", N, parameters) && isCandidate(choleskyCandidates<N>(), parameters);
+}
+
+template <std::size_t N>
+bool findTunedBackSubstitutionParameters(TunedParameters &parameters)
+{
+    return hostProfile().find("backsub", N, parameters) && isCandidate(backSubstitutionCandidates<N>(), parameters);
+}
+
+/**
+ * @brief The Cholesky configuration for size N: the one in this machine's profile if it is compiled in, else the
+ * default.
+ */
+template <std::size_t N>
+TunedParameters tunedCholeskyParameters()
+{
+    TunedParameters parameters;
+    if (findTunedCholeskyParameters<N>(parameters))
+    {
+        return parameters;
+    }
+    return defaultCholeskyParameters();
+}
+
+template <std::size_t N>
+TunedParameters tunedBackSubstitutionParameters()
+{
+    TunedParameters parameters;
+    if (findTunedBackSubstitutionParameters<N>(parameters))
+    {
+        return parameters;
+    }
+    return defaultBackSubstitutionParameters();
+}
+
+/**
+ * @brief Factor A = L * L^T with the configuration tuned for N on this machine, or the default if N was not tuned.
+ */
+template <typename TScalar, std::size_t N>
+bool tunedCholesky(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result)
+{
+    return runCholeskyVariant(tunedCholeskyParameters<N>(), mat, result);
+}
+
+/**
+ * @brief Solve A * X = B for upper-triangular A with the configuration tuned for N on this machine, or the default.
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+bool tunedBackSubstitution(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    return runBackSubstitutionVariant(tunedBackSubstitutionParameters<N>(), mat, rhs, result);
+}
+
+#endif
@@ -1,7 +1,10 @@
 #include <iostream>
 #include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <omp.h>
-#include "include\Matrix.hpp"
 using namespace std;
 using namespace std::chrono;
 
@@ -14,20 +17,40 @@ int** createRightHandSide2(int row);
 
 void backSubstitutionSeq(int** m, int** rhs, double** result,int mRow,int mCol);
 void backSubstitutionParallel(int** m, int** rhs, double** result, int mRow);
-
-int main(){
-    int n = 20000; 
+void backSubstitutionBlocked(int** m, int** rhs, double** result, int mRow, int blockSize);
+double maxRelativeDifference(double** a, double** b, int row);
+
+//Usage: bSubP [n] [blockSize]
+int main(int argc, char** argv){
+    int n = (argc > 1) ? atoi(argv[1]) : 20000;
+    int blockSize = (argc > 2) ? atoi(argv[2]) : 1024;
+    if(n <= 0 || blockSize <= 0){
+        cout << "Usage: bSubP [n] [blockSize], with n > 0 and blockSize > 0" << endl;
+        return 1;
+    }
     int** m = createUpperTriangleMatrix(n,n);
     int** rhs = createRightHandSide2(n);
     double** result = resultArray(n);
-    
+    double** reference = resultArray(n);
+    cout << "n = " << n << ", block size = " << blockSize << ", threads = " << omp_get_max_threads() << endl;
 
     auto start = high_resolution_clock::now();
-    //backSubstitutionSeq(m,rhs,result,n,n);
-    backSubstitutionParallel(m,rhs,result,n);
+    backSubstitutionSeq(m,rhs,reference,n,n);
     auto stop = high_resolution_clock::now();
     auto duration = duration_cast<milliseconds>(stop - start);
-    cout << "Back Sub Parallel ms " << duration.count() <<endl;
+    cout << "Back Sub Sequential ms " << duration.count() <<endl;
+
+    start = high_resolution_clock::now();
+    backSubstitutionParallel(m,rhs,result,n);
+    stop = high_resolution_clock::now();
+    duration = duration_cast<milliseconds>(stop - start);
+    cout << "Back Sub Parallel ms " << duration.count() << " (max relative difference to sequential " << maxRelativeDifference(result,reference,n) << ")" <<endl;
+
+    start = high_resolution_clock::now();
+    backSubstitutionBlocked(m,rhs,result,n,blockSize);
+    stop = high_resolution_clock::now();
+    duration = duration_cast<milliseconds>(stop - start);
+    cout << "Back Sub Blocked ms " << duration.count() << " (max relative difference to sequential " << maxRelativeDifference(result,reference,n) << ")" <<endl;
 
 
     /*
@@ -58,6 +81,57 @@ void backSubstitutionParallel(int** m, int** rhs, double** result, int mRow){
     }
 }
 
+//Blocked column-oriented back substitution in a single parallel region.
+//Going up the diagonal blocks: one thread solves the diagonal block, then all threads subtract the
+//block's contribution from the rows above it. Row r of that update reads m[r][first..last), which is
+//contiguous, and the solution is kept in a contiguous vector rather than in the rows of result.
+void backSubstitutionBlocked(int** m, int** rhs, double** result, int mRow, int blockSize){
+    vector<double> x(mRow);
+    for(int v=0; v < mRow; v++){
+        x[v] = rhs[v][0];
+    }
+    int nBlocks = (mRow + blockSize - 1) / blockSize;
+    #pragma omp parallel shared(m,x)
+    {
+        for(int b = nBlocks - 1; b > -1; b--){
+            int first = b * blockSize;
+            int last = min(first + blockSize, mRow);
+            #pragma omp single
+            {
+                for(int i = last - 1; i >= first; i--){
+                    double sum = x[i];
+                    for(int j = i + 1; j < last; j++){
+                        sum -= m[i][j] * x[j];
+                    }
+                    x[i] = sum / m[i][i];
+                }
+            }
+            #pragma omp for schedule(static)
+            for(int r = 0; r < first; r++){
+                const int* row = m[r];
+                double sum = 0;
+                #pragma omp simd reduction(+:sum)
+                for(int j = first; j < last; j++){
+                    sum += row[j] * x[j];
+                }
+                x[r] -= sum;
+            }
+        }
+    }
+    for(int v=0; v < mRow; v++){
+        result[v][0] = x[v];
+    }
+}
+
+double maxRelativeDifference(double** a, double** b, int row){
+    double maxDiff = 0;
+    for(int i = 0; i < row; i++){
+        double scale = max(fabs(b[i][0]), 1.0);
+        maxDiff = max(maxDiff, fabs(a[i][0] - b[i][0]) / scale);
+    }
+    return maxDiff;
+}
+
 void backSubstitutionSeq(int** m, int** rhs, double** result,int mRow,int mCol){
     for(int i = mRow -1; i > -1; i--){
         double sumPrev = 0;
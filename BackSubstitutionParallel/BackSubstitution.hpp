@@ -0,0 +1,168 @@
+#ifndef BACKSUBSTITUTIONHPP
+#define BACKSUBSTITUTIONHPP
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <optional>
+
+#include "../MessageQueue/MessageQueue.hpp"
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/FloatingPoint.hpp"
+#include "../Matrix/SolveControl.hpp"
+
+/**
+ * @brief Compute one block in the parallel back substitution. The block shape is N by NBlock; NBlock must divide N. Supports any number of right-hand sides.
+ * 
+ * @tparam TScalar The scalar type (should usually be float or double -- int will not work)
+ * @tparam N Matrix size
+ * @tparam NBlock Number of columns in this block. Must divide N.
+ * @tparam K Number of right hand sides
+ * @param blockIndex The zero-based index of this block (top to bottom).
+ * @param mat Should be initialized with the corresponding block of the upper-triangular matrix A.
+ * @param rhs The block of the right hand side.
+ * @param messageQueue The queue for communication across threads. The unknowns of this block are tagged with
+ * blockIndex, and the block subscribes to the tags of the blocks below it only.
+ * @param populateResult Whether to skip messaging and simply populate the result vectors for this block (for sequential solve).
+ * @param deterministic Whether to apply the updates to every unknown in descending column order. The messages
+ * already arrive in a fixed order (block j only publishes after it has heard from every block below it), so with
+ * this order each unknown sees exactly the same sequence of operations for any NBlock, and the result is bitwise
+ * identical to the sequential solve. Also fixes the floating-point environment of the thread.
+ * @param result The result vectors
+ * @param control If not null, advanced by NBlock steps (one per unknown) when this block is solved; when cancelled,
+ * the block returns while waiting for a message, without publishing its unknowns.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
+void backSubBlockIter(std::size_t blockIndex, Matrix<TScalar, NBlock, N> mat, Matrix<TScalar, NBlock, K> rhs, MessageQueue<Matrix<TScalar, NBlock, K>> &messageQueue, bool populateResult, bool deterministic, Matrix<TScalar, N, K> &result, SolveControl *control = nullptr)
+{
+    // Each block already runs on its own thread; keep the Matrix kernels it calls on this thread.
+    SequentialKernelsGuard sequentialKernels;
+    std::optional<DeterministicFloatingPointScope> floatingPointScope;
+    if (deterministic)
+    {
+        floatingPointScope.emplace();
+    }
+    // Only the blocks below publish unknowns this block needs; they tag them with their block index.
+    Client<Matrix<TScalar, NBlock, K>> client = messageQueue.getClient([blockIndex](std::size_t tag)
+                                                                       { return tag > blockIndex; });
+    std::size_t firstIdx = NBlock * blockIndex;
+    std::size_t p = N / NBlock;
+    Matrix<TScalar, NBlock, K> subcolumn([mat, rhs, firstIdx](std::size_t rowIdx, std::size_t colIdx)
+                                         { return rhs.get(rowIdx, colIdx) / mat.get(rowIdx, rowIdx + firstIdx); });
+
+    for (std::size_t k = 0; k != p - 1 - blockIndex; ++k)
+    {
+        std::size_t incomingBlockIndex = p - 1 - k;
+        std::size_t incomingFirstIdx = NBlock * incomingBlockIndex;
+
+        while (!messageQueue.hasNext(client))
+        {
+            if (control && control->cancelled())
+            {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+
+        Matrix<TScalar, NBlock, K> values = messageQueue.next(client);
+
+        for (std::size_t n = 0; n != K; ++n)
+        {
+            for (std::size_t step = 0; step != NBlock; ++step)
+            {
+                std::size_t i = deterministic ? NBlock - 1 - step : step;
+                TScalar val = values.get(i, n);
+                std::size_t valIdx = incomingFirstIdx + i;
+                for (std::size_t j = 0; j != NBlock; ++j)
+                {
+                    TScalar cur = subcolumn.get(j, n);
+                    TScalar update = val * mat.get(j, valIdx) / mat.get(j, j + firstIdx);
+                    subcolumn.set(j, n, cur - update);
+                }
+            }
+        }
+    }
+
+    for (std::size_t n = 0; n != K; ++n)
+    {
+        for (std::size_t i = 0; i != NBlock; ++i)
+        {
+            std::size_t idx = NBlock - 1 - i;
+            TScalar nextVal = subcolumn.get(idx, n);
+            for (std::size_t step = 0; step != NBlock - 1 - idx; ++step)
+            {
+                std::size_t j = deterministic ? NBlock - 1 - step : idx + 1 + step;
+                TScalar update = subcolumn.get(j, n) * mat.get(idx, j + firstIdx) / mat.get(idx, idx + firstIdx);
+                nextVal -= update;
+            }
+            if (populateResult)
+            {
+                result.set(idx + firstIdx, n, nextVal);
+            }
+            subcolumn.set(idx, n, nextVal);
+        }
+    }
+
+    if (!populateResult)
+    {
+        messageQueue.enqueue(subcolumn, client, blockIndex);
+    }
+    if (control)
+    {
+        control->advance(NBlock);
+    }
+}
+
+/**
+ * @brief Solve A * X = B for upper-triangular A with N / NBlock block threads and assemble X; no timing or output.
+ *
+ * Only the upper triangle of A is read, so A may also hold other data below the diagonal (e.g. the L of an LU
+ * factorization).
+ *
+ * @param control If not null, receives N steps of progress (one per unknown) and can cancel the solve.
+ * @return Whether every block reported back, i.e. the solve was neither cancelled nor aborted.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
+bool backSubstitutionParallel(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result, bool deterministic = false, SolveControl *control = nullptr)
+{
+    if (control)
+    {
+        control->start(N);
+    }
+    MessageQueue<Matrix<TScalar, NBlock, K>> messageQueue;
+    Client<Matrix<TScalar, NBlock, K>> client = messageQueue.getClient();
+    const std::size_t p = N / NBlock;
+
+    std::vector<std::thread> threads{};
+    for (std::size_t i = 0; i != p; ++i)
+    {
+        std::size_t firstIdx = i * NBlock;
+        Matrix<TScalar, NBlock, N> submatrix;
+        mat.rowsInto(firstIdx, submatrix);
+        Matrix<TScalar, NBlock, K> subrhs;
+        rhs.rowsInto(firstIdx, subrhs);
+
+        std::thread thread = std::thread(backSubBlockIter<TScalar, N, NBlock, K>, i, submatrix, subrhs, std::ref(messageQueue), false, deterministic, std::ref(result), control);
+        threads.push_back(std::move(thread));
+    }
+
+    for (std::size_t i = 0; i != p; ++i)
+    {
+        threads[i].join();
+    }
+
+    for (std::size_t i = 0; i != p; ++i)
+    {
+        std::size_t blockIndex = p - 1 - i;
+        if (!messageQueue.hasNext(client))
+        {
+            return false;
+        }
+
+        const Matrix<TScalar, NBlock, K> values = messageQueue.next(client);
+        result.overwriteSubmatrix(values, NBlock * blockIndex, 0);
+    }
+    return true;
+}
+
+#endif
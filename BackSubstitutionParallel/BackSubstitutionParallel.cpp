@@ -5,186 +5,94 @@
 #include <thread>
 #include <cmath>
 #include <vector>
-#include <random>
+#include <optional>
+#include <string>
 
 #include "../MessageQueue/MessageQueue.hpp"
 #include "../Matrix/Matrix.hpp"
-
-/**
- * @brief Compute one block in the parallel back substitution. The block shape is N by NBlock; NBlock must divide N. Supports any number of right-hand sides.
- * 
- * @tparam TScalar The scalar type (should usually be float or double -- int will not work)
- * @tparam N Matrix size
- * @tparam NBlock Number of columns in this block. Must divide N.
- * @tparam K Number of right hand sides
- * @param blockIndex The zero-based index of this block (top to bottom).
- * @param mat Should be initialized with the corresponding block of the upper-triangular matrix A.
- * @param rhs The block of the right hand side.
- * @param messageQueue The queue for communication across threads.
- * @param populateResult Whether to skip messaging and simply populate the result vectors for this block (for sequential solve).
- * @param result The result vectors
- */
-template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
-void backSubBlockIter(std::size_t blockIndex, Matrix<TScalar, NBlock, N> mat, Matrix<TScalar, NBlock, K> rhs, MessageQueue<Matrix<TScalar, NBlock, K>> &messageQueue, bool populateResult, Matrix<TScalar, N, K> &result)
-{
-    Client<Matrix<TScalar, NBlock, K>> client = messageQueue.getClient();
-    std::size_t firstIdx = NBlock * blockIndex;
-    std::size_t p = N / NBlock;
-    Matrix<TScalar, NBlock, K> subcolumn([mat, rhs, firstIdx](std::size_t rowIdx, std::size_t colIdx)
-                                         { return rhs.get(rowIdx, colIdx) / mat.get(rowIdx, rowIdx + firstIdx); });
-
-    for (std::size_t k = 0; k != p - 1 - blockIndex; ++k)
-    {
-        std::size_t incomingBlockIndex = p - 1 - k;
-        std::size_t incomingFirstIdx = NBlock * incomingBlockIndex;
-
-        while (!messageQueue.hasNext(client))
-        {
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-        }
-
-        Matrix<TScalar, NBlock, K> values = messageQueue.next(client);
-
-        for (std::size_t n = 0; n != K; ++n)
-        {
-            for (std::size_t i = 0; i != NBlock; ++i)
-            {
-                TScalar val = values.get(i, n);
-                std::size_t valIdx = incomingFirstIdx + i;
-                for (std::size_t j = 0; j != NBlock; ++j)
-                {
-                    TScalar cur = subcolumn.get(j, n);
-                    TScalar update = val * mat.get(j, valIdx) / mat.get(j, j + firstIdx);
-                    subcolumn.set(j, n, cur - update);
-                }
-            }
-        }
-    }
-
-    for (std::size_t n = 0; n != K; ++n)
-    {
-        for (std::size_t i = 0; i != NBlock; ++i)
-        {
-            std::size_t idx = NBlock - 1 - i;
-            TScalar nextVal = subcolumn.get(idx, n);
-            for (std::size_t j = idx + 1; j != NBlock; ++j)
-            {
-                TScalar update = subcolumn.get(j, n) * mat.get(idx, j + firstIdx) / mat.get(idx, idx + firstIdx);
-                nextVal -= update;
-            }
-            if (populateResult)
-            {
-                result.set(idx + firstIdx, n, nextVal);
-            }
-            subcolumn.set(idx, n, nextVal);
-        }
-    }
-
-    if (!populateResult)
-    {
-        messageQueue.enqueue(subcolumn, client);
-    }
-}
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/FloatingPoint.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../Matrix/PerfCounters.hpp"
+#include "BackSubstitution.hpp"
+#include "../Autotune/Autotune.hpp"
 
 template <typename TScalar, std::size_t N, std::size_t K>
-void computeBackSubstitutionSequential(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+void computeBackSubstitutionSequential(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result, VerificationMode verification, bool deterministic = false)
 {
     auto timerStart = std::chrono::steady_clock::now();
+    PerfCounters counters(perfCountersRequested(), true);
     MessageQueue<Matrix<TScalar, N, K>> messageQueue;
-    backSubBlockIter<TScalar, N, N>(0, mat, rhs, messageQueue, true, result);
+    backSubBlockIter<TScalar, N, N>(0, mat, rhs, messageQueue, true, deterministic, result);
+    const PerfCounts counts = counters.read();
     auto timerStop = std::chrono::steady_clock::now();
     std::chrono::duration<double> milliseconds = timerStop - timerStart;
     int count = 1000 * milliseconds.count();
 
-    Matrix<TScalar, N, K> computed;
-    mat.multiplyRight(result, computed);
-    computed.add(rhs, -1.0);
-    TScalar frobResidual = computed.frobNorm();
-    TScalar frobRhs = rhs.frobNorm();
-    TScalar frobFractional = 100.0 * frobResidual / frobRhs;
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = solveResidual(mat, rhs, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
 
-    std::cout << "Sequential Back Substitution, N = " << N << ", K = " << K << std::endl;
+    std::cout << "Sequential Back Substitution, N = " << N << ", K = " << K << (deterministic ? " (deterministic)" : "") << std::endl;
     std::cout << "Milliseconds: " << count << std::endl;
-    std::cout << "Percent residual (Frobenius): " << frobFractional << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * K / milliseconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, (double)N * N * K);
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
     std::cout << "---------------------------" << std::endl;
     std::cout << std::endl;
 }
 
 template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
-void computeBackSubstitutionParallel(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+void computeBackSubstitutionParallel(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result, VerificationMode verification, bool deterministic = false)
 {
-    MessageQueue<Matrix<TScalar, NBlock, K>> messageQueue;
-    Client<Matrix<TScalar, NBlock, K>> client = messageQueue.getClient();
     const std::size_t p = N / NBlock;
 
     auto timerStart = std::chrono::steady_clock::now();
+    PerfCounters counters(perfCountersRequested(), true);
 
-    std::vector<std::thread> threads{};
-    for (std::size_t i = 0; i != p; ++i)
+    if (!backSubstitutionParallel<TScalar, N, NBlock, K>(mat, rhs, result, deterministic))
     {
-        std::size_t firstIdx = i * NBlock;
-        Matrix<TScalar, NBlock, N> submatrix;
-        mat.rowsInto(firstIdx, submatrix);
-        Matrix<TScalar, NBlock, K> subrhs;
-        rhs.rowsInto(firstIdx, subrhs);
-
-        std::thread thread = std::thread(backSubBlockIter<TScalar, N, NBlock, K>, i, submatrix, subrhs, std::ref(messageQueue), false, std::ref(result));
-        threads.push_back(std::move(thread));
-    }
-
-    for (std::size_t i = 0; i != p; ++i)
-    {
-        threads[i].join();
-    }
-
-    for (std::size_t i = 0; i != p; ++i)
-    {
-        std::size_t blockIndex = p - 1 - i;
-        if (!messageQueue.hasNext(client))
-        {
-            std::cout << "FATAL ERROR: parallel chol alg aborted unexpectedly" << std::endl;
-            return;
-        }
-
-        const Matrix<TScalar, NBlock, K> values = messageQueue.next(client);
-        result.overwriteSubmatrix(values, NBlock * blockIndex, 0);
+        std::cout << "FATAL ERROR: parallel chol alg aborted unexpectedly" << std::endl;
+        return;
     }
 
+    const PerfCounts counts = counters.read();
     auto timerStop = std::chrono::steady_clock::now();
     std::chrono::duration<double> milliseconds = timerStop - timerStart;
     int count = 1000 * milliseconds.count();
 
-    Matrix<TScalar, N, K> computed;
-    mat.multiplyRight(result, computed);
-    computed.add(rhs, -1.0);
-    TScalar frobResidual = computed.frobNorm();
-    TScalar frobRhs = rhs.frobNorm();
-    TScalar frobFractional = 100.0 * frobResidual / frobRhs;
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = solveResidual(mat, rhs, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
 
-    std::cout << "Parallel Back Substitution, N = " << N << ", K = " << K << ", p = " << p << std::endl;
+    std::cout << "Parallel Back Substitution, N = " << N << ", K = " << K << ", p = " << p << (deterministic ? " (deterministic)" : "") << std::endl;
     std::cout << "Milliseconds: " << count << std::endl;
-    std::cout << "Percent residual (Frobenius): " << frobFractional << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * K / milliseconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, (double)N * N * K);
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
     std::cout << "---------------------------" << std::endl;
     std::cout << std::endl;
 }
 
+template <std::size_t N, std::size_t K>
+void generateBackSubstitutionInputs(Matrix<float, N, N> &mat, Matrix<float, N, K> &rhs)
+{
+    mat = randomUpperTriangular<float, N>(11828, 100.0);
+    rhs = randomNormal<float, N, K>(11828, NormalStream, 1.0);
+}
+
 template <std::size_t N, std::size_t NBlock, std::size_t K>
-void calculateBackSubstitution(bool useParallel)
+void calculateBackSubstitution(bool useParallel, VerificationMode verification)
 {
-    std::mt19937 rng;
-    rng.seed(11828);
-    std::normal_distribution<float> normal_dist(0.0, 1.0 / N);
-    Matrix<float, N, N> mat([rng, normal_dist](std::size_t rowIdx, std::size_t colIdx) mutable
-                            {
-                                if (rowIdx > colIdx)
-                                {
-                                    return (float)0;
-                                }
-                                float val = normal_dist(rng);
-                                return (rowIdx == colIdx) ? (val + 1) : val;
-                            });
-    Matrix<float, N, K> rhs([rng, normal_dist](std::size_t rowIdx, std::size_t colIdx) mutable
-                            { return (float)(normal_dist(rng) * N); });
+    Matrix<float, N, N> mat;
+    Matrix<float, N, K> rhs;
+    generateBackSubstitutionInputs(mat, rhs);
     std::cout << std::endl;
     std::cout << "---------------------------" << std::endl;
     std::cout << "Matrix entry-wise sample standard deviation: " << mat.sample_dev() << std::endl;
@@ -193,29 +101,101 @@ void calculateBackSubstitution(bool useParallel)
     Matrix<float, N, K> result;
     if (useParallel)
     {
-        computeBackSubstitutionParallel<float, N, NBlock, K>(mat, rhs, result);
+        computeBackSubstitutionParallel<float, N, NBlock, K>(mat, rhs, result, verification);
     }
     else
     {
-        computeBackSubstitutionSequential<float, N, K>(mat, rhs, result);
+        computeBackSubstitutionSequential<float, N, K>(mat, rhs, result, verification);
     }
     std::cout << std::endl;
 }
 
-int main()
+template <std::size_t N, std::size_t NBlock, std::size_t K>
+void compareParallelWithSequential(const Matrix<float, N, N> &mat, const Matrix<float, N, K> &rhs, const Matrix<float, N, K> &sequentialResult, bool deterministic)
+{
+    Matrix<float, N, K> result;
+    computeBackSubstitutionParallel<float, N, NBlock, K>(mat, rhs, result, VerificationMode::None, deterministic);
+    std::cout << "Bitwise identical to sequential: " << (result.bitwiseEquals(sequentialResult) ? "yes" : "no") << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Time the free-running and the deterministic modes for several p, and check each parallel result bit for bit against the sequential result of the same mode.
+ */
+template <std::size_t N, std::size_t K>
+void benchmarkDeterministic()
 {
-    calculateBackSubstitution<512, 512, 51>(false);
-    calculateBackSubstitution<512, 64, 51>(true);
+    Matrix<float, N, N> mat;
+    Matrix<float, N, K> rhs;
+    generateBackSubstitutionInputs(mat, rhs);
+
+    for (bool deterministic : {false, true})
+    {
+        Matrix<float, N, K> sequentialResult;
+        computeBackSubstitutionSequential<float, N, K>(mat, rhs, sequentialResult, VerificationMode::None, deterministic);
+        compareParallelWithSequential<N, N / 2, K>(mat, rhs, sequentialResult, deterministic);
+        compareParallelWithSequential<N, N / 4, K>(mat, rhs, sequentialResult, deterministic);
+        compareParallelWithSequential<N, N / 8, K>(mat, rhs, sequentialResult, deterministic);
+    }
+}
+
+/**
+ * @brief Solve with the configuration this machine's tuning profile holds for N (see Autotune), or, if N was not
+ * tuned, time the sequential solve and the parallel solve with blocks of NBlock rows as before.
+ */
+template <std::size_t N, std::size_t NBlock, std::size_t K>
+void calculateTunedBackSubstitution(VerificationMode verification)
+{
+    TunedParameters parameters;
+    if (!findTunedBackSubstitutionParameters<N>(parameters))
+    {
+        std::cout << "No tuned back substitution configuration for N = " << N << " in " << hostProfilePath() << ", running the defaults" << std::endl;
+        calculateBackSubstitution<N, N, K>(false, verification);
+        calculateBackSubstitution<N, NBlock, K>(true, verification);
+        return;
+    }
+
+    Matrix<float, N, N> mat;
+    Matrix<float, N, K> rhs;
+    generateBackSubstitutionInputs(mat, rhs);
+    std::cout << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << "Matrix entry-wise sample standard deviation: " << mat.sample_dev() << std::endl;
+    std::cout << "RHS entry-wise sample standard deviation: " << rhs.sample_dev() << std::endl;
+    std::cout << "---------------------------" << std::endl;
 
-    calculateBackSubstitution<1024, 1024, 102>(false);
-    calculateBackSubstitution<1024, 128, 102>(true);
+    Matrix<float, N, K> result;
+    auto timerStart = std::chrono::steady_clock::now();
+    if (!tunedBackSubstitution(mat, rhs, result))
+    {
+        std::cout << "FATAL ERROR: tuned back substitution aborted unexpectedly" << std::endl;
+        return;
+    }
+    std::chrono::duration<double> milliseconds = std::chrono::steady_clock::now() - timerStart;
 
-    calculateBackSubstitution<2048, 2048, 205>(false);
-    calculateBackSubstitution<2048, 256, 205>(true);
+    std::cout << "Tuned back substitution, N = " << N << ", K = " << K << " (";
+    printParameters(parameters);
+    std::cout << ", from " << hostProfilePath() << ")" << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * milliseconds.count()) << std::endl;
+    printResidual(solveResidual(mat, rhs, result, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mode = (argc > 1) ? argv[1] : "solve";
+    if (mode == "deterministic")
+    {
+        benchmarkDeterministic<2048, 205>();
+        return 0;
+    }
 
-    calculateBackSubstitution<4096, 4096, 410>(false);
-    calculateBackSubstitution<4096, 512, 410>(true);
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
 
-    calculateBackSubstitution<8192, 8192, 819>(false);
-    calculateBackSubstitution<8192, 1024, 819>(true);
+    calculateTunedBackSubstitution<512, 64, 51>(verification);
+    calculateTunedBackSubstitution<1024, 128, 102>(verification);
+    calculateTunedBackSubstitution<2048, 256, 205>(verification);
+    calculateTunedBackSubstitution<4096, 512, 410>(verification);
+    calculateTunedBackSubstitution<8192, 1024, 819>(verification);
 }
@@ -1,5 +1,5 @@
 #!/bin/bash
 
-g++ -Wall -std=c++17 -pthread -o backsub ./BackSubstitutionParallel.cpp
-./backsub
+g++ -Wall -std=c++17 -O3 -march=native -pthread -o backsub ./BackSubstitutionParallel.cpp
+./backsub "$@"
 rm ./backsub
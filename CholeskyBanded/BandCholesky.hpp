@@ -0,0 +1,223 @@
+#ifndef BANDCHOLESKYHPP
+#define BANDCHOLESKYHPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/BandMatrix.hpp"
+#include "../Matrix/SkylineMatrix.hpp"
+#include "../Matrix/ColumnSolve.hpp"
+
+/**
+ * @brief Finish columns firstCol to lastCol - 1 of a banded Cholesky factorization, left-looking: each column
+ * receives the updates of columns firstUpdate, ..., c - 1 (those within the band), in increasing order, then is
+ * scaled by the square root of its diagonal.
+ *
+ * @return false if a diagonal entry is not positive (the matrix is not positive definite).
+ */
+template <typename TScalar, std::size_t N, std::size_t B>
+bool bandCholeskyColumns(SymmetricBandMatrix<TScalar, N, B> &band, std::size_t firstUpdate, std::size_t firstCol, std::size_t lastCol)
+{
+    for (std::size_t c = firstCol; c != lastCol; ++c)
+    {
+        TScalar *column = band.columnData(c);
+        for (std::size_t p = std::max(firstUpdate, c - std::min(c, B)); p != c; ++p)
+        {
+            const TScalar *updateColumn = band.columnData(p) + (c - p);
+            const TScalar multiplier = updateColumn[0];
+            const std::size_t length = std::min(p + B, N - 1) - c + 1;
+            for (std::size_t r = 0; r != length; ++r)
+            {
+                column[r] -= updateColumn[r] * multiplier;
+            }
+        }
+        if (!(column[0] > 0))
+        {
+            return false;
+        }
+        const TScalar diagonal = std::sqrt(column[0]);
+        column[0] = diagonal;
+        const std::size_t length = std::min(B, N - 1 - c) + 1;
+        for (std::size_t r = 1; r != length; ++r)
+        {
+            column[r] /= diagonal;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Banded Cholesky factorization A = L * L^T in place, in O(N * B^2) time, as in LAPACK's pbtf2.
+ *
+ * Left-looking: column c is updated by the (at most B) columns to its left that reach it, which are still in cache
+ * when B is small. Sequential; see bandCholeskyBlocked for large B.
+ *
+ * @return false if A is not positive definite; band is then only partially factored.
+ */
+template <typename TScalar, std::size_t N, std::size_t B>
+bool bandCholesky(SymmetricBandMatrix<TScalar, N, B> &band)
+{
+    return bandCholeskyColumns(band, 0, 0, N);
+}
+
+/**
+ * @brief Blocked banded Cholesky factorization, as in LAPACK's pbtrf, with the trailing updates on all cores.
+ *
+ * For every block of NB columns: finish the block left-looking (bandCholeskyColumns, updates from within the block
+ * only), then apply the block to the at most B columns to its right that it reaches, split across threads by
+ * column. Each entry still receives its updates in increasing column order, so the factor is bitwise identical to
+ * bandCholesky's for any NB and any number of threads.
+ *
+ * @tparam NB Columns per block; at most B.
+ * @return false if A is not positive definite; band is then only partially factored.
+ */
+template <typename TScalar, std::size_t N, std::size_t B, std::size_t NB>
+bool bandCholeskyBlocked(SymmetricBandMatrix<TScalar, N, B> &band)
+{
+    static_assert(NB >= 1 && NB <= B, "The block width must be between 1 and the bandwidth");
+    for (std::size_t firstCol = 0; firstCol < N; firstCol += NB)
+    {
+        const std::size_t lastCol = std::min(firstCol + NB, N);
+        if (!bandCholeskyColumns(band, firstCol, firstCol, lastCol))
+        {
+            return false;
+        }
+        const std::size_t lastUpdated = std::min(lastCol + B, N);
+        parallelForRange(lastUpdated - lastCol, (lastCol - firstCol) * (B + 1), [&band, firstCol, lastCol](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t c = lastCol + begin; c != lastCol + end; ++c)
+                             {
+                                 TScalar *column = band.columnData(c);
+                                 for (std::size_t p = std::max(firstCol, c - std::min(c, B)); p != lastCol; ++p)
+                                 {
+                                     const TScalar *updateColumn = band.columnData(p) + (c - p);
+                                     const TScalar multiplier = updateColumn[0];
+                                     const std::size_t length = std::min(p + B, N - 1) - c + 1;
+                                     for (std::size_t r = 0; r != length; ++r)
+                                     {
+                                         column[r] -= updateColumn[r] * multiplier;
+                                     }
+                                 }
+                             }
+                         });
+    }
+    return true;
+}
+
+/**
+ * @brief Solve A * X = B from a banded Cholesky factor: L * Y = B forward by columns of L (updates), then
+ * L^T * X = Y backward by the same columns (dot products), in O(N * B * K).
+ *
+ * Each right hand side is copied into a contiguous vector (solveContiguousColumns), so both sweeps run over
+ * contiguous band columns, and every band column is applied to all the right hand sides of a thread while it is in
+ * cache. The right hand sides are split across threads; a band column is too short to split.
+ */
+template <typename TScalar, std::size_t N, std::size_t B, std::size_t K>
+void bandCholeskySolve(const SymmetricBandMatrix<TScalar, N, B> &factor, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    solveContiguousColumns(rhs, result, 4 * N * (B + 1), [&factor](std::vector<std::vector<TScalar>> &x)
+                           {
+                               for (std::size_t j = 0; j != N; ++j)
+                               {
+                                   const TScalar *column = factor.columnData(j);
+                                   const std::size_t length = std::min(B, N - 1 - j);
+                                   for (auto &xn : x)
+                                   {
+                                       const TScalar value = xn[j] / column[0];
+                                       xn[j] = value;
+                                       TScalar *below = xn.data() + j;
+                                       for (std::size_t d = 1; d <= length; ++d)
+                                       {
+                                           below[d] -= column[d] * value;
+                                       }
+                                   }
+                               }
+                               for (std::size_t step = 0; step != N; ++step)
+                               {
+                                   const std::size_t j = N - 1 - step;
+                                   const TScalar *column = factor.columnData(j);
+                                   const std::size_t length = std::min(B, N - 1 - j);
+                                   for (auto &xn : x)
+                                   {
+                                       xn[j] = (xn[j] - dotProduct(column + 1, xn.data() + j + 1, length)) / column[0];
+                                   }
+                               }
+                           });
+}
+
+/**
+ * @brief Skyline Cholesky factorization A = L * L^T in place, in O(sum of squared row bandwidths) time.
+ *
+ * Row by row: entry (i, j) is the dot product of rows i and j over the columns both store, so all reads are
+ * contiguous and no entry outside the profile is touched (the factor has the profile of A).
+ *
+ * @return false if A is not positive definite; mat is then only partially factored.
+ */
+template <typename TScalar, std::size_t N>
+bool skylineCholesky(SkylineMatrix<TScalar, N> &mat)
+{
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        TScalar *row = mat.rowData(i);
+        const std::size_t first = mat.firstColumn(i);
+        for (std::size_t j = first; j != i; ++j)
+        {
+            const TScalar *rowJ = mat.rowData(j);
+            const std::size_t firstJ = mat.firstColumn(j);
+            const std::size_t overlap = std::max(first, firstJ);
+            const TScalar sum = row[j - first] - dotProduct(row + (overlap - first), rowJ + (overlap - firstJ), j - overlap);
+            row[j - first] = sum / rowJ[j - firstJ];
+        }
+        const TScalar sum = row[i - first] - dotProduct(row, row, i - first);
+        if (!(sum > 0))
+        {
+            return false;
+        }
+        row[i - first] = std::sqrt(sum);
+    }
+    return true;
+}
+
+/**
+ * @brief Solve A * X = B from a skyline Cholesky factor: forward by rows of L (dot products), backward by columns
+ * of L^T (updates), in O(profileSize() * K).
+ *
+ * Each right hand side is copied into a contiguous vector (solveContiguousColumns), and every row of L is applied to
+ * all the right hand sides of a thread while it is in cache. The right hand sides are split across threads.
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+void skylineCholeskySolve(const SkylineMatrix<TScalar, N> &factor, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    solveContiguousColumns(rhs, result, 4 * factor.profileSize(), [&factor](std::vector<std::vector<TScalar>> &x)
+                           {
+                               for (std::size_t i = 0; i != N; ++i)
+                               {
+                                   const TScalar *row = factor.rowData(i);
+                                   const std::size_t first = factor.firstColumn(i);
+                                   for (auto &xn : x)
+                                   {
+                                       xn[i] = (xn[i] - dotProduct(row, xn.data() + first, i - first)) / row[i - first];
+                                   }
+                               }
+                               for (std::size_t step = 0; step != N; ++step)
+                               {
+                                   const std::size_t i = N - 1 - step;
+                                   const TScalar *row = factor.rowData(i);
+                                   const std::size_t first = factor.firstColumn(i);
+                                   for (auto &xn : x)
+                                   {
+                                       const TScalar value = xn[i] / row[i - first];
+                                       xn[i] = value;
+                                       TScalar *left = xn.data() + first;
+                                       for (std::size_t p = 0; p != i - first; ++p)
+                                       {
+                                           left[p] -= row[p] * value;
+                                       }
+                                   }
+                               }
+                           });
+}
+
+#endif
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/BandMatrix.hpp"
+#include "../Matrix/SkylineMatrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../CholeskyParallel/Cholesky.hpp"
+#include "BandCholesky.hpp"
+
+/**
+ * @brief Return the percent residual 100 * |A * X - B| / |B| for a matrix type with multiplyRight (band or skyline).
+ */
+template <typename TScalar, std::size_t N, std::size_t K, typename TMatrix>
+TScalar structuredSolveResidual(const TMatrix &mat, const Matrix<TScalar, N, K> &rhs, const Matrix<TScalar, N, K> &result)
+{
+    Matrix<TScalar, N, K> computed(0);
+    mat.multiplyRight(result, computed);
+    computed.add(rhs, -1.0);
+    return 100.0 * computed.frobNorm() / rhs.frobNorm();
+}
+
+/**
+ * @brief Factor a random SPD band matrix with the sequential and the blocked banded Cholesky, check that both give
+ * the same factor, solve for K right hand sides and report the time and GFLOP/s (N * B^2 flops) of each.
+ */
+template <typename TScalar, std::size_t N, std::size_t B, std::size_t NB, std::size_t K>
+void computeBandCholesky()
+{
+    const SymmetricBandMatrix<TScalar, N, B> mat = randomBandSPD<TScalar, N, B>(11834);
+    const Matrix<TScalar, N, K> rhs = randomNormal<TScalar, N, K>(11835, NormalStream, 1.0);
+
+    SymmetricBandMatrix<TScalar, N, B> factor = mat;
+    auto timerStart = std::chrono::steady_clock::now();
+    const bool factored = bandCholesky(factor);
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> sequentialSeconds = timerStop - timerStart;
+
+    SymmetricBandMatrix<TScalar, N, B> blockedFactor = mat;
+    timerStart = std::chrono::steady_clock::now();
+    const bool blockedFactored = bandCholeskyBlocked<TScalar, N, B, NB>(blockedFactor);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> blockedSeconds = timerStop - timerStart;
+
+    std::cout << "Banded Cholesky, N = " << N << ", B = " << B << ", NB = " << NB << ", K = " << K << std::endl;
+    if (!factored || !blockedFactored)
+    {
+        std::cout << "FATAL ERROR: matrix is not positive definite" << std::endl;
+        return;
+    }
+
+    Matrix<TScalar, N, K> result;
+    timerStart = std::chrono::steady_clock::now();
+    bandCholeskySolve(factor, rhs, result);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> solveSeconds = timerStop - timerStart;
+
+    bool identical = true;
+    for (std::size_t j = 0; j != N; ++j)
+    {
+        identical = identical && std::equal(factor.columnData(j), factor.columnData(j) + B + 1, blockedFactor.columnData(j));
+    }
+
+    std::cout << "Sequential milliseconds: " << (int)(1000 * sequentialSeconds.count()) << std::endl;
+    std::cout << "Sequential GFLOP/s: " << 1.0 * N * B * B / sequentialSeconds.count() / 1e9 << std::endl;
+    std::cout << "Blocked milliseconds: " << (int)(1000 * blockedSeconds.count()) << std::endl;
+    std::cout << "Blocked GFLOP/s: " << 1.0 * N * B * B / blockedSeconds.count() / 1e9 << std::endl;
+    std::cout << "Blocked factor bitwise identical: " << (identical ? "yes" : "no") << std::endl;
+    std::cout << "Solve milliseconds: " << (int)(1000 * solveSeconds.count()) << std::endl;
+    printResidual(structuredSolveResidual(mat, rhs, result), VerificationMode::Full);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Factor the same band matrix with the dense sequential Cholesky, to show the O(N^3) against O(N * B^2) cost.
+ */
+template <typename TScalar, std::size_t N, std::size_t B>
+void compareDenseCholesky()
+{
+    const SymmetricBandMatrix<TScalar, N, B> mat = randomBandSPD<TScalar, N, B>(11834);
+    const Matrix<TScalar, N, N> dense = mat.toDense();
+
+    Matrix<TScalar, N, N> denseFactor;
+    MessageQueue<CholeskyMessage<TScalar, N>> messageQueue;
+    auto timerStart = std::chrono::steady_clock::now();
+    cholBlockIter<TScalar, N, N>(0, dense, messageQueue, true, false, denseFactor);
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> denseSeconds = timerStop - timerStart;
+
+    SymmetricBandMatrix<TScalar, N, B> factor = mat;
+    timerStart = std::chrono::steady_clock::now();
+    const bool factored = bandCholesky(factor);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> bandSeconds = timerStop - timerStart;
+
+    std::cout << "Dense against banded Cholesky, N = " << N << ", B = " << B << std::endl;
+    if (!factored)
+    {
+        std::cout << "FATAL ERROR: matrix is not positive definite" << std::endl;
+        return;
+    }
+    std::cout << "Dense milliseconds: " << (int)(1000 * denseSeconds.count()) << std::endl;
+    std::cout << "Banded milliseconds: " << 1000 * bandSeconds.count() << std::endl;
+    const Matrix<TScalar, N, N> lower([&factor](std::size_t rowIdx, std::size_t colIdx)
+                                      { return rowIdx >= colIdx ? factor.get(rowIdx, colIdx) : (TScalar)0; });
+    printResidual(choleskyResidual(dense, lower, VerificationMode::Freivalds), VerificationMode::Freivalds);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Factor a random SPD skyline matrix with row bandwidths up to MaxB, and the same matrix in band storage
+ * with bandwidth MaxB, and report both.
+ */
+template <typename TScalar, std::size_t N, std::size_t MaxB, std::size_t K>
+void compareSkylineCholesky()
+{
+    const SkylineMatrix<TScalar, N> mat = randomSkylineSPD<TScalar, N>(11836, MaxB);
+    const Matrix<TScalar, N, K> rhs = randomNormal<TScalar, N, K>(11837, NormalStream, 1.0);
+    SymmetricBandMatrix<TScalar, N, MaxB> band;
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        for (std::size_t j = mat.firstColumn(i); j <= i; ++j)
+        {
+            band.set(i, j, mat.get(i, j));
+        }
+    }
+
+    SkylineMatrix<TScalar, N> factor = mat;
+    auto timerStart = std::chrono::steady_clock::now();
+    const bool factored = skylineCholesky(factor);
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> skylineSeconds = timerStop - timerStart;
+
+    timerStart = std::chrono::steady_clock::now();
+    const bool bandFactored = bandCholesky(band);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> bandSeconds = timerStop - timerStart;
+
+    std::cout << "Skyline against banded Cholesky, N = " << N << ", row bandwidths up to " << MaxB << ", K = " << K << std::endl;
+    if (!factored || !bandFactored)
+    {
+        std::cout << "FATAL ERROR: matrix is not positive definite" << std::endl;
+        return;
+    }
+
+    Matrix<TScalar, N, K> result;
+    timerStart = std::chrono::steady_clock::now();
+    skylineCholeskySolve(factor, rhs, result);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> solveSeconds = timerStop - timerStart;
+
+    std::cout << "Stored entries, skyline: " << mat.profileSize() << ", band: " << N * (MaxB + 1) << std::endl;
+    std::cout << "Skyline milliseconds: " << (int)(1000 * skylineSeconds.count()) << std::endl;
+    std::cout << "Banded milliseconds: " << (int)(1000 * bandSeconds.count()) << std::endl;
+    std::cout << "Skyline solve milliseconds: " << (int)(1000 * solveSeconds.count()) << std::endl;
+    printResidual(structuredSolveResidual(mat, rhs, result), VerificationMode::Full);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    compareDenseCholesky<float, 2048, 32>();
+
+    computeBandCholesky<float, 131072, 16, 16, 4>();
+    computeBandCholesky<float, 131072, 64, 32, 4>();
+    computeBandCholesky<float, 131072, 256, 32, 4>();
+    computeBandCholesky<float, 16384, 1024, 64, 4>();
+
+    compareSkylineCholesky<float, 131072, 256, 4>();
+}
@@ -0,0 +1,179 @@
+#define _USE_MATH_DEFINES
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <csignal>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../CholeskyParallel/Cholesky.hpp"
+#include "CholeskyCheckpoint.hpp"
+
+void printCheckpointStats(const CheckpointStats &stats)
+{
+    std::cout << "Checkpoints written / skipped: " << stats.written << " / " << stats.skipped << ", bytes each: " << stats.bytes << std::endl;
+    std::cout << "Snapshot milliseconds: " << (int)(1000 * stats.snapshot.count()) << ", write milliseconds: " << (int)(1000 * stats.writing.count()) << std::endl;
+}
+
+/**
+ * @brief Best time of a few fresh checkpointed factorizations; stats are those of the last one.
+ */
+template <std::size_t N>
+double timeCheckpointed(const Matrix<float, N, N> &mat, Matrix<float, N, N> &result, const CheckpointOptions &options, CheckpointStats &stats)
+{
+    double best = 0;
+    for (std::size_t repetition = 0; repetition != 3; ++repetition)
+    {
+        auto timerStart = std::chrono::steady_clock::now();
+        checkpointedCholesky(mat, result, options, false, stats);
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - timerStart;
+        best = (repetition == 0) ? seconds.count() : std::min(best, seconds.count());
+    }
+    return best;
+}
+
+/**
+ * @brief Time the factorization without checkpoints (an interval longer than the run) and with checkpoints every
+ * interval, written asynchronously and synchronously, and check every factor against the sequential cholBlockIter.
+ * Each configuration is timed as the best of three runs.
+ */
+template <std::size_t N>
+void benchmarkOverhead(const std::string &path, std::chrono::duration<double> interval, VerificationMode verification)
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    Matrix<float, N, N> reference;
+    MessageQueue<CholeskyMessage<float, N>> messageQueue;
+    cholBlockIter<float, N, N>(0, mat, messageQueue, true, false, reference);
+
+    Matrix<float, N, N> result;
+    CheckpointStats stats;
+    const double baseline = timeCheckpointed(mat, result, CheckpointOptions{path, std::chrono::hours(24), true}, stats);
+    std::cout << "Checkpointed Cholesky, N = " << N << ", no checkpoints" << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * baseline) << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / baseline / 1e9 << std::endl;
+    printResidual(choleskyResidual(mat, result, verification), verification);
+    std::cout << "Bitwise identical to sequential: " << (result.bitwiseEquals(reference) ? "yes" : "no") << std::endl;
+    std::cout << "---------------------------" << std::endl;
+
+    for (bool asynchronous : {true, false})
+    {
+        Matrix<float, N, N> checkpointed;
+        const double seconds = timeCheckpointed(mat, checkpointed, CheckpointOptions{path, interval, asynchronous}, stats);
+        std::cout << "Checkpointed Cholesky, N = " << N << ", every " << 1000 * interval.count() << " ms, "
+                  << (asynchronous ? "asynchronous" : "synchronous") << " writes" << std::endl;
+        std::cout << "Milliseconds: " << (int)(1000 * seconds) << std::endl;
+        std::cout << "Overhead: " << 100 * (seconds - baseline) / baseline << "%" << std::endl;
+        printCheckpointStats(stats);
+        std::cout << "Bitwise identical to sequential: " << (checkpointed.bitwiseEquals(reference) ? "yes" : "no") << std::endl;
+        std::cout << "---------------------------" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Kill a child process in the middle of a checkpointed factorization (SIGKILL, so it cannot clean up),
+ * resume from its last checkpoint, and compare the factor with an uninterrupted run.
+ */
+template <std::size_t N>
+void demonstrateResume(const std::string &path, std::chrono::duration<double> interval, std::chrono::duration<double> killAfter)
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    std::remove(path.c_str());
+
+    const pid_t child = ::fork();
+    if (child < 0)
+    {
+        throw std::runtime_error("fork failed");
+    }
+    if (child == 0)
+    {
+        Matrix<float, N, N> result;
+        CheckpointStats stats;
+        checkpointedCholesky(mat, result, CheckpointOptions{path, interval, true}, false, stats);
+        ::_exit(0);
+    }
+    std::this_thread::sleep_for(killAfter);
+    ::kill(child, SIGKILL);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    std::cout << "Factorization process, N = " << N << ", killed after " << (int)(1000 * killAfter.count()) << " ms"
+              << (WIFSIGNALED(status) ? "" : " (it had already finished)") << std::endl;
+
+    Matrix<float, N, N> resumed;
+    CheckpointStats stats;
+    auto timerStart = std::chrono::steady_clock::now();
+    checkpointedCholesky(mat, resumed, CheckpointOptions{path, interval, true}, true, stats);
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - timerStart;
+    std::cout << "Resumed from column " << stats.resumedFrom << " of " << N << std::endl;
+    std::cout << "Milliseconds to finish: " << (int)(1000 * seconds.count()) << std::endl;
+
+    Matrix<float, N, N> uninterrupted;
+    checkpointedCholesky(mat, uninterrupted, CheckpointOptions{path, std::chrono::hours(24), true}, false, stats);
+    std::cout << "Bitwise identical to an uninterrupted run: " << (resumed.bitwiseEquals(uninterrupted) ? "yes" : "no") << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Factor the N = 4096 input with a checkpoint every 10 seconds, continuing from path if a previous run was
+ * interrupted.
+ */
+void factorResumable(const std::string &path, VerificationMode verification)
+{
+    constexpr std::size_t N = 4096;
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    Matrix<float, N, N> result;
+    CheckpointStats stats;
+    auto timerStart = std::chrono::steady_clock::now();
+    checkpointedCholesky(mat, result, CheckpointOptions{path, std::chrono::seconds(10), true}, true, stats);
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - timerStart;
+    std::cout << "Checkpointed Cholesky, N = " << N << ", resumed from column " << stats.resumedFrom << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * seconds.count()) << std::endl;
+    printCheckpointStats(stats);
+    printResidual(choleskyResidual(mat, result, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mode = (argc > 1) ? argv[1] : "overhead";
+    const std::string path = (argc > 2) ? argv[2] : "./cholesky_checkpoint.bin";
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+    try
+    {
+        std::cout << std::endl;
+        if (mode == "resume")
+        {
+            demonstrateResume<4096>(path, std::chrono::milliseconds(100), std::chrono::milliseconds(800));
+        }
+        else if (mode == "factor")
+        {
+            factorResumable(path, verification);
+        }
+        else
+        {
+            benchmarkOverhead<2048>(path, std::chrono::milliseconds(50), verification);
+            benchmarkOverhead<4096>(path, std::chrono::milliseconds(250), verification);
+        }
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "FATAL ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
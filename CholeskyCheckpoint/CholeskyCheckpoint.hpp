@@ -0,0 +1,454 @@
+#ifndef CHOLESKYCHECKPOINTHPP
+#define CHOLESKYCHECKPOINTHPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Hash.hpp"
+#include "../Matrix/SolveControl.hpp"
+#include "../CholeskyParallel/Cholesky.hpp"
+
+/**
+ * @brief Columns factored between two points at which a checkpoint may be taken; the trailing matrix receives the
+ * updates of a whole panel in one pass.
+ */
+constexpr std::size_t checkpointPanelWidth = 32;
+
+/**
+ * @brief First word of a checkpoint file ("CHOLCKP1" in ASCII on little-endian machines).
+ */
+constexpr std::uint64_t checkpointMagic = 0x31504b434c4f4843ULL;
+
+/**
+ * @brief Checkpoint header: magic, N, bytes per scalar, next column to factor, fingerprint of the input matrix, and
+ * XXH64 of the payload. The payload is the lower triangle of the state, row by row.
+ */
+constexpr std::size_t checkpointHeaderWords = 6;
+constexpr std::size_t checkpointHeaderBytes = checkpointHeaderWords * sizeof(std::uint64_t);
+
+/**
+ * @brief Where checkpointedCholesky writes its checkpoints and how often (at most once per interval).
+ */
+struct CheckpointOptions
+{
+    std::string path;
+    std::chrono::duration<double> interval{60};
+    bool asynchronous = true;
+};
+
+/**
+ * @brief Checkpoints written and skipped (the writer was still busy), the size of one checkpoint, the column a
+ * resumed run started from, the time the factorization spent copying its state, and the time spent hashing,
+ * writing and syncing checkpoints (on the writer thread, or on the factorization thread for synchronous writes).
+ */
+struct CheckpointStats
+{
+    std::size_t written = 0;
+    std::size_t skipped = 0;
+    std::size_t bytes = 0;
+    std::size_t resumedFrom = 0;
+    std::chrono::duration<double> snapshot{};
+    std::chrono::duration<double> writing{};
+};
+
+/**
+ * @brief Write a checkpoint image to path: the payload hash is filled into the header, the image goes to path.tmp
+ * and is synced, path.tmp is renamed over path, and the directory is synced. A crash at any point leaves either the
+ * previous checkpoint or the new one, never a torn file.
+ */
+inline void writeCheckpointFile(const std::string &path, std::vector<unsigned char> &image)
+{
+    const std::uint64_t payloadHash = xxHash64(image.data() + checkpointHeaderBytes, image.size() - checkpointHeaderBytes);
+    std::memcpy(image.data() + 5 * sizeof(std::uint64_t), &payloadHash, sizeof(payloadHash));
+
+    const std::string temporary = path + ".tmp";
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open " + temporary + ": " + std::strerror(errno));
+    }
+    std::size_t done = 0;
+    while (done != image.size())
+    {
+        const ssize_t count = ::write(fd, image.data() + done, image.size() - done);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            const std::string error = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Write of " + temporary + " failed: " + error);
+        }
+        done += (std::size_t)count;
+    }
+    if (::fsync(fd) != 0 || ::close(fd) != 0)
+    {
+        throw std::runtime_error("Cannot sync " + temporary + ": " + std::strerror(errno));
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        throw std::runtime_error("Cannot rename " + temporary + " to " + path + ": " + std::strerror(errno));
+    }
+
+    // The rename is only durable once the directory entry is synced too.
+    const std::size_t slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : path.substr(0, std::max<std::size_t>(slash, 1));
+    const int directoryFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directoryFd < 0)
+    {
+        throw std::runtime_error("Cannot open " + directory + ": " + std::strerror(errno));
+    }
+    if (::fsync(directoryFd) != 0)
+    {
+        const std::string error = std::strerror(errno);
+        ::close(directoryFd);
+        throw std::runtime_error("Cannot sync " + directory + ": " + error);
+    }
+    ::close(directoryFd);
+}
+
+/**
+ * @brief Writes checkpoint images on a background thread, one at a time.
+ *
+ * The factorization only hands over an image when the writer is idle, so it never waits for the disk; a checkpoint
+ * that falls due while the previous one is still being written is skipped. A write error is kept and thrown by
+ * finish.
+ */
+class CheckpointWriter
+{
+private:
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<unsigned char> pending{};
+    bool hasPending = false;
+    bool writing = false;
+    bool stopping = false;
+    std::string error{};
+    std::size_t nWritten = 0;
+    std::chrono::duration<double> writeTime{};
+    std::thread thread;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            condition.wait(lock, [this]
+                           { return hasPending || stopping; });
+            if (!hasPending)
+            {
+                return;
+            }
+            std::vector<unsigned char> image = std::move(pending);
+            hasPending = false;
+            writing = true;
+            lock.unlock();
+            const auto writeStart = std::chrono::steady_clock::now();
+            std::string failure{};
+            try
+            {
+                writeCheckpointFile(path, image);
+            }
+            catch (const std::runtime_error &writeError)
+            {
+                failure = writeError.what();
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - writeStart;
+            lock.lock();
+            writing = false;
+            writeTime += elapsed;
+            if (failure.empty())
+            {
+                ++nWritten;
+            }
+            else if (error.empty())
+            {
+                error = failure;
+            }
+            condition.notify_all();
+        }
+    };
+
+public:
+    explicit CheckpointWriter(const std::string &path) : path(path), thread(&CheckpointWriter::run, this){};
+
+    ~CheckpointWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+    };
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    /**
+     * @brief Whether a new image would be written right away.
+     */
+    bool idle()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !hasPending && !writing;
+    };
+
+    void submit(std::vector<unsigned char> &&image)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = std::move(image);
+            hasPending = true;
+        }
+        condition.notify_all();
+    };
+
+    /**
+     * @brief Wait until every submitted image is on disk, and throw the first write error, if any.
+     */
+    void finish()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]
+                       { return !hasPending && !writing; });
+        if (!error.empty())
+        {
+            throw std::runtime_error(error);
+        }
+    };
+
+    std::size_t written()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nWritten;
+    };
+
+    /**
+     * @brief Time the writer thread spent hashing, writing and syncing.
+     */
+    std::chrono::duration<double> writingTime()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return writeTime;
+    };
+};
+
+/**
+ * @brief Serialize the state of checkpointedCholesky after nextColumn columns: the header, then the lower triangle
+ * of state row by row (L in columns below nextColumn, the partially updated trailing matrix from there on). The
+ * payload hash is left to writeCheckpointFile.
+ */
+template <typename TScalar, std::size_t N>
+std::vector<unsigned char> checkpointImage(const Matrix<TScalar, N, N> &state, std::size_t nextColumn, std::uint64_t inputFingerprint)
+{
+    std::vector<unsigned char> image(checkpointHeaderBytes + N * (N + 1) / 2 * sizeof(TScalar));
+    const std::uint64_t header[checkpointHeaderWords] = {checkpointMagic, N, sizeof(TScalar), nextColumn, inputFingerprint, 0};
+    std::memcpy(image.data(), header, checkpointHeaderBytes);
+    unsigned char *payload = image.data() + checkpointHeaderBytes;
+    for (std::size_t r = 0; r != N; ++r)
+    {
+        std::memcpy(payload, state.rowData(r), (r + 1) * sizeof(TScalar));
+        payload += (r + 1) * sizeof(TScalar);
+    }
+    return image;
+}
+
+/**
+ * @brief Load a checkpoint written by checkpointedCholesky for the same matrix into state.
+ *
+ * @return The next column to factor, or 0 if there is no checkpoint file (state is then left alone).
+ * @throws std::runtime_error If the file is for another size, scalar type or input matrix, or is corrupt.
+ */
+template <typename TScalar, std::size_t N>
+std::size_t loadCheckpoint(const std::string &path, Matrix<TScalar, N, N> &state, std::uint64_t inputFingerprint)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return 0;
+    }
+    std::vector<unsigned char> image(checkpointHeaderBytes + N * (N + 1) / 2 * sizeof(TScalar));
+    const std::size_t read = std::fread(image.data(), 1, image.size(), file);
+    const bool trailingBytes = std::fgetc(file) != EOF;
+    std::fclose(file);
+
+    std::uint64_t header[checkpointHeaderWords];
+    std::memcpy(header, image.data(), checkpointHeaderBytes);
+    if (read < checkpointHeaderBytes || header[0] != checkpointMagic)
+    {
+        throw std::runtime_error(path + " is not a Cholesky checkpoint");
+    }
+    if (header[1] != N || header[2] != sizeof(TScalar) || header[4] != inputFingerprint)
+    {
+        throw std::runtime_error(path + " is a checkpoint of another matrix");
+    }
+    if (read != image.size() || trailingBytes || header[3] > N ||
+        header[5] != xxHash64(image.data() + checkpointHeaderBytes, image.size() - checkpointHeaderBytes))
+    {
+        throw std::runtime_error(path + " is corrupt");
+    }
+    const unsigned char *payload = image.data() + checkpointHeaderBytes;
+    for (std::size_t r = 0; r != N; ++r)
+    {
+        TScalar *row = state.rowData(r);
+        std::memcpy(row, payload, (r + 1) * sizeof(TScalar));
+        std::fill(row + r + 1, row + N, (TScalar)0);
+        payload += (r + 1) * sizeof(TScalar);
+    }
+    return header[3];
+}
+
+/**
+ * @brief Sequential Cholesky factorization A = L * L^T that checkpoints its progress to a file and resumes from it.
+ *
+ * The factor is built in place in result, panel by panel (checkpointPanelWidth columns): columns left of the
+ * current panel hold L, and the lower triangle from there on holds the trailing matrix with the updates of all
+ * finished columns applied. At a panel boundary, once options.interval has passed since the last checkpoint, this
+ * state is copied into a checkpoint image and written by a CheckpointWriter thread, so the factorization only
+ * pays for the copy; if the previous checkpoint is still being written, this one is skipped. With
+ * options.asynchronous false, the image is written on the calling thread instead.
+ *
+ * The updates go through applyCholeskyColumns, the kernel of cholBlockIter, restricted to the lower triangle, so
+ * the factor is bitwise identical to the sequential cholBlockIter however often the run was interrupted and
+ * resumed, with a third of its work.
+ *
+ * @param mat The symmetric positive definite matrix A; its lower triangle is read.
+ * @param result Receives L.
+ * @param options The checkpoint file and how often to write it.
+ * @param resume Whether to continue from options.path if it exists (a new factorization starts otherwise).
+ * @param stats Receives the numbers of checkpoints written and skipped, their size and the time spent on them.
+ * @param control If not null, advanced by one step per column; when cancelled, a last checkpoint is written at the
+ * next panel boundary and the factorization returns.
+ * @return Whether the factorization finished; the checkpoint file is then removed.
+ * @throws std::runtime_error If a checkpoint cannot be written or the file to resume from does not match.
+ */
+template <typename TScalar, std::size_t N>
+bool checkpointedCholesky(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, const CheckpointOptions &options, bool resume, CheckpointStats &stats, SolveControl *control = nullptr)
+{
+    stats = CheckpointStats();
+    const std::uint64_t inputFingerprint = matrixFingerprint(mat);
+    std::size_t first = resume ? loadCheckpoint(options.path, result, inputFingerprint) : 0;
+    if (first == 0)
+    {
+        for (std::size_t r = 0; r != N; ++r)
+        {
+            TScalar *row = result.rowData(r);
+            std::copy(mat.rowData(r), mat.rowData(r) + r + 1, row);
+            std::fill(row + r + 1, row + N, (TScalar)0);
+        }
+    }
+    stats.resumedFrom = first;
+    if (control)
+    {
+        control->start(N);
+        control->advance(first);
+    }
+
+    CheckpointWriter writer(options.path);
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    auto takeCheckpoint = [&](std::size_t nextColumn, bool force)
+    {
+        if (force)
+        {
+            writer.finish();
+        }
+        else if (std::chrono::steady_clock::now() - lastCheckpoint < options.interval)
+        {
+            return;
+        }
+        if (options.asynchronous && !writer.idle())
+        {
+            ++stats.skipped;
+            return;
+        }
+        const auto snapshotStart = std::chrono::steady_clock::now();
+        std::vector<unsigned char> image = checkpointImage(result, nextColumn, inputFingerprint);
+        const auto snapshotStop = std::chrono::steady_clock::now();
+        stats.snapshot += snapshotStop - snapshotStart;
+        stats.bytes = image.size();
+        if (options.asynchronous)
+        {
+            writer.submit(std::move(image));
+        }
+        else
+        {
+            writeCheckpointFile(options.path, image);
+            stats.writing += std::chrono::steady_clock::now() - snapshotStop;
+            ++stats.written;
+        }
+        lastCheckpoint = std::chrono::steady_clock::now();
+    };
+
+    std::vector<std::vector<TScalar>> panel(checkpointPanelWidth, std::vector<TScalar>(N));
+    std::vector<const TScalar *> panelColumns{};
+    bool cancelled = false;
+    for (; first != N; first = std::min(first + checkpointPanelWidth, N))
+    {
+        if (control && control->cancelled())
+        {
+            takeCheckpoint(first, true);
+            cancelled = true;
+            break;
+        }
+        const std::size_t last = std::min(first + checkpointPanelWidth, N);
+
+        // Factor the panel: each finished column updates the panel columns to its right.
+        panelColumns.clear();
+        for (std::size_t i = first; i != last; ++i)
+        {
+            std::vector<TScalar> &column = panel[i - first];
+            for (std::size_t r = i; r != N; ++r)
+            {
+                column[r] = result.rowData(r)[i];
+            }
+            applyCholeskyColumns(result, 0, std::vector<const TScalar *>{column.data()}, i, i + 1, i + 1, last, true);
+            const TScalar diagElem = std::sqrt(std::abs(column[i]));
+            result.rowData(i)[i] = diagElem;
+            for (std::size_t r = i + 1; r != N; ++r)
+            {
+                result.rowData(r)[i] = column[r] / diagElem;
+            }
+            panelColumns.push_back(column.data());
+            if (control)
+            {
+                control->advance();
+            }
+        }
+
+        // Apply the whole panel to the trailing matrix as one rank-k update.
+        applyCholeskyColumns(result, 0, panelColumns, first, last, last, N, true);
+
+        if (last != N)
+        {
+            takeCheckpoint(last, false);
+        }
+    }
+
+    writer.finish();
+    stats.written += writer.written();
+    stats.writing += writer.writingTime();
+    if (!cancelled)
+    {
+        std::remove(options.path.c_str());
+    }
+    return !cancelled;
+}
+
+#endif
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+g++ -Wall -std=c++17 -O3 -march=native -pthread -o cholesky_checkpoint ./CholeskyCheckpoint.cpp
+./cholesky_checkpoint "$@"
+rm ./cholesky_checkpoint
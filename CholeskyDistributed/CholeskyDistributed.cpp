@@ -0,0 +1,163 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../MessageQueue/Transport.hpp"
+#include "../MessageQueue/SharedMemoryTransport.hpp"
+#include "../MessageQueue/TcpTransport.hpp"
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../CholeskyParallel/Cholesky.hpp"
+
+/**
+ * @brief Run ranks 1 to nRanks - 1 as forked child processes; each child builds its transport with makeTransport(rank).
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock, typename TMakeTransport>
+std::vector<pid_t> forkRanks(std::size_t nRanks, const Matrix<TScalar, N, N> &mat, TMakeTransport makeTransport)
+{
+    std::cout.flush();
+    std::vector<pid_t> children{};
+    for (std::size_t rank = 1; rank != nRanks; ++rank)
+    {
+        const pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            int status = 0;
+            try
+            {
+                std::unique_ptr<Transport<TScalar>> transport = makeTransport(rank);
+                Matrix<TScalar, N, N> unused(0);
+                WorkerTimes times;
+                cholRankIter<TScalar, N, NBlock>(rank, nRanks, mat, *transport, false, false, unused, times);
+            }
+            catch (const std::runtime_error &error)
+            {
+                std::cout << "FATAL ERROR: rank " << rank << ": " << error.what() << std::endl;
+                status = 1;
+            }
+            std::_Exit(status);
+        }
+        children.push_back(pid);
+    }
+    return children;
+}
+
+/**
+ * @brief Factor mat on nRanks ranks over the given transport ("inprocess", "shm" or "tcp") and compare the factor
+ * with the sequential one.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+void computeCholeskyDistributed(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, N> &sequentialResult, const std::string &transportName, std::size_t nRanks, std::uint16_t port)
+{
+    Matrix<TScalar, N, N> result;
+    std::chrono::duration<double> seconds{};
+    bool childrenSucceeded = true;
+
+    if (transportName == "inprocess")
+    {
+        MessageQueue<std::vector<TScalar>> messageQueue;
+        std::vector<std::unique_ptr<InProcessTransport<TScalar>>> transports{};
+        for (std::size_t rank = 0; rank != nRanks; ++rank)
+        {
+            transports.emplace_back(new InProcessTransport<TScalar>(messageQueue, N));
+        }
+        auto timerStart = std::chrono::steady_clock::now();
+        std::vector<WorkerTimes> times(nRanks);
+        std::vector<std::thread> threads{};
+        for (std::size_t rank = 1; rank != nRanks; ++rank)
+        {
+            threads.push_back(std::thread(cholRankIter<TScalar, N, NBlock>, rank, nRanks, std::cref(mat), std::ref(*transports[rank]), false, false, std::ref(result), std::ref(times[rank])));
+        }
+        cholRankIter<TScalar, N, NBlock>(0, nRanks, mat, *transports[0], true, false, result, times[0]);
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        seconds = std::chrono::steady_clock::now() - timerStart;
+    }
+    else
+    {
+        const std::string shmName = "/cholesky_" + std::to_string(::getpid());
+        std::vector<pid_t> children;
+        std::unique_ptr<Transport<TScalar>> transport;
+        if (transportName == "shm")
+        {
+            SharedMemoryTransport<TScalar>::create(shmName, N, N);
+            children = forkRanks<TScalar, N, NBlock>(nRanks, mat, [&shmName](std::size_t rank)
+                                                     { return std::unique_ptr<Transport<TScalar>>(new SharedMemoryTransport<TScalar>(shmName, rank, N)); });
+            transport.reset(new SharedMemoryTransport<TScalar>(shmName, 0, N));
+        }
+        else
+        {
+            children = forkRanks<TScalar, N, NBlock>(nRanks, mat, [nRanks, port](std::size_t rank)
+                                                     { return std::unique_ptr<Transport<TScalar>>(new TcpTransport<TScalar>(rank, nRanks, "127.0.0.1", port, N)); });
+            transport.reset(new TcpTransport<TScalar>(0, nRanks, "127.0.0.1", port, N));
+        }
+
+        // Timed from the moment rank 0 is connected, so process start-up and the TCP handshake are not included.
+        auto timerStart = std::chrono::steady_clock::now();
+        WorkerTimes times;
+        cholRankIter<TScalar, N, NBlock>(0, nRanks, mat, *transport, true, false, result, times);
+        seconds = std::chrono::steady_clock::now() - timerStart;
+        for (pid_t child : children)
+        {
+            int status = 0;
+            ::waitpid(child, &status, 0);
+            childrenSucceeded = childrenSucceeded && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+        transport.reset();
+        if (transportName == "shm")
+        {
+            SharedMemoryTransport<TScalar>::remove(shmName);
+        }
+    }
+
+    const TScalar residual = choleskyResidual(mat, result, VerificationMode::Freivalds);
+    std::cout << "Distributed Cholesky, N = " << N << ", block width " << NBlock << ", " << nRanks << " ranks over " << transportName << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * seconds.count()) << std::endl;
+    printResidual(residual, VerificationMode::Freivalds);
+    std::cout << "All ranks succeeded: " << (childrenSucceeded ? "yes" : "no") << std::endl;
+    std::cout << "Bitwise identical to sequential: " << (result.bitwiseEquals(sequentialResult) ? "yes" : "no") << std::endl;
+    std::cout << "---------------------------" << std::endl;
+}
+
+/**
+ * @brief Usage: cholesky_distributed [inprocess|shm|tcp|all] [ranks] [port]
+ */
+int main(int argc, char **argv)
+{
+    constexpr std::size_t N = 1024;
+    constexpr std::size_t NBlock = 32;
+    const std::string transportName = (argc > 1) ? argv[1] : "all";
+    const std::size_t nRanks = (argc > 2) ? std::stoul(argv[2]) : 4;
+    const std::uint16_t port = (argc > 3) ? (std::uint16_t)std::stoul(argv[3]) : 47017;
+
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    Matrix<float, N, N> sequentialResult;
+    MessageQueue<CholeskyMessage<float, N>> messageQueue;
+    cholBlockIter<float, N, N>(0, mat, messageQueue, true, false, sequentialResult);
+
+    try
+    {
+        for (const std::string name : {"inprocess", "shm", "tcp"})
+        {
+            if (transportName == name || transportName == "all")
+            {
+                computeCholeskyDistributed<float, N, NBlock>(mat, sequentialResult, name, nRanks, port);
+            }
+        }
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "FATAL ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
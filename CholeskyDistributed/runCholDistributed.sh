@@ -0,0 +1,5 @@
+#!/bin/bash
+
+g++ -Wall -std=c++17 -O3 -march=native -pthread -o cholesky_distributed ./CholeskyDistributed.cpp -lrt
+./cholesky_distributed "$@"
+rm ./cholesky_distributed
@@ -0,0 +1,378 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <string>
+#include <stdexcept>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "TileStore.hpp"
+#include "TileCache.hpp"
+
+/**
+ * @brief Factor a diagonal tile in place, A = L * L^T, leaving L in the lower triangle and zeros above it.
+ *
+ * Row by row (Cholesky-Banachiewicz), so that every inner product runs over two contiguous rows.
+ */
+template <typename TScalar, std::size_t NTile>
+void tileCholesky(Matrix<TScalar, NTile, NTile> &tile)
+{
+    for (std::size_t r = 0; r != NTile; ++r)
+    {
+        TScalar *row = tile.rowData(r);
+        for (std::size_t c = 0; c <= r; ++c)
+        {
+            const TScalar *factorRow = tile.rowData(c);
+            TScalar sum = row[c];
+            for (std::size_t m = 0; m != c; ++m)
+            {
+                sum -= row[m] * factorRow[m];
+            }
+            row[c] = (c == r) ? std::sqrt(sum) : sum / factorRow[c];
+        }
+        for (std::size_t c = r + 1; c != NTile; ++c)
+        {
+            row[c] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Overwrite a tile A with A * L^-T, where L is a factored diagonal tile. Rows are independent and are split
+ * across threads.
+ */
+template <typename TScalar, std::size_t NTile>
+void tileSolveTranspose(Matrix<TScalar, NTile, NTile> &tile, const Matrix<TScalar, NTile, NTile> &factor)
+{
+    parallelForRange(NTile, NTile * NTile / 2, [&tile, &factor](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t r = begin; r != end; ++r)
+                         {
+                             TScalar *row = tile.rowData(r);
+                             for (std::size_t c = 0; c != NTile; ++c)
+                             {
+                                 const TScalar *factorRow = factor.rowData(c);
+                                 TScalar sum = row[c];
+                                 for (std::size_t m = 0; m != c; ++m)
+                                 {
+                                     sum -= factorRow[m] * row[m];
+                                 }
+                                 row[c] = sum / factorRow[c];
+                             }
+                         }
+                     });
+}
+
+/**
+ * @brief The tile accesses of outOfCoreCholesky, in order, for the prefetching reader thread.
+ *
+ * For tile column j and tile row i >= j: (i, j), then (i, k), (j, k) for k = 0, ..., j - 1, then (j, j) if i > j.
+ */
+struct LeftLookingSchedule
+{
+    std::size_t nTiles;
+    std::size_t j = 0;
+    std::size_t i = 0;
+    std::size_t step = 0;
+
+    bool operator()(TileIndex &next)
+    {
+        if (j == nTiles)
+        {
+            return false;
+        }
+        if (step == 0)
+        {
+            next = TileIndex{i, j};
+        }
+        else if (step <= 2 * j)
+        {
+            const std::size_t k = (step - 1) / 2;
+            next = (step % 2 == 1) ? TileIndex{i, k} : TileIndex{j, k};
+        }
+        else
+        {
+            next = TileIndex{j, j};
+        }
+
+        ++step;
+        if (step == 2 * j + 1 + (i > j ? 1 : 0))
+        {
+            step = 0;
+            ++i;
+            if (i == nTiles)
+            {
+                ++j;
+                i = j;
+            }
+        }
+        return true;
+    };
+};
+
+/**
+ * @brief Factor the matrix held in the tile store in place, A = L * L^T, through a tile cache.
+ *
+ * Left-looking by tile columns: tile (i, j) receives all its updates L_ik * L_jk^T, k < j, is factored (i = j) or
+ * solved against L_jj (i > j), and is then final, so every tile of L is written once. Within a tile column the tiles
+ * L_jk of row j are reused for every i and stay resident when the budget holds a tile row; the tiles L_ik are
+ * streamed. The tile kernels use the multi-threaded Matrix product while the cache's reader thread fetches the
+ * tiles that come next.
+ *
+ * @param cache The tile cache; must not have a schedule yet.
+ * @param lookahead How many tile accesses the reader thread may run ahead of the computation.
+ */
+template <typename TScalar, std::size_t NTile>
+void outOfCoreCholesky(TileCache<TScalar, NTile> &cache, std::size_t nTiles, std::size_t lookahead)
+{
+    typedef Matrix<TScalar, NTile, NTile> Tile;
+    cache.prefetch(LeftLookingSchedule{nTiles}, lookahead);
+
+    for (std::size_t j = 0; j != nTiles; ++j)
+    {
+        for (std::size_t i = j; i != nTiles; ++i)
+        {
+            std::shared_ptr<Tile> tile = cache.acquire(i, j);
+            if (j != 0)
+            {
+                Tile update;
+                for (std::size_t k = 0; k != j; ++k)
+                {
+                    std::shared_ptr<Tile> left = cache.acquire(i, k);
+                    std::shared_ptr<Tile> right = cache.acquire(j, k);
+                    left->multiplyRight(right->transpose(), update);
+                }
+                tile->add(update, -1.0);
+            }
+
+            if (i == j)
+            {
+                tileCholesky(*tile);
+            }
+            else
+            {
+                std::shared_ptr<Tile> diagonal = cache.acquire(j, j);
+                tileSolveTranspose(*tile, *diagonal);
+            }
+            cache.markDirty(i, j);
+        }
+    }
+    cache.flush();
+}
+
+/**
+ * @brief Write the lower triangle of randomSPD<TScalar, nTiles * NTile>(seed) to the store, tile by tile and in
+ * parallel, without ever holding the whole matrix.
+ */
+template <typename TScalar, std::size_t NTile>
+void generateOutOfCoreInput(TileStore<TScalar, NTile> &store, std::uint64_t seed)
+{
+    const std::size_t nTiles = store.tileCount();
+    const std::size_t n = nTiles * NTile;
+    const CounterRng rng(seed);
+    std::vector<TileIndex> tiles{};
+    for (std::size_t i = 0; i != nTiles; ++i)
+    {
+        for (std::size_t j = 0; j <= i; ++j)
+        {
+            tiles.push_back(TileIndex{i, j});
+        }
+    }
+
+    parallelForCyclic(tiles.size(), 32 * NTile * NTile, [&store, &tiles, &rng, n](std::size_t t)
+                      {
+                          Matrix<TScalar, NTile, NTile> tile;
+                          for (std::size_t r = 0; r != NTile; ++r)
+                          {
+                              TScalar *row = tile.rowData(r);
+                              for (std::size_t c = 0; c != NTile; ++c)
+                              {
+                                  row[c] = randomSPDEntry<TScalar>(rng, n, tiles[t].i * NTile + r, tiles[t].j * NTile + c);
+                              }
+                          }
+                          store.write(tiles[t].i, tiles[t].j, tile);
+                      });
+}
+
+/**
+ * @brief Freivalds check of the factor in the store against the generated matrix, streaming L twice and
+ * regenerating A row by row, so that memory stays O(N) for defaultVerificationProbes probe vectors.
+ *
+ * @return The percent residual 100 * |L * (L^T * X) - A * X| / |A * X| (Frobenius norms).
+ */
+template <typename TScalar, std::size_t NTile>
+TScalar outOfCoreResidual(TileStore<TScalar, NTile> &store, std::uint64_t seed)
+{
+    constexpr std::size_t P = defaultVerificationProbes;
+    const std::size_t nTiles = store.tileCount();
+    const std::size_t n = nTiles * NTile;
+
+    std::mt19937 signs;
+    signs.seed(11828);
+    std::bernoulli_distribution coin(0.5);
+    std::vector<TScalar> probes(n * P);
+    for (TScalar &probe : probes)
+    {
+        probe = coin(signs) ? (TScalar)1 : (TScalar)-1;
+    }
+
+    // W = L^T * X, then Y = L * W, one tile of L in memory at a time.
+    std::vector<TScalar> transposeTimesProbes(n * P, 0);
+    std::vector<TScalar> computed(n * P, 0);
+    Matrix<TScalar, NTile, NTile> tile;
+    for (std::size_t i = 0; i != nTiles; ++i)
+    {
+        for (std::size_t k = 0; k <= i; ++k)
+        {
+            store.read(i, k, tile);
+            for (std::size_t r = 0; r != NTile; ++r)
+            {
+                const TScalar *row = tile.rowData(r);
+                const TScalar *x = &probes[(i * NTile + r) * P];
+                for (std::size_t c = 0; c != NTile; ++c)
+                {
+                    TScalar *w = &transposeTimesProbes[(k * NTile + c) * P];
+                    for (std::size_t p = 0; p != P; ++p)
+                    {
+                        w[p] += row[c] * x[p];
+                    }
+                }
+            }
+        }
+    }
+    for (std::size_t i = 0; i != nTiles; ++i)
+    {
+        for (std::size_t k = 0; k <= i; ++k)
+        {
+            store.read(i, k, tile);
+            for (std::size_t r = 0; r != NTile; ++r)
+            {
+                const TScalar *row = tile.rowData(r);
+                TScalar *y = &computed[(i * NTile + r) * P];
+                for (std::size_t c = 0; c != NTile; ++c)
+                {
+                    const TScalar *w = &transposeTimesProbes[(k * NTile + c) * P];
+                    for (std::size_t p = 0; p != P; ++p)
+                    {
+                        y[p] += row[c] * w[p];
+                    }
+                }
+            }
+        }
+    }
+
+    // A * X, regenerating each row of A.
+    const CounterRng rng(seed);
+    std::vector<TScalar> expected(n * P, 0);
+    parallelForRange(n, 32 * n, [&rng, &probes, &expected, n](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t r = begin; r != end; ++r)
+                         {
+                             TScalar *z = &expected[r * P];
+                             for (std::size_t c = 0; c != n; ++c)
+                             {
+                                 const TScalar entry = randomSPDEntry<TScalar>(rng, n, r, c);
+                                 for (std::size_t p = 0; p != P; ++p)
+                                 {
+                                     z[p] += entry * probes[c * P + p];
+                                 }
+                             }
+                         }
+                     });
+
+    TScalar differenceSquared = 0;
+    TScalar expectedSquared = 0;
+    for (std::size_t e = 0; e != n * P; ++e)
+    {
+        differenceSquared += (computed[e] - expected[e]) * (computed[e] - expected[e]);
+        expectedSquared += expected[e] * expected[e];
+    }
+    return 100.0 * std::sqrt(differenceSquared / expectedSquared);
+}
+
+template <typename TScalar, std::size_t NTile>
+void calculateCholeskyOutOfCore(std::size_t nTiles, std::size_t budgetBytes, VerificationMode verification, const std::string &path)
+{
+    constexpr std::uint64_t seed = 11828;
+    const std::size_t n = nTiles * NTile;
+    TileStore<TScalar, NTile> store(path, nTiles);
+
+    auto generateStart = std::chrono::steady_clock::now();
+    generateOutOfCoreInput(store, seed);
+    auto generateStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> generateSeconds = generateStop - generateStart;
+
+    std::size_t capacity;
+    std::size_t hits, waits, misses, prefetched;
+    auto timerStart = std::chrono::steady_clock::now();
+    {
+        TileCache<TScalar, NTile> cache(store, budgetBytes);
+        capacity = cache.tileCapacity();
+        outOfCoreCholesky(cache, nTiles, std::max<std::size_t>(1, capacity / 4));
+        hits = cache.hits();
+        waits = cache.waits();
+        misses = cache.misses();
+        prefetched = cache.prefetched();
+    }
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> seconds = timerStop - timerStart;
+    // Input generation only writes, once per tile.
+    const std::size_t nPacked = nTiles * (nTiles + 1) / 2;
+    const std::size_t readsAfterSolve = store.reads();
+    const std::size_t writesAfterSolve = store.writes();
+
+    TScalar residual = std::numeric_limits<TScalar>::quiet_NaN();
+    auto verifyStart = std::chrono::steady_clock::now();
+    if (verification != VerificationMode::None)
+    {
+        // Full mode would need the N by N product; the streaming check is the Freivalds one.
+        verification = VerificationMode::Freivalds;
+        residual = outOfCoreResidual(store, seed);
+    }
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifySeconds = verifyStop - verifyStart;
+
+    const double tileMegabytes = TileStore<TScalar, NTile>::tileBytes / 1048576.0;
+    std::cout << "Out-of-core Cholesky, N = " << n << ", tile " << NTile << ", " << nPacked << " tiles on disk ("
+              << (int)(nPacked * tileMegabytes) << " MB)" << std::endl;
+    std::cout << "Memory budget: " << capacity << " tiles (" << (int)(capacity * tileMegabytes) << " MB)" << std::endl;
+    std::cout << "Input generation milliseconds: " << (int)(1000 * generateSeconds.count()) << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * seconds.count()) << std::endl;
+    std::cout << "GFLOP/s: " << (double)n * n * n / 3.0 / seconds.count() / 1e9 << std::endl;
+    std::cout << "Tile reads: " << readsAfterSolve << ", tile writes: " << writesAfterSolve - nPacked << std::endl;
+    std::cout << "Acquires: " << hits << " resident, " << waits << " waited for prefetch, " << misses << " synchronous reads; "
+              << prefetched << " tiles prefetched" << std::endl;
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << (int)(1000 * verifySeconds.count()) << std::endl;
+    std::cout << "---------------------------" << std::endl;
+}
+
+/**
+ * @brief Usage: cholesky_ooc [tiles per dimension] [memory budget in MB] [freivalds|none] [tile file]
+ *
+ * The matrix is (tiles * 256) square in double; e.g. 200 tiles and a 2048 MB budget factor N = 51200 (10 GB of
+ * lower-triangular tiles on disk).
+ */
+int main(int argc, char **argv)
+{
+    constexpr std::size_t NTile = 256;
+    const std::size_t nTiles = (argc > 1) ? std::stoul(argv[1]) : 16;
+    const std::size_t budgetMegabytes = (argc > 2) ? std::stoul(argv[2]) : 32;
+    const std::string verificationName = (argc > 3) ? argv[3] : "freivalds";
+    const std::string path = (argc > 4) ? argv[4] : "./cholesky_tiles.bin";
+    const VerificationMode verification = (verificationName == "none") ? VerificationMode::None : VerificationMode::Freivalds;
+
+    try
+    {
+        calculateCholeskyOutOfCore<double, NTile>(nTiles, budgetMegabytes * 1048576, verification, path);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cout << "FATAL ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
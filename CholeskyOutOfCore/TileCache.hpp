@@ -0,0 +1,388 @@
+#ifndef TILECACHEHPP
+#define TILECACHEHPP
+
+#include <list>
+#include <cmath>
+#include <memory>
+#include <exception>
+#include <stdexcept>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+#include "TileStore.hpp"
+
+/**
+ * @brief The coordinates (i, j), i >= j, of a tile in a TileStore.
+ */
+struct TileIndex
+{
+    std::size_t i;
+    std::size_t j;
+};
+
+/**
+ * @brief An LRU cache of tiles of a TileStore with a memory budget and a prefetching reader thread.
+ *
+ * Tiles are handed out as shared pointers; a tile is pinned while any pointer other than the cache's own is alive
+ * and only unpinned tiles are evicted (dirty ones are written back first). If every resident tile is pinned the
+ * cache temporarily exceeds its budget rather than fail.
+ *
+ * Prefetching follows a schedule: a callable that yields the tile accesses of the computation in order. The
+ * computation must then acquire tiles in exactly that order; the reader thread walks the same schedule up to
+ * lookahead accesses ahead of the last acquire and loads every tile that is not resident, so that the computation
+ * only waits for I/O when the disk cannot keep up. If the reader thread fails (a read or write-back throws), it
+ * stops prefetching and the exception is rethrown from the next acquire.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam NTile The tile size
+ */
+template <typename TScalar, std::size_t NTile>
+class TileCache
+{
+public:
+    typedef Matrix<TScalar, NTile, NTile> Tile;
+    typedef std::function<bool(TileIndex &)> Schedule;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Tile> tile;
+        // Being read from or written back to the store.
+        bool busy;
+        bool dirty;
+        std::list<std::size_t>::iterator recency;
+    };
+
+    TileStore<TScalar, NTile> &store;
+    std::size_t capacity;
+    std::unordered_map<std::size_t, Entry> entries{};
+    std::list<std::size_t> recency{};
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+
+    Schedule schedule;
+    std::size_t lookahead = 0;
+    std::size_t nAcquired = 0;
+    std::size_t nScheduled = 0;
+    bool stopping = false;
+    std::thread reader;
+    std::exception_ptr readerError{};
+
+    std::size_t nHits = 0;
+    std::size_t nWaits = 0;
+    std::size_t nMisses = 0;
+    std::size_t nPrefetched = 0;
+
+    static std::size_t key(std::size_t i, std::size_t j)
+    {
+        return i * (i + 1) / 2 + j;
+    };
+
+    static TileIndex index(std::size_t key)
+    {
+        std::size_t i = (std::size_t)((std::sqrt(8.0 * key + 1.0) - 1.0) / 2.0);
+        while (i * (i + 1) / 2 > key)
+        {
+            --i;
+        }
+        while ((i + 1) * (i + 2) / 2 <= key)
+        {
+            ++i;
+        }
+        return TileIndex{i, key - i * (i + 1) / 2};
+    };
+
+    /**
+     * @brief Evict least recently used unpinned tiles until the resident tiles fit. Called with the mutex held through
+     * lock. A dirty victim is unlinked from the recency list and stays in entries in the busy state while it is written
+     * back without the mutex, so that an acquire of it waits for the write instead of reading a stale tile. If the
+     * write throws, the victim is relinked as least recently used and still dirty before the exception propagates.
+     */
+    void makeRoom(std::unique_lock<std::mutex> &lock)
+    {
+        auto candidate = recency.end();
+        while (entries.size() > capacity && candidate != recency.begin())
+        {
+            --candidate;
+            const std::size_t evicted = *candidate;
+            Entry &entry = entries[evicted];
+            if (entry.busy || entry.tile.use_count() != 1)
+            {
+                continue;
+            }
+            candidate = recency.erase(candidate);
+            if (!entry.dirty)
+            {
+                entries.erase(evicted);
+                continue;
+            }
+            entry.busy = true;
+            const std::shared_ptr<Tile> tile = entry.tile;
+            lock.unlock();
+            const TileIndex position = index(evicted);
+            try
+            {
+                store.write(position.i, position.j, *tile);
+            }
+            catch (...)
+            {
+                lock.lock();
+                Entry &failed = entries[evicted];
+                failed.busy = false;
+                failed.recency = recency.insert(recency.end(), evicted);
+                changed.notify_all();
+                throw;
+            }
+            lock.lock();
+            entries.erase(evicted);
+            changed.notify_all();
+            // The list may have changed while the mutex was released.
+            candidate = recency.end();
+        }
+    };
+
+    /**
+     * @brief Insert a tile in the busy state, make room for it and read it from the store. Called with the mutex held
+     * through lock. The entry is inserted first so that an acquire or prefetch of the same tile while makeRoom writes
+     * back a victim waits for it rather than loading it twice. If making room or the read throws, the entry is
+     * removed again (waking any acquire waiting for it) before the exception propagates.
+     */
+    std::shared_ptr<Tile> load(std::size_t k, std::unique_lock<std::mutex> &lock)
+    {
+        recency.push_front(k);
+        std::shared_ptr<Tile> tile = std::make_shared<Tile>();
+        entries[k] = Entry{tile, true, false, recency.begin()};
+        try
+        {
+            makeRoom(lock);
+            lock.unlock();
+            const TileIndex position = index(k);
+            store.read(position.i, position.j, *tile);
+        }
+        catch (...)
+        {
+            if (!lock.owns_lock())
+            {
+                lock.lock();
+            }
+            recency.erase(entries[k].recency);
+            entries.erase(k);
+            changed.notify_all();
+            throw;
+        }
+        lock.lock();
+        entries[k].busy = false;
+        changed.notify_all();
+        return tile;
+    };
+
+    void readAhead()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        try
+        {
+            while (true)
+            {
+                changed.wait(lock, [this]()
+                             { return stopping || nScheduled < nAcquired + lookahead; });
+                if (stopping)
+                {
+                    return;
+                }
+                TileIndex next;
+                if (!schedule(next))
+                {
+                    return;
+                }
+                ++nScheduled;
+                const std::size_t k = key(next.i, next.j);
+                if (entries.find(k) == entries.end())
+                {
+                    load(k, lock);
+                    ++nPrefetched;
+                }
+            }
+        }
+        catch (...)
+        {
+            // An exception escaping a thread calls std::terminate; hand it to the computation instead.
+            if (!lock.owns_lock())
+            {
+                lock.lock();
+            }
+            readerError = std::current_exception();
+            changed.notify_all();
+        }
+    };
+
+public:
+    /**
+     * @brief Construct a cache over the given store.
+     *
+     * @param store The tile store.
+     * @param budgetBytes Memory budget for resident tiles; at least 4 tiles are always allowed.
+     */
+    TileCache(TileStore<TScalar, NTile> &store, std::size_t budgetBytes) : store(store), capacity(std::max<std::size_t>(4, budgetBytes / TileStore<TScalar, NTile>::tileBytes)){};
+
+    ~TileCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        if (reader.joinable())
+        {
+            reader.join();
+        }
+    };
+
+    TileCache(const TileCache &) = delete;
+    TileCache &operator=(const TileCache &) = delete;
+
+    std::size_t tileCapacity() const
+    {
+        return capacity;
+    };
+
+    /**
+     * @brief Start the reader thread on the given schedule. Call at most once, before the first acquire.
+     *
+     * @param accessSchedule Yields the tile accesses of the computation in order; returns false when done.
+     * @param accessLookahead How many accesses the reader may run ahead; keep it well below the tile capacity
+     * so that prefetched tiles are not evicted before they are used.
+     */
+    void prefetch(Schedule accessSchedule, std::size_t accessLookahead)
+    {
+        schedule = accessSchedule;
+        lookahead = accessLookahead;
+        reader = std::thread(&TileCache::readAhead, this);
+    };
+
+    /**
+     * @brief Return tile (i, j), i >= j, loading it if it is not resident. The tile stays pinned while the
+     * returned pointer is alive. Rethrows the exception of a failed reader thread.
+     */
+    std::shared_ptr<Tile> acquire(std::size_t i, std::size_t j)
+    {
+        const std::size_t k = key(i, j);
+        std::unique_lock<std::mutex> lock(mutex);
+        if (readerError)
+        {
+            std::rethrow_exception(readerError);
+        }
+        ++nAcquired;
+        changed.notify_all();
+
+        auto found = entries.find(k);
+        if (found == entries.end())
+        {
+            ++nMisses;
+            return load(k, lock);
+        }
+        if (found->second.busy)
+        {
+            ++nWaits;
+            changed.wait(lock, [this, k]()
+                         {
+                             auto current = entries.find(k);
+                             return current == entries.end() || !current->second.busy;
+                         });
+            if (readerError)
+            {
+                std::rethrow_exception(readerError);
+            }
+            found = entries.find(k);
+            if (found == entries.end())
+            {
+                // Evicted before this thread woke up.
+                return load(k, lock);
+            }
+        }
+        else
+        {
+            ++nHits;
+        }
+        recency.splice(recency.begin(), recency, found->second.recency);
+        return found->second.tile;
+    };
+
+    /**
+     * @brief Mark a resident tile as modified, so that it is written back before eviction and by flush. Call it
+     * while the pointer returned by acquire is still alive, so that the tile cannot have been evicted.
+     *
+     * @throws std::logic_error if the tile is not resident.
+     */
+    void markDirty(std::size_t i, std::size_t j)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(key(i, j));
+        if (found == entries.end())
+        {
+            throw std::logic_error("markDirty of a tile that is not resident");
+        }
+        found->second.dirty = true;
+    };
+
+    /**
+     * @brief Write every dirty resident tile back to the store, after waiting for write-backs of evicted tiles.
+     */
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]()
+                     {
+                         for (const auto &item : entries)
+                         {
+                             if (item.second.busy && item.second.dirty)
+                             {
+                                 return false;
+                             }
+                         }
+                         return true;
+                     });
+        for (auto &item : entries)
+        {
+            if (item.second.dirty && !item.second.busy)
+            {
+                const TileIndex position = index(item.first);
+                store.write(position.i, position.j, *item.second.tile);
+                item.second.dirty = false;
+            }
+        }
+    };
+
+    std::size_t hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nHits;
+    };
+
+    /**
+     * @brief Acquires that found their tile still being prefetched or written back.
+     */
+    std::size_t waits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nWaits;
+    };
+
+    /**
+     * @brief Acquires that had to read their tile synchronously.
+     */
+    std::size_t misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nMisses;
+    };
+
+    std::size_t prefetched() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nPrefetched;
+    };
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef TILESTOREHPP
+#define TILESTOREHPP
+
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <atomic>
+#include <stdexcept>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "../Matrix/Matrix.hpp"
+
+/**
+ * @brief The lower triangle of an (nTiles * NTile) square matrix, stored tile by tile in a file.
+ *
+ * Tile (i, j) with i >= j lives at packed index i * (i + 1) / 2 + j, each tile as NTile contiguous rows. Reads and
+ * writes are positional (preadv / pwritev), so several threads may transfer different tiles at the same time. The
+ * file is created (truncated) by the constructor and removed by the destructor.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam NTile The tile size
+ */
+template <typename TScalar, std::size_t NTile>
+class TileStore
+{
+public:
+    typedef Matrix<TScalar, NTile, NTile> Tile;
+
+    static constexpr std::size_t tileBytes = NTile * NTile * sizeof(TScalar);
+
+private:
+    static_assert(NTile <= IOV_MAX, "A tile is transferred with one iovec per row");
+
+    std::string path;
+    std::size_t nTiles;
+    int fd;
+    std::atomic<std::size_t> nReads{0};
+    std::atomic<std::size_t> nWrites{0};
+
+    off_t offset(std::size_t i, std::size_t j) const
+    {
+        return (off_t)((i * (i + 1) / 2 + j) * tileBytes);
+    };
+
+    /**
+     * @brief Transfer all rows of a tile, resuming after short transfers and EINTR.
+     */
+    template <typename TTransfer>
+    void transferAll(iovec *rows, off_t position, TTransfer transfer, const char *what)
+    {
+        std::size_t first = 0;
+        while (first != NTile)
+        {
+            const ssize_t count = transfer(fd, rows + first, (int)(NTile - first), position);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                throw std::runtime_error(std::string(what) + " of " + path + " failed: " + (count < 0 ? std::strerror(errno) : "end of file"));
+            }
+            position += count;
+            std::size_t remaining = (std::size_t)count;
+            while (first != NTile && remaining >= rows[first].iov_len)
+            {
+                remaining -= rows[first].iov_len;
+                ++first;
+            }
+            if (first != NTile)
+            {
+                rows[first].iov_base = (char *)rows[first].iov_base + remaining;
+                rows[first].iov_len -= remaining;
+            }
+        }
+    };
+
+public:
+    TileStore(const std::string &path, std::size_t nTiles) : path(path), nTiles(nTiles)
+    {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        }
+        if (::ftruncate(fd, offset(nTiles, 0)) != 0)
+        {
+            const std::string error = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Cannot size " + path + ": " + error);
+        }
+    };
+
+    ~TileStore()
+    {
+        ::close(fd);
+        std::remove(path.c_str());
+    };
+
+    TileStore(const TileStore &) = delete;
+    TileStore &operator=(const TileStore &) = delete;
+
+    std::size_t tileCount() const
+    {
+        return nTiles;
+    };
+
+    /**
+     * @brief Read tile (i, j), i >= j, into the given tile.
+     */
+    void read(std::size_t i, std::size_t j, Tile &tile)
+    {
+        iovec rows[NTile];
+        for (std::size_t r = 0; r != NTile; ++r)
+        {
+            rows[r].iov_base = tile.rowData(r);
+            rows[r].iov_len = NTile * sizeof(TScalar);
+        }
+        transferAll(rows, offset(i, j), ::preadv, "Read");
+        ++nReads;
+    };
+
+    /**
+     * @brief Write the given tile to tile (i, j), i >= j.
+     */
+    void write(std::size_t i, std::size_t j, const Tile &tile)
+    {
+        iovec rows[NTile];
+        for (std::size_t r = 0; r != NTile; ++r)
+        {
+            rows[r].iov_base = const_cast<TScalar *>(tile.rowData(r));
+            rows[r].iov_len = NTile * sizeof(TScalar);
+        }
+        transferAll(rows, offset(i, j), ::pwritev, "Write");
+        ++nWrites;
+    };
+
+    std::size_t reads() const
+    {
+        return nReads;
+    };
+
+    std::size_t writes() const
+    {
+        return nWrites;
+    };
+};
+
+#endif
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+g++ -Wall -std=c++17 -O3 -march=native -pthread -o cholesky_ooc ./CholeskyOutOfCore.cpp
+./cholesky_ooc "$@"
+rm ./cholesky_ooc
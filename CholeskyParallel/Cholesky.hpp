@@ -0,0 +1,502 @@
+#ifndef CHOLESKYHPP
+#define CHOLESKYHPP
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <cmath>
+#include <optional>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "../MessageQueue/MessageQueue.hpp"
+#include "../MessageQueue/Transport.hpp"
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/FloatingPoint.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../Matrix/SolveControl.hpp"
+#include "../Matrix/PerfCounters.hpp"
+
+template <typename TScalar, std::size_t N>
+void populateCholMat(Matrix<TScalar, N, 1> &column /* mutated!! */, Matrix<TScalar, N, N> &result, std::size_t i)
+{
+    const TScalar diagElem = std::sqrt(std::abs(column.get(i, 0)));
+    column.set(i, 0, diagElem);
+    for (std::size_t j = i + 1; j != N; ++j)
+    {
+        TScalar val = column.get(j, 0) / diagElem;
+        column.set(j, 0, val);
+    }
+
+    result.overwriteSubmatrix(column, 0, i);
+}
+
+/**
+ * @brief CPU time consumed so far by the calling thread.
+ */
+inline std::chrono::duration<double> threadCpuTime()
+{
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return std::chrono::duration<double>(now.tv_sec + 1e-9 * now.tv_nsec);
+}
+
+/**
+ * @brief Wall time and CPU time of one Cholesky worker. CPU time excludes time spent sleeping while waiting for
+ * messages and time spent descheduled, so it measures the work a worker did even with more threads than cores.
+ * Workers on a MessageQueue also record how many messages they received, and with PERF_COUNTERS set every worker
+ * records its own hardware counters.
+ */
+struct WorkerTimes
+{
+    std::chrono::duration<double> wall{};
+    std::chrono::duration<double> busy{};
+    std::size_t messages = 0;
+    PerfCounts counters{};
+};
+
+/**
+ * @brief Records the wall and CPU time, and the hardware counters if requested, of the enclosing scope of a worker
+ * thread into times; does nothing if times is null.
+ */
+class WorkerTimer
+{
+private:
+    WorkerTimes *times;
+    std::chrono::steady_clock::time_point wallStart;
+    std::chrono::duration<double> cpuStart;
+    PerfCounters counters;
+
+public:
+    WorkerTimer(WorkerTimes *times) : times(times), wallStart(std::chrono::steady_clock::now()), cpuStart(threadCpuTime()), counters(times && perfCountersRequested(), false){};
+
+    ~WorkerTimer()
+    {
+        if (times)
+        {
+            times->wall = std::chrono::steady_clock::now() - wallStart;
+            times->busy = threadCpuTime() - cpuStart;
+            times->counters = counters.read();
+        }
+    };
+};
+
+/**
+ * @brief Consecutive finished columns of the parallel Cholesky, published as one message: columns[k] is column
+ * first + k of the Schur complement (unscaled, zero above the diagonal), stored contiguously.
+ */
+template <typename TScalar, std::size_t N>
+struct CholeskyPanel
+{
+    std::size_t first;
+    std::vector<std::vector<TScalar>> columns;
+};
+
+/**
+ * @brief The message type of cholBlockIter. Panels are shared and immutable, so receiving one copies a pointer, not
+ * its entries.
+ */
+template <typename TScalar, std::size_t N>
+using CholeskyMessage = std::shared_ptr<const CholeskyPanel<TScalar, N>>;
+
+/**
+ * @brief Write column i of L from the unscaled column i of the Schur complement (see populateCholMat).
+ */
+template <typename TScalar, std::size_t N>
+void populateCholColumn(const std::vector<TScalar> &column, Matrix<TScalar, N, N> &result, std::size_t i)
+{
+    const TScalar diagElem = std::sqrt(std::abs(column[i]));
+    for (std::size_t j = 0; j != i; ++j)
+    {
+        result.set(j, i, column[j]);
+    }
+    result.set(i, i, diagElem);
+    for (std::size_t j = i + 1; j != N; ++j)
+    {
+        result.set(j, i, column[j] / diagElem);
+    }
+}
+
+/**
+ * @brief Apply the rank-1 updates A -= c * c^T / c_i of consecutive finished columns c (with diagonal index
+ * i = firstColumn, firstColumn + 1, ...) to rows firstRow, ..., N - 1 of a block whose first column is firstIdx.
+ *
+ * This is a rank-k update done row by row: each row of the block stays in cache while all k columns are applied to
+ * it, so k columns cost one pass over the block instead of k. Every entry still receives its terms one at a time in
+ * column order, each rounded exactly as by the rank-1 update through outerProduct and add, so the block is bitwise
+ * the same as after k separate updates. Rows above firstRow are not updated: cholBlockIter never reads them again.
+ *
+ * Only block columns columnBegin, ..., columnEnd - 1 are updated, and with lowerOnly only the entries on or below
+ * the diagonal (firstIdx + j <= r); checkpointedCholesky uses this to update the lower triangle of a square matrix.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+void applyCholeskyColumns(Matrix<TScalar, N, NBlock> &mat, std::size_t firstIdx, const std::vector<const TScalar *> &columns, std::size_t firstColumn, std::size_t firstRow, std::size_t columnBegin = 0, std::size_t columnEnd = NBlock, bool lowerOnly = false)
+{
+    const std::size_t k = columns.size();
+    std::vector<TScalar> scales(k);
+    for (std::size_t n = 0; n != k; ++n)
+    {
+        scales[n] = -1.0 / columns[n][firstColumn + n];
+    }
+    const TScalar zero = 0;
+    for (std::size_t r = firstRow; r != N; ++r)
+    {
+        TScalar *row = mat.rowData(r);
+        const std::size_t end = lowerOnly ? std::min(columnEnd, r + 1 - std::min(r + 1, firstIdx)) : columnEnd;
+        for (std::size_t n = 0; n != k; ++n)
+        {
+            const TScalar a = columns[n][r];
+            const TScalar scale = scales[n];
+            const TScalar *subcolumn = columns[n] + firstIdx;
+            for (std::size_t j = columnBegin; j < end; ++j)
+            {
+                // zero + product rounds like the outer product accumulated into a zero matrix.
+                row[j] += scale * (zero + a * subcolumn[j]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compute one block in the parallel Cholesky. The block shape is N by NBlock; NBlock must divide N.
+ * 
+ * The decomposition is
+ * 
+ * A = L * L^T
+ * 
+ * The results are enqueued successively, from left to right, in panels of consecutive columns, and each column
+ * allows a column of L to be constructed. Thus the calling thread is responsible for constructing L; this
+ * reconstruction is a lower-order cost and thus does not need its own parallelism.
+ *
+ * While waiting for the columns to its left, a block drains every panel that is available at once and applies all
+ * their columns as one rank-k update (applyCholeskyColumns), so the locking and the pass over the block are paid
+ * once per batch rather than once per column.
+ * 
+ * @tparam TScalar The scalar type (should usually be float or double -- int will not work)
+ * @tparam N Matrix size
+ * @tparam NBlock Number of columns in this block. Must divide N.
+ * @param blockIndex The zero-based index of this block (left to right).
+ * @param mat Should be initialized with the corresponding block of the (symmetric positive definite) matrix A.
+ * @param messageQueue The queue for communication across threads. Panels are tagged with blockIndex, and the block
+ * subscribes to the tags of the blocks to its left only.
+ * @param populateResultMat Whether to skip messaging and simply populate the result matrix for this block (for sequential solve).
+ * @param deterministic Whether to fix the floating-point environment of the thread. The update order itself is
+ * already fixed: column i is only published after columns 0..i-1 were, so every block applies the same rank-1
+ * updates in the same order for any NBlock, batch and panel size, and the factor is bitwise identical to the
+ * sequential one.
+ * @param resultMat The result matrix
+ * @param times If not null, receives the wall time and the CPU time of this call, and the number of messages
+ * received.
+ * @param control If not null, advanced by one step per finished column of this block; when cancelled, the block
+ * returns before its next column or while waiting for a message, without publishing the rest of its columns.
+ * @param panelColumns The number of columns published per message, at most NBlock. Wider panels mean fewer messages
+ * but make the blocks to the right wait until the whole panel is finished.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+void cholBlockIter(std::size_t blockIndex, Matrix<TScalar, N, NBlock> mat, MessageQueue<CholeskyMessage<TScalar, N>> &messageQueue, bool populateResultMat, bool deterministic, Matrix<TScalar, N, N> &resultMat, WorkerTimes *times = nullptr, SolveControl *control = nullptr, std::size_t panelColumns = 1)
+{
+    WorkerTimer timer(times);
+    // Each block already runs on its own thread; keep the Matrix kernels it calls on this thread.
+    SequentialKernelsGuard sequentialKernels;
+    std::optional<DeterministicFloatingPointScope> floatingPointScope;
+    if (deterministic)
+    {
+        floatingPointScope.emplace();
+    }
+    // Only the blocks to the left publish columns this block needs; they tag them with their block index.
+    Client<CholeskyMessage<TScalar, N>> client = messageQueue.getClient([blockIndex](std::size_t tag)
+                                                                        { return tag < blockIndex; });
+    std::size_t firstIdx = NBlock * blockIndex;
+
+    std::vector<CholeskyMessage<TScalar, N>> panels{};
+    std::vector<const TScalar *> columns{};
+    std::size_t received = 0;
+    while (received != firstIdx)
+    {
+        panels.clear();
+        while (messageQueue.drain(client, panels) == 0)
+        {
+            if (control && control->cancelled())
+            {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+
+        columns.clear();
+        for (const CholeskyMessage<TScalar, N> &panel : panels)
+        {
+            for (const std::vector<TScalar> &column : panel->columns)
+            {
+                columns.push_back(column.data());
+            }
+        }
+        applyCholeskyColumns(mat, firstIdx, columns, received, firstIdx);
+        received += columns.size();
+    }
+    if (times)
+    {
+        times->messages = messageQueue.traffic(client).received;
+    }
+
+    std::shared_ptr<CholeskyPanel<TScalar, N>> panel{};
+    for (std::size_t i = 0; i != NBlock; ++i)
+    {
+        if (control && control->cancelled())
+        {
+            return;
+        }
+        const std::size_t diagIdx = i + firstIdx;
+        std::vector<TScalar> column(N);
+        for (std::size_t j = diagIdx; j != N; ++j)
+        {
+            column[j] = mat.rowData(j)[i];
+        }
+        applyCholeskyColumns(mat, firstIdx, std::vector<const TScalar *>{column.data()}, diagIdx, diagIdx + 1);
+        if (populateResultMat)
+        {
+            populateCholColumn(column, resultMat, diagIdx);
+        }
+        else
+        {
+            if (!panel)
+            {
+                panel = std::make_shared<CholeskyPanel<TScalar, N>>();
+                panel->first = diagIdx;
+            }
+            panel->columns.push_back(std::move(column));
+            if (panel->columns.size() == panelColumns || i + 1 == NBlock)
+            {
+                messageQueue.enqueue(std::move(panel), client, blockIndex);
+                panel = nullptr;
+            }
+        }
+        if (control)
+        {
+            control->advance();
+        }
+    }
+}
+
+/**
+ * @brief Factor A = L * L^T with N / NBlock block threads (cholBlockIter) and assemble L; no timing or output.
+ *
+ * @param times Resized to one entry per block thread and filled with their times.
+ * @param control If not null, receives N steps of progress (one per column) and can cancel the factorization.
+ * @param panelColumns The number of columns each block publishes per message (see cholBlockIter).
+ * @return Whether every column was published, i.e. the factorization was neither cancelled nor aborted.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+bool choleskyParallel(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, bool deterministic, std::vector<WorkerTimes> &times, SolveControl *control = nullptr, std::size_t panelColumns = 1)
+{
+    static_assert(N % NBlock == 0, "NBlock must divide N");
+    std::optional<DeterministicFloatingPointScope> floatingPointScope;
+    if (deterministic)
+    {
+        floatingPointScope.emplace();
+    }
+    if (control)
+    {
+        control->start(N);
+    }
+    MessageQueue<CholeskyMessage<TScalar, N>> messageQueue;
+    Client<CholeskyMessage<TScalar, N>> client = messageQueue.getClient();
+    const std::size_t p = N / NBlock;
+
+    times.assign(p, WorkerTimes());
+    std::vector<std::thread> threads{};
+    for (std::size_t i = 0; i != p; ++i)
+    {
+        std::size_t firstCol = i * NBlock;
+        Matrix<TScalar, N, NBlock> submatrix;
+        mat.columnsInto(firstCol, submatrix);
+        std::thread thread = std::thread(cholBlockIter<TScalar, N, NBlock>, i, submatrix, std::ref(messageQueue), false, deterministic, std::ref(result), &times[i], control, panelColumns);
+        threads.push_back(std::move(thread));
+    }
+
+    for (std::size_t i = 0; i != p; ++i)
+    {
+        threads[i].join();
+    }
+
+    std::vector<CholeskyMessage<TScalar, N>> panels{};
+    messageQueue.drain(client, panels);
+    std::size_t assembled = 0;
+    for (const CholeskyMessage<TScalar, N> &panel : panels)
+    {
+        for (const std::vector<TScalar> &column : panel->columns)
+        {
+            populateCholColumn(column, result, assembled);
+            ++assembled;
+        }
+    }
+    return assembled == N;
+}
+
+/**
+ * @brief Compute the block columns of one rank in the distributed Cholesky, A = L * L^T.
+ *
+ * The columns are dealt to ranks in a 1D block-cyclic layout: block b (columns b * NBlock to (b + 1) * NBlock - 1)
+ * belongs to rank b mod nRanks, so every rank keeps owning unfinished columns until the end. Columns are handled in
+ * order i = 0, ..., N - 1: the owner of column i publishes it (it has received every earlier column, so it is
+ * final), every other rank receives it, and all ranks apply its rank-1 update to their own later columns.
+ *
+ * The message is the same unscaled column as in cholBlockIter, and the updates go through the same kernel,
+ * applyCholeskyColumns: the columns received between two columns of this rank are applied as one rank-k update
+ * just before this rank publishes its next column, like the batches a block of cholBlockIter drains. Every entry
+ * receives the same updates in the same order with the same arithmetic, so the factor is bitwise identical to the
+ * sequential one for any number of ranks and any transport.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam N Matrix size
+ * @tparam NBlock Width of a block column. Must divide N.
+ * @param rank This rank, in [0, nRanks).
+ * @param nRanks The number of ranks.
+ * @param mat The symmetric positive definite matrix A (only the columns of this rank are read).
+ * @param transport This rank's transport endpoint, for messages of N scalars.
+ * @param populateResultMat Whether this rank assembles L from all columns (usually only rank 0).
+ * @param deterministic Whether to fix the floating-point environment of the thread (see cholBlockIter).
+ * @param resultMat The result matrix
+ * @param times Receives the wall time and the CPU time of this call.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+void cholRankIter(std::size_t rank, std::size_t nRanks, const Matrix<TScalar, N, N> &mat, Transport<TScalar> &transport, bool populateResultMat, bool deterministic, Matrix<TScalar, N, N> &resultMat, WorkerTimes &times)
+{
+    static_assert(N % NBlock == 0, "NBlock must divide N");
+    WorkerTimer timer(&times);
+    // Ranks may be threads of one process; keep the Matrix kernels on this thread.
+    SequentialKernelsGuard sequentialKernels;
+    std::optional<DeterministicFloatingPointScope> floatingPointScope;
+    if (deterministic)
+    {
+        floatingPointScope.emplace();
+    }
+    constexpr std::size_t nBlocks = N / NBlock;
+
+    std::vector<Matrix<TScalar, N, NBlock>> blocks{};
+    for (std::size_t b = rank; b < nBlocks; b += nRanks)
+    {
+        blocks.emplace_back();
+        mat.columnsInto(b * NBlock, blocks.back());
+    }
+
+    // Applies columns first, ..., first + k - 1 to every local block that is not finished yet. Rows above a block
+    // and above the last applied column are never read again.
+    std::vector<const TScalar *> columns{};
+    auto applyColumns = [&blocks, &columns, rank, nRanks](std::size_t first)
+    {
+        const std::size_t last = first + columns.size() - 1;
+        for (std::size_t localBlock = 0; localBlock != blocks.size(); ++localBlock)
+        {
+            const std::size_t firstIdx = (rank + localBlock * nRanks) * NBlock;
+            if (firstIdx + NBlock > last + 1)
+            {
+                applyCholeskyColumns(blocks[localBlock], firstIdx, columns, first, std::max(last + 1, firstIdx));
+            }
+        }
+    };
+
+    // Received columns wait here until this rank needs them: pending[0, nPending) are columns i - nPending, ..., i - 1.
+    std::vector<std::vector<TScalar>> pending{};
+    std::size_t nPending = 0;
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        const std::size_t blockIndex = i / NBlock;
+        const bool owned = (blockIndex % nRanks == rank);
+        if (owned && nPending != 0)
+        {
+            columns.clear();
+            for (std::size_t n = 0; n != nPending; ++n)
+            {
+                columns.push_back(pending[n].data());
+            }
+            applyColumns(i - nPending);
+            nPending = 0;
+        }
+        if (nPending == pending.size())
+        {
+            pending.emplace_back(N);
+        }
+        std::vector<TScalar> &column = pending[nPending];
+        if (owned)
+        {
+            const Matrix<TScalar, N, NBlock> &block = blocks[blockIndex / nRanks];
+            for (std::size_t r = 0; r != N; ++r)
+            {
+                column[r] = (r < i) ? 0 : block.get(r, i % NBlock);
+            }
+            transport.publish(column.data());
+        }
+        else
+        {
+            transport.receive(column.data());
+        }
+
+        if (populateResultMat)
+        {
+            populateCholColumn(column, resultMat, i);
+        }
+
+        if (owned)
+        {
+            columns.assign(1, column.data());
+            applyColumns(i);
+        }
+        else
+        {
+            ++nPending;
+        }
+    }
+}
+
+/**
+ * @brief Factor A = L * L^T with nThreads block-cyclic workers (cholRankIter) over in-process transports and
+ * assemble L; no timing or output.
+ *
+ * @param times Resized to one entry per worker and filled with their times.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+void choleskyBlockCyclic(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, std::size_t nThreads, bool deterministic, std::vector<WorkerTimes> &times)
+{
+    std::optional<DeterministicFloatingPointScope> floatingPointScope;
+    if (deterministic)
+    {
+        floatingPointScope.emplace();
+    }
+    MessageQueue<std::vector<TScalar>> messageQueue;
+    InProcessTransport<TScalar> collector(messageQueue, N);
+    std::vector<std::unique_ptr<InProcessTransport<TScalar>>> transports{};
+    for (std::size_t t = 0; t != nThreads; ++t)
+    {
+        transports.emplace_back(new InProcessTransport<TScalar>(messageQueue, N));
+    }
+
+    times.assign(nThreads, WorkerTimes());
+    std::vector<std::thread> threads{};
+    for (std::size_t t = 0; t != nThreads; ++t)
+    {
+        threads.push_back(std::thread(cholRankIter<TScalar, N, NBlock>, t, nThreads, std::cref(mat), std::ref(*transports[t]), false, deterministic, std::ref(result), std::ref(times[t])));
+    }
+    for (std::size_t t = 0; t != nThreads; ++t)
+    {
+        threads[t].join();
+    }
+
+    std::vector<TScalar> message(N);
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        collector.receive(message.data());
+        Matrix<TScalar, N, 1> column([&message](std::size_t row, std::size_t col)
+                                     { return message[row]; });
+        populateCholMat(column, result, i);
+    }
+}
+
+template <std::size_t N>
+void generateCholeskyInput(Matrix<float, N, N> &mat)
+{
+    mat = wishart<float, N, N>(11828, 10.0, 1.0);
+}
+
+#endif
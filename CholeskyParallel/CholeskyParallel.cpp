@@ -5,194 +5,183 @@
 #include <thread>
 #include <cmath>
 #include <vector>
-#include <random>
+#include <optional>
+#include <string>
+#include <memory>
+#include <algorithm>
 
 #include "../MessageQueue/MessageQueue.hpp"
 #include "../Matrix/Matrix.hpp"
-
-template <typename TScalar, std::size_t N>
-void populateCholMat(Matrix<TScalar, N, 1> &column /* mutated!! */, Matrix<TScalar, N, N> &result, std::size_t i)
-{
-    const TScalar diagElem = std::sqrt(std::abs(column.get(i, 0)));
-    column.set(i, 0, diagElem);
-    for (std::size_t j = i + 1; j != N; ++j)
-    {
-        TScalar val = column.get(j, 0) / diagElem;
-        column.set(j, 0, val);
-    }
-
-    result.overwriteSubmatrix(column, 0, i);
-}
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/FloatingPoint.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../Matrix/PerfCounters.hpp"
+#include "Cholesky.hpp"
+#include "RecursiveCholesky.hpp"
+#include "../Autotune/Autotune.hpp"
 
 /**
- * @brief Compute one block in the parallel Cholesky. The block shape is N by NBlock; NBlock must divide N.
- * 
- * The decomposition is
- * 
- * A = L * L^T
- * 
- * The results are enqueued successively, from left to right, and each message allows a column of L to be
- * constructed. Thus the calling thread is responsible for constructing L; this reconstruction is a lower-order
- * cost and thus does not need its own parallelism.
- * 
- * @tparam TScalar The scalar type (should usually be float or double -- int will not work)
- * @tparam N Matrix size
- * @tparam NBlock Number of columns in this block. Must divide N.
- * @param blockIndex The zero-based index of this block (left to right).
- * @param mat Should be initialized with the corresponding block of the (symmetric positive definite) matrix A.
- * @param messageQueue The queue for communication across threads.
- * @param populateResultMat Whether to skip messaging and simply populate the result matrix for this block (for sequential solve).
- * @param resultMat The result matrix
+ * @brief Print the busy (CPU) time of every worker and the imbalance max / mean.
  */
-template <typename TScalar, std::size_t N, std::size_t NBlock>
-void cholBlockIter(std::size_t blockIndex, Matrix<TScalar, N, NBlock> mat, MessageQueue<Matrix<TScalar, N, 1>> &messageQueue, bool populateResultMat, Matrix<TScalar, N, N> &resultMat)
+void printWorkerTimes(const std::vector<WorkerTimes> &times)
 {
-    Client<Matrix<TScalar, N, 1>> client = messageQueue.getClient();
-    std::size_t firstIdx = NBlock * blockIndex;
-
-    for (std::size_t i = 0; i != blockIndex * NBlock; ++i)
+    double maxBusy = 0;
+    double sumBusy = 0;
+    std::cout << "Per-thread busy milliseconds:";
+    for (const WorkerTimes &workerTimes : times)
     {
-        while (!messageQueue.hasNext(client))
-        {
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-        }
-
-        Matrix<TScalar, N, 1> column = messageQueue.next(client);
-        const TScalar diagElem = column.get(i, 0);
-        column.set(i, 0, 0);
-        Matrix<TScalar, N, NBlock> outerProduct;
-        Matrix<TScalar, NBlock, 1> subcolumn;
-        column.rowsInto(firstIdx, subcolumn);
-        subcolumn.transpose().multiplyLeft(column, outerProduct);
-        mat.add(outerProduct, -1.0 / diagElem);
-        Matrix<TScalar, 1, NBlock> zeroRow;
-        mat.overwriteSubmatrix(zeroRow, i, 0);
+        const double busy = workerTimes.busy.count();
+        std::cout << " " << (int)(1000 * busy);
+        maxBusy = std::max(maxBusy, busy);
+        sumBusy += busy;
     }
-
-    for (std::size_t i = 0; i != NBlock; ++i)
+    std::cout << std::endl;
+    std::cout << "Load imbalance (max / mean busy time): " << maxBusy * times.size() / sumBusy << std::endl;
+    if (!times.empty() && times[0].counters.has(PerfEvent::Cycles) && times[0].counters.has(PerfEvent::Instructions))
     {
-        Matrix<TScalar, N, 1> column = mat.column(i);
-        for (std::size_t j = 0; j != i + firstIdx; ++j)
+        std::cout << "Per-thread IPC:";
+        for (const WorkerTimes &workerTimes : times)
         {
-            column.set(j, 0, 0);
+            std::cout << " " << workerTimes.counters.ipc();
         }
-        if (!populateResultMat)
-        {
-            messageQueue.enqueue(column, client);
-        }
-        const TScalar diagElem = column.get(i + firstIdx, 0);
-        column.set(i + firstIdx, 0, 0);
-        Matrix<TScalar, N, NBlock> outerProduct;
-        Matrix<TScalar, NBlock, 1> subcolumn;
-        column.rowsInto(firstIdx, subcolumn);
-        subcolumn.transpose().multiplyLeft(column, outerProduct);
-        mat.add(outerProduct, -1.0 / diagElem);
-        Matrix<TScalar, 1, NBlock> zeroRow;
-        Matrix<TScalar, N, 1> zeroCol;
-        mat.overwriteSubmatrix(zeroRow, i + firstIdx, 0);
-        mat.overwriteSubmatrix(zeroCol, 0, i);
-        mat.set(i + firstIdx, i, 1);
-        if (populateResultMat)
+        std::cout << std::endl;
+    }
+    if (!times.empty() && times[0].counters.has(PerfEvent::LlcMisses))
+    {
+        std::cout << "Per-thread LLC misses:";
+        for (const WorkerTimes &workerTimes : times)
         {
-            column.set(i + firstIdx, 0, diagElem);
-            populateCholMat(column, resultMat, i + firstIdx);
+            std::cout << " " << workerTimes.counters.get(PerfEvent::LlcMisses);
         }
+        std::cout << std::endl;
     }
 }
 
+/**
+ * @brief Print how many messages every worker received out of the number published in total.
+ */
+void printWorkerMessages(const std::vector<WorkerTimes> &times, std::size_t published)
+{
+    std::cout << "Per-thread messages received (of " << published << " published):";
+    for (const WorkerTimes &workerTimes : times)
+    {
+        std::cout << " " << workerTimes.messages;
+    }
+    std::cout << std::endl;
+}
+
 template <typename TScalar, std::size_t N>
-void computeCholeskySequential(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result)
+void computeCholeskySequential(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, VerificationMode verification, bool deterministic = false)
 {
     auto timerStart = std::chrono::steady_clock::now();
-    MessageQueue<Matrix<TScalar, N, 1>> messageQueue;
-    cholBlockIter<TScalar, N, N>(0, mat, messageQueue, true, result);
+    PerfCounters counters(perfCountersRequested(), true);
+    MessageQueue<CholeskyMessage<TScalar, N>> messageQueue;
+    cholBlockIter<TScalar, N, N>(0, mat, messageQueue, true, deterministic, result);
+    const PerfCounts counts = counters.read();
     auto timerStop = std::chrono::steady_clock::now();
     std::chrono::duration<double> milliseconds = timerStop - timerStart;
     int count = 1000 * milliseconds.count();
 
-    Matrix<TScalar, N, N> computed;
-    result.multiplyRight(result.transpose(), computed);
-    computed.add(mat, -1.0);
-    TScalar frobResidual = computed.frobNorm();
-    TScalar frobMat = mat.frobNorm();
-    TScalar frobFractional = 100.0 * frobResidual / frobMat;
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = choleskyResidual(mat, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
 
-    std::cout << "Sequential Cholesky, N = " << N << std::endl;
+    std::cout << "Sequential Cholesky, N = " << N << (deterministic ? " (deterministic)" : "") << std::endl;
     std::cout << "Milliseconds: " << count << std::endl;
-    std::cout << "Percent residual (Frobenius): " << frobFractional << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / milliseconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, (double)N * N * N / 3.0);
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
     std::cout << "---------------------------" << std::endl;
     std::cout << std::endl;
 }
 
 template <typename TScalar, std::size_t N, std::size_t NBlock>
-void computeCholeskyParallel(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result)
+void computeCholeskyParallel(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, VerificationMode verification, bool deterministic = false, std::size_t panelColumns = 1)
 {
-    MessageQueue<Matrix<TScalar, N, 1>> messageQueue;
-    Client<Matrix<TScalar, N, 1>> client = messageQueue.getClient();
     const std::size_t p = N / NBlock;
 
     auto timerStart = std::chrono::steady_clock::now();
+    PerfCounters counters(perfCountersRequested(), true);
 
-    std::vector<std::thread> threads{};
-    for (std::size_t i = 0; i != p; ++i)
+    std::vector<WorkerTimes> times{};
+    if (!choleskyParallel<TScalar, N, NBlock>(mat, result, deterministic, times, nullptr, panelColumns))
     {
-        std::size_t firstCol = i * NBlock;
-        Matrix<TScalar, N, NBlock> submatrix;
-        mat.columnsInto(firstCol, submatrix);
-        std::thread thread = std::thread(cholBlockIter<TScalar, N, NBlock>, i, submatrix, std::ref(messageQueue), false, std::ref(result));
-        threads.push_back(std::move(thread));
+        std::cout << "FATAL ERROR: parallel chol alg aborted unexpectedly" << std::endl;
+        return;
     }
 
-    for (std::size_t i = 0; i != p; ++i)
-    {
-        threads[i].join();
-    }
+    const PerfCounts counts = counters.read();
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> milliseconds = timerStop - timerStart;
+    int count = 1000 * milliseconds.count();
 
-    for (std::size_t i = 0; i != N; ++i)
-    {
-        if (!messageQueue.hasNext(client))
-        {
-            std::cout << "FATAL ERROR: parallel chol alg aborted unexpectedly" << std::endl;
-            return;
-        }
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = choleskyResidual(mat, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
 
-        Matrix<TScalar, N, 1> column = messageQueue.next(client);
-        populateCholMat(column, result, i);
-    }
+    std::cout << "Parallel Cholesky, N = " << N << ", p = " << p << ", panel width " << panelColumns << (deterministic ? " (deterministic)" : "") << std::endl;
+    std::cout << "Milliseconds: " << count << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / milliseconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, (double)N * N * N / 3.0);
+    printWorkerTimes(times);
+    printWorkerMessages(times, p * ((NBlock + panelColumns - 1) / panelColumns));
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
 
+/**
+ * @brief Parallel Cholesky with a block-cyclic column layout: nThreads workers, where worker t owns the blocks of
+ * NBlock columns with index t, t + nThreads, t + 2 * nThreads, ... (see cholRankIter).
+ *
+ * With contiguous blocks the worker owning the last block absorbs almost N incoming columns while the first absorbs
+ * none; with narrow cyclic blocks every worker owns columns all along the matrix and does about the same work. The
+ * factor is bitwise identical to the sequential one.
+ *
+ * @tparam NBlock The block width; smaller blocks balance better but publish columns in a more serialized order.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock>
+void computeCholeskyBlockCyclic(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, std::size_t nThreads, VerificationMode verification, bool deterministic = false)
+{
+    auto timerStart = std::chrono::steady_clock::now();
+    PerfCounters counters(perfCountersRequested(), true);
+
+    std::vector<WorkerTimes> times{};
+    choleskyBlockCyclic<TScalar, N, NBlock>(mat, result, nThreads, deterministic, times);
+
+    const PerfCounts counts = counters.read();
     auto timerStop = std::chrono::steady_clock::now();
     std::chrono::duration<double> milliseconds = timerStop - timerStart;
     int count = 1000 * milliseconds.count();
 
-    Matrix<TScalar, N, N> computed;
-    result.multiplyRight(result.transpose(), computed);
-    computed.add(mat, -1.0);
-    TScalar frobResidual = computed.frobNorm();
-    TScalar frobMat = mat.frobNorm();
-    TScalar frobFractional = 100.0 * frobResidual / frobMat;
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = choleskyResidual(mat, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
 
-    std::cout << "Parallel Cholesky, N = " << N << ", p = " << p << std::endl;
+    std::cout << "Block-cyclic parallel Cholesky, N = " << N << ", p = " << nThreads << ", block width " << NBlock << (deterministic ? " (deterministic)" : "") << std::endl;
     std::cout << "Milliseconds: " << count << std::endl;
-    std::cout << "Percent residual (Frobenius): " << frobFractional << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / milliseconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, (double)N * N * N / 3.0);
+    printWorkerTimes(times);
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
     std::cout << "---------------------------" << std::endl;
     std::cout << std::endl;
 }
 
 template <std::size_t N, std::size_t NBlock>
-void calculateCholesky(bool useParallel)
-{
-    std::mt19937 rng;
-    rng.seed(11828);
-    std::normal_distribution<float> normal_dist(0.0, 10.0);
-    Matrix<float, N, N> id([](std::size_t rowIdx, std::size_t colIdx)
-                           { return rowIdx == colIdx ? 1 : 0; });
-    Matrix<float, N, N> mat0([rng, normal_dist](std::size_t rowIdx, std::size_t colIdx) mutable
-                             { return (float)(normal_dist(rng)); });
-    Matrix<float, N, N> transpose = mat0.transpose();
+void calculateCholesky(bool useParallel, VerificationMode verification)
+{
     Matrix<float, N, N> mat;
-    mat0.transpose().multiplyRight(mat0, mat);
-    mat.multiplyScalar(1.0 / N);
-    mat.add(id, 1.0);
+    generateCholeskyInput(mat);
     std::cout << std::endl;
     std::cout << "---------------------------" << std::endl;
     std::cout << "Matrix entry-wise sample standard deviation: " << mat.sample_dev() << std::endl;
@@ -200,20 +189,221 @@ void calculateCholesky(bool useParallel)
     Matrix<float, N, N> result;
     if (useParallel)
     {
-        computeCholeskyParallel<float, N, NBlock>(mat, result);
+        computeCholeskyParallel<float, N, NBlock>(mat, result, verification);
     }
     else
     {
-        computeCholeskySequential<float, N>(mat, result);
+        computeCholeskySequential<float, N>(mat, result, verification);
+    }
+    std::cout << std::endl;
+}
+
+template <std::size_t N, std::size_t NBlock>
+void compareParallelWithSequential(const Matrix<float, N, N> &mat, const Matrix<float, N, N> &sequentialResult, bool deterministic)
+{
+    Matrix<float, N, N> result;
+    computeCholeskyParallel<float, N, NBlock>(mat, result, VerificationMode::None, deterministic);
+    std::cout << "Bitwise identical to sequential: " << (result.bitwiseEquals(sequentialResult) ? "yes" : "no") << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Time the free-running and the deterministic modes for several p, and check each parallel factor bit for bit against the sequential factor of the same mode.
+ */
+template <std::size_t N>
+void benchmarkDeterministic()
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+
+    for (bool deterministic : {false, true})
+    {
+        Matrix<float, N, N> sequentialResult;
+        computeCholeskySequential<float, N>(mat, sequentialResult, VerificationMode::None, deterministic);
+        compareParallelWithSequential<N, N / 2>(mat, sequentialResult, deterministic);
+        compareParallelWithSequential<N, N / 4>(mat, sequentialResult, deterministic);
+        compareParallelWithSequential<N, N / 8>(mat, sequentialResult, deterministic);
     }
+}
+
+template <std::size_t N, std::size_t NBlockContiguous, std::size_t NBlockCyclic>
+void compareLayouts(const Matrix<float, N, N> &mat, const Matrix<float, N, N> &sequentialResult)
+{
+    Matrix<float, N, N> contiguousResult;
+    computeCholeskyParallel<float, N, NBlockContiguous>(mat, contiguousResult, VerificationMode::None);
+    Matrix<float, N, N> cyclicResult;
+    computeCholeskyBlockCyclic<float, N, NBlockCyclic>(mat, cyclicResult, N / NBlockContiguous, VerificationMode::None);
+    std::cout << "Bitwise identical to sequential: contiguous " << (contiguousResult.bitwiseEquals(sequentialResult) ? "yes" : "no")
+              << ", block-cyclic " << (cyclicResult.bitwiseEquals(sequentialResult) ? "yes" : "no") << std::endl;
     std::cout << std::endl;
 }
 
-int main()
+/**
+ * @brief Compare the per-thread busy time of the contiguous and the block-cyclic (width 32) layouts for p = 2, 4, 8.
+ */
+template <std::size_t N>
+void benchmarkLoadBalance()
 {
-    constexpr std::size_t N = 1024;
-    calculateCholesky<N, N>(false);
-    calculateCholesky<N, N / 2>(true);
-    calculateCholesky<N, N / 4>(true);
-    calculateCholesky<N, N / 8>(true);
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    Matrix<float, N, N> sequentialResult;
+    computeCholeskySequential<float, N>(mat, sequentialResult, VerificationMode::None);
+    compareLayouts<N, N / 2, 32>(mat, sequentialResult);
+    compareLayouts<N, N / 4, 32>(mat, sequentialResult);
+    compareLayouts<N, N / 8, 32>(mat, sequentialResult);
+}
+
+template <std::size_t N, std::size_t NBlock>
+void comparePanelWidths(const Matrix<float, N, N> &mat, const Matrix<float, N, N> &sequentialResult)
+{
+    for (std::size_t panelColumns : {(std::size_t)1, (std::size_t)16, NBlock})
+    {
+        Matrix<float, N, N> result;
+        computeCholeskyParallel<float, N, NBlock>(mat, result, VerificationMode::None, false, panelColumns);
+        std::cout << "Bitwise identical to sequential: " << (result.bitwiseEquals(sequentialResult) ? "yes" : "no") << std::endl;
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * @brief Time the contiguous parallel Cholesky for p = 2, 4, 8 with blocks publishing one column, 16 columns or
+ * their whole block per message, and check every factor bit for bit against the sequential one.
+ */
+template <std::size_t N>
+void benchmarkPanels()
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    Matrix<float, N, N> sequentialResult;
+    computeCholeskySequential<float, N>(mat, sequentialResult, VerificationMode::None);
+    comparePanelWidths<N, N / 2>(mat, sequentialResult);
+    comparePanelWidths<N, N / 4>(mat, sequentialResult);
+    comparePanelWidths<N, N / 8>(mat, sequentialResult);
+}
+
+template <typename TScalar, std::size_t N>
+void computeCholeskyRecursive(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, std::size_t taskDepth, VerificationMode verification)
+{
+    auto timerStart = std::chrono::steady_clock::now();
+    PerfCounters counters(perfCountersRequested(), true);
+    const bool factored = recursiveCholesky(mat, result, taskDepth);
+    const PerfCounts counts = counters.read();
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> milliseconds = timerStop - timerStart;
+    int count = 1000 * milliseconds.count();
+    if (!factored)
+    {
+        std::cout << "FATAL ERROR: matrix is not positive definite" << std::endl;
+        return;
+    }
+
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = choleskyResidual(mat, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
+
+    std::cout << "Recursive Cholesky, N = " << N << ", task depth " << taskDepth << std::endl;
+    std::cout << "Milliseconds: " << count << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / milliseconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, (double)N * N * N / 3.0);
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Compare the recursive Cholesky (sequential and with tasks) with the sequential and block-cyclic block
+ * factorizations, whose block width has to be chosen.
+ */
+template <std::size_t N>
+void benchmarkRecursive()
+{
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+    Matrix<float, N, N> result;
+    computeCholeskySequential<float, N>(mat, result, verification);
+    computeCholeskyBlockCyclic<float, N, 32>(mat, result, std::max(1u, std::thread::hardware_concurrency()), verification);
+    Matrix<float, N, N> sequentialRecursive;
+    computeCholeskyRecursive<float, N>(mat, sequentialRecursive, 0, verification);
+    Matrix<float, N, N> parallelRecursive;
+    computeCholeskyRecursive<float, N>(mat, parallelRecursive, defaultRecursiveTaskDepth, verification);
+    std::cout << "Recursive factor independent of task depth: " << (parallelRecursive.bitwiseEquals(sequentialRecursive) ? "yes" : "no") << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Factor with the configuration this machine's tuning profile holds for N (see Autotune), or, if N was not
+ * tuned, time the sequential and the contiguous parallel factorization with p = 2, 4 and 8 as before.
+ */
+template <std::size_t N>
+void calculateTunedCholesky(VerificationMode verification)
+{
+    TunedParameters parameters;
+    if (!findTunedCholeskyParameters<N>(parameters))
+    {
+        std::cout << "No tuned Cholesky configuration for N = " << N << " in " << hostProfilePath() << ", running the defaults" << std::endl;
+        calculateCholesky<N, N>(false, verification);
+        calculateCholesky<N, N / 2>(true, verification);
+        calculateCholesky<N, N / 4>(true, verification);
+        calculateCholesky<N, N / 8>(true, verification);
+        return;
+    }
+
+    Matrix<float, N, N> mat;
+    generateCholeskyInput(mat);
+    std::cout << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << "Matrix entry-wise sample standard deviation: " << mat.sample_dev() << std::endl;
+    std::cout << "---------------------------" << std::endl;
+
+    Matrix<float, N, N> result;
+    auto timerStart = std::chrono::steady_clock::now();
+    if (!tunedCholesky(mat, result))
+    {
+        std::cout << "FATAL ERROR: tuned chol alg aborted unexpectedly" << std::endl;
+        return;
+    }
+    std::chrono::duration<double> milliseconds = std::chrono::steady_clock::now() - timerStart;
+
+    std::cout << "Tuned Cholesky, N = " << N << " (";
+    printParameters(parameters);
+    std::cout << ", from " << hostProfilePath() << ")" << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * milliseconds.count()) << std::endl;
+    std::cout << "GFLOP/s: " << (double)N * N * N / 3.0 / milliseconds.count() / 1e9 << std::endl;
+    printResidual(choleskyResidual(mat, result, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mode = (argc > 1) ? argv[1] : "solve";
+    if (mode == "deterministic")
+    {
+        benchmarkDeterministic<512>();
+        return 0;
+    }
+    if (mode == "loadbalance")
+    {
+        benchmarkLoadBalance<1024>();
+        return 0;
+    }
+    if (mode == "panels")
+    {
+        benchmarkPanels<1024>();
+        benchmarkPanels<2048>();
+        return 0;
+    }
+    if (mode == "recursive")
+    {
+        benchmarkRecursive<1024>();
+        benchmarkRecursive<2048>();
+        return 0;
+    }
+
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+    calculateTunedCholesky<1024>(verification);
 }
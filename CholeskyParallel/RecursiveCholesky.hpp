@@ -0,0 +1,285 @@
+#ifndef RECURSIVECHOLESKYHPP
+#define RECURSIVECHOLESKYHPP
+
+#include <cmath>
+#include <future>
+#include <vector>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+
+/**
+ * @brief Blocks with at most this many rows and columns go to the base kernels. Small enough that a base block
+ * stays in L1 on any current core; it is not a per-machine tuning knob like NBlock.
+ */
+constexpr std::size_t recursiveBaseSize = 32;
+
+/**
+ * @brief Inner (k) dimensions longer than this are split in two, so that base kernels work on rows of at most this
+ * length.
+ */
+constexpr std::size_t recursiveBaseDepth = 256;
+
+/**
+ * @brief Default number of recursion levels whose independent halves run as parallel tasks.
+ */
+constexpr std::size_t defaultRecursiveTaskDepth = 3;
+
+/**
+ * @brief Run first and second, as two parallel tasks if taskDepth allows, and wait for both. Each receives the task
+ * depth left for its own recursion, so both halves keep forking down to taskDepth levels and a depth of d runs up to
+ * 2^d tasks at once.
+ *
+ * Only taskDepth decides whether to fork: the spawned task installs a SequentialKernelsGuard to keep the Matrix
+ * kernels it may call on its own thread, which must not stop its own recursion from forking. Whether to use tasks
+ * at all is decided once, by the taskDepth recursiveCholesky starts with.
+ */
+template <typename TFirst, typename TSecond>
+void forkJoin(std::size_t taskDepth, TFirst first, TSecond second)
+{
+    if (taskDepth == 0)
+    {
+        first(std::size_t(0));
+        second(std::size_t(0));
+        return;
+    }
+    std::future<void> task = std::async(std::launch::async, [&first, taskDepth]()
+                                        {
+                                            SequentialKernelsGuard guard;
+                                            first(taskDepth - 1);
+                                        });
+    second(taskDepth - 1);
+    task.get();
+}
+
+/**
+ * @brief C -= A * B^T on blocks of one matrix: C is m by n at (cRow, cCol), A is m by k at (aRow, aCol) and B is
+ * n by k at (bRow, bCol); C must not overlap A or B.
+ *
+ * Recursively halves the largest of m, n (independent halves, run as tasks) until C fits the base size, then k
+ * (in order) until it fits the base depth. The split points only depend on the shapes, and every entry of C
+ * accumulates its k terms in increasing order, so the result does not depend on the number of tasks.
+ */
+template <typename TScalar, std::size_t N>
+void recursiveGemmNT(Matrix<TScalar, N, N> &mat, std::size_t cRow, std::size_t cCol, std::size_t m, std::size_t n, std::size_t aRow, std::size_t aCol, std::size_t bRow, std::size_t bCol, std::size_t k, std::size_t taskDepth)
+{
+    if (m > recursiveBaseSize && m >= n)
+    {
+        const std::size_t m1 = m / 2;
+        forkJoin(taskDepth, [&mat, cRow, cCol, m1, n, aRow, aCol, bRow, bCol, k](std::size_t depth)
+                 { recursiveGemmNT(mat, cRow, cCol, m1, n, aRow, aCol, bRow, bCol, k, depth); },
+                 [&mat, cRow, cCol, m, m1, n, aRow, aCol, bRow, bCol, k](std::size_t depth)
+                 { recursiveGemmNT(mat, cRow + m1, cCol, m - m1, n, aRow + m1, aCol, bRow, bCol, k, depth); });
+        return;
+    }
+    if (n > recursiveBaseSize)
+    {
+        const std::size_t n1 = n / 2;
+        forkJoin(taskDepth, [&mat, cRow, cCol, m, n1, aRow, aCol, bRow, bCol, k](std::size_t depth)
+                 { recursiveGemmNT(mat, cRow, cCol, m, n1, aRow, aCol, bRow, bCol, k, depth); },
+                 [&mat, cRow, cCol, m, n, n1, aRow, aCol, bRow, bCol, k](std::size_t depth)
+                 { recursiveGemmNT(mat, cRow, cCol + n1, m, n - n1, aRow, aCol, bRow + n1, bCol, k, depth); });
+        return;
+    }
+    if (k > recursiveBaseDepth)
+    {
+        const std::size_t k1 = k / 2;
+        recursiveGemmNT(mat, cRow, cCol, m, n, aRow, aCol, bRow, bCol, k1, 0);
+        recursiveGemmNT(mat, cRow, cCol, m, n, aRow, aCol + k1, bRow, bCol + k1, k - k1, 0);
+        return;
+    }
+
+    // Base kernel: pack B^T (k by n, contiguous) so that four rows of C are updated per row of B^T, as in
+    // gemmAccumulate. Every entry of C still accumulates its k terms in increasing order.
+    thread_local std::vector<TScalar> packed;
+    packed.resize(k * n);
+    for (std::size_t j = 0; j != n; ++j)
+    {
+        const TScalar *b = mat.rowData(bRow + j) + bCol;
+        for (std::size_t p = 0; p != k; ++p)
+        {
+            packed[p * n + j] = b[p];
+        }
+    }
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4)
+    {
+        const TScalar *a0 = mat.rowData(aRow + i) + aCol;
+        const TScalar *a1 = mat.rowData(aRow + i + 1) + aCol;
+        const TScalar *a2 = mat.rowData(aRow + i + 2) + aCol;
+        const TScalar *a3 = mat.rowData(aRow + i + 3) + aCol;
+        TScalar *c0 = mat.rowData(cRow + i) + cCol;
+        TScalar *c1 = mat.rowData(cRow + i + 1) + cCol;
+        TScalar *c2 = mat.rowData(cRow + i + 2) + cCol;
+        TScalar *c3 = mat.rowData(cRow + i + 3) + cCol;
+        for (std::size_t p = 0; p != k; ++p)
+        {
+            const TScalar a0p = a0[p];
+            const TScalar a1p = a1[p];
+            const TScalar a2p = a2[p];
+            const TScalar a3p = a3[p];
+            const TScalar *bRowT = packed.data() + p * n;
+            for (std::size_t j = 0; j != n; ++j)
+            {
+                c0[j] -= a0p * bRowT[j];
+                c1[j] -= a1p * bRowT[j];
+                c2[j] -= a2p * bRowT[j];
+                c3[j] -= a3p * bRowT[j];
+            }
+        }
+    }
+    for (; i != m; ++i)
+    {
+        const TScalar *a = mat.rowData(aRow + i) + aCol;
+        TScalar *c = mat.rowData(cRow + i) + cCol;
+        for (std::size_t p = 0; p != k; ++p)
+        {
+            const TScalar ap = a[p];
+            const TScalar *bRowT = packed.data() + p * n;
+            for (std::size_t j = 0; j != n; ++j)
+            {
+                c[j] -= ap * bRowT[j];
+            }
+        }
+    }
+}
+
+/**
+ * @brief C -= A * A^T on the lower triangle of the n by n diagonal block C at (first, first), where A is n by k at
+ * (first, aCol).
+ *
+ * Recursively: C11 -= A1 A1^T, C21 -= A2 A1^T and C22 -= A2 A2^T are independent and run as tasks. The upper
+ * triangle of C may be overwritten.
+ */
+template <typename TScalar, std::size_t N>
+void recursiveSyrk(Matrix<TScalar, N, N> &mat, std::size_t first, std::size_t n, std::size_t aCol, std::size_t k, std::size_t taskDepth)
+{
+    if (n > recursiveBaseSize)
+    {
+        const std::size_t n1 = n / 2;
+        forkJoin(taskDepth, [&mat, first, n, n1, aCol, k](std::size_t depth)
+                 {
+                     forkJoin(depth, [&mat, first, n1, aCol, k](std::size_t innerDepth)
+                              { recursiveSyrk(mat, first, n1, aCol, k, innerDepth); },
+                              [&mat, first, n, n1, aCol, k](std::size_t innerDepth)
+                              { recursiveSyrk(mat, first + n1, n - n1, aCol, k, innerDepth); });
+                 },
+                 [&mat, first, n, n1, aCol, k](std::size_t depth)
+                 { recursiveGemmNT(mat, first + n1, first, n - n1, n1, first + n1, aCol, first, aCol, k, depth); });
+        return;
+    }
+    // Base case: the whole diagonal block, through the GEMM kernel. The entries above the diagonal are only
+    // scratch; nothing reads them and recursiveCholesky clears them at the end.
+    recursiveGemmNT(mat, first, first, n, n, first, aCol, first, aCol, k, 0);
+}
+
+/**
+ * @brief X = B * L^-T in place, where B is the m by n block at (bRow, col) and L the lower-triangular n by n block
+ * at (col, col).
+ *
+ * Recursively halves the rows (independent, run as tasks) or the columns: X1 = B1 L11^-T, B2 -= X1 L21^T,
+ * X2 = B2 L22^-T.
+ */
+template <typename TScalar, std::size_t N>
+void recursiveTrsm(Matrix<TScalar, N, N> &mat, std::size_t bRow, std::size_t m, std::size_t col, std::size_t n, std::size_t taskDepth)
+{
+    if (m > recursiveBaseSize && m >= n)
+    {
+        const std::size_t m1 = m / 2;
+        forkJoin(taskDepth, [&mat, bRow, m1, col, n](std::size_t depth)
+                 { recursiveTrsm(mat, bRow, m1, col, n, depth); },
+                 [&mat, bRow, m, m1, col, n](std::size_t depth)
+                 { recursiveTrsm(mat, bRow + m1, m - m1, col, n, depth); });
+        return;
+    }
+    if (n > recursiveBaseSize)
+    {
+        const std::size_t n1 = n / 2;
+        recursiveTrsm(mat, bRow, m, col, n1, taskDepth);
+        recursiveGemmNT(mat, bRow, col + n1, m, n - n1, bRow, col, col + n1, col, n1, taskDepth);
+        recursiveTrsm(mat, bRow, m, col + n1, n - n1, taskDepth);
+        return;
+    }
+    for (std::size_t i = 0; i != m; ++i)
+    {
+        TScalar *x = mat.rowData(bRow + i) + col;
+        for (std::size_t j = 0; j != n; ++j)
+        {
+            const TScalar *lRow = mat.rowData(col + j) + col;
+            x[j] = (x[j] - dotProduct(x, lRow, j)) / lRow[j];
+        }
+    }
+}
+
+/**
+ * @brief Factor the n by n diagonal block at (first, first) in place (lower triangle only).
+ *
+ * Recursively: A11 = L11 L11^T, L21 = A21 L11^-T (recursiveTrsm), A22 -= L21 L21^T (recursiveSyrk), then A22. The
+ * base kernel is a left-looking dot-product Cholesky of at most recursiveBaseSize columns.
+ *
+ * @return false if a pivot is not positive.
+ */
+template <typename TScalar, std::size_t N>
+bool recursiveCholeskyBlock(Matrix<TScalar, N, N> &mat, std::size_t first, std::size_t n, std::size_t taskDepth)
+{
+    if (n > recursiveBaseSize)
+    {
+        const std::size_t n1 = n / 2;
+        if (!recursiveCholeskyBlock(mat, first, n1, taskDepth))
+        {
+            return false;
+        }
+        recursiveTrsm(mat, first + n1, n - n1, first, n1, taskDepth);
+        recursiveSyrk(mat, first + n1, n - n1, first, n1, taskDepth);
+        return recursiveCholeskyBlock(mat, first + n1, n - n1, taskDepth);
+    }
+    for (std::size_t j = 0; j != n; ++j)
+    {
+        const TScalar *rowJ = mat.rowData(first + j) + first;
+        for (std::size_t i = j; i != n; ++i)
+        {
+            TScalar *rowI = mat.rowData(first + i) + first;
+            rowI[j] -= dotProduct(rowI, rowJ, j);
+        }
+        const TScalar pivot = rowJ[j];
+        if (!(pivot > 0))
+        {
+            return false;
+        }
+        const TScalar diagonal = std::sqrt(pivot);
+        mat.rowData(first + j)[first + j] = diagonal;
+        for (std::size_t i = j + 1; i != n; ++i)
+        {
+            mat.rowData(first + i)[first + j] /= diagonal;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Recursive (cache-oblivious) Cholesky factorization A = L * L^T.
+ *
+ * Halving the matrix at every level gives blocks of every size from N down to recursiveBaseSize, so each level of
+ * the memory hierarchy finds blocks that fit it and no block width has to be tuned per machine. The independent
+ * halves of the TRSM, SYRK and GEMM recursions run as parallel tasks down to taskDepth levels. Every entry sees the
+ * same operations for any taskDepth, so the factor does not depend on the number of tasks.
+ *
+ * @param mat The symmetric positive definite matrix A (only the lower triangle is read).
+ * @param result Receives L, with zeros above the diagonal.
+ * @param taskDepth Levels of recursion that spawn tasks. Called on a thread that holds a SequentialKernelsGuard (a
+ * worker of another parallel solver), the factorization stays on that thread.
+ * @return false if A is not positive definite; result is then incomplete.
+ */
+template <typename TScalar, std::size_t N>
+bool recursiveCholesky(const Matrix<TScalar, N, N> &mat, Matrix<TScalar, N, N> &result, std::size_t taskDepth = defaultRecursiveTaskDepth)
+{
+    result = mat;
+    const bool factored = recursiveCholeskyBlock(result, 0, N, sequentialKernelsOnly() ? 0 : taskDepth);
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        std::fill(result.rowData(i) + i + 1, result.rowData(i) + N, (TScalar)0);
+    }
+    return factored;
+}
+
+#endif
@@ -1,5 +1,5 @@
 #!/bin/bash
 
-g++ -Wall -std=c++17 -pthread -o cholesky ./CholeskyParallel.cpp
-./cholesky
+g++ -Wall -std=c++17 -O3 -march=native -pthread -o cholesky ./CholeskyParallel.cpp
+./cholesky "$@"
 rm ./cholesky
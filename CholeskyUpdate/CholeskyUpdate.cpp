@@ -0,0 +1,140 @@
+#define _USE_MATH_DEFINES
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <string>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../CholeskyParallel/RecursiveCholesky.hpp"
+#include "CholeskyUpdate.hpp"
+
+template <typename TScalar, std::size_t N>
+void printFactorReport(const std::string &title, std::chrono::duration<double> milliseconds, const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, N> &factor, VerificationMode verification)
+{
+    std::cout << title << std::endl;
+    std::cout << "Milliseconds: " << (int)(1000 * milliseconds.count()) << std::endl;
+    printResidual(choleskyResidual(mat, factor, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+}
+
+/**
+ * @brief Update the factor of A to A + X X^T and downdate it back, compare with refactoring, and check the blocked
+ * rank-K update bit for bit against K rank-1 updates.
+ */
+template <std::size_t N, std::size_t K>
+void benchmarkRankUpdate(VerificationMode verification)
+{
+    const Matrix<float, N, N> mat = wishart<float, N, N>(11828, 10.0, 1.0);
+    Matrix<float, N, N> factor;
+    recursiveCholesky(mat, factor);
+    const Matrix<float, N, K> vectors = randomNormal<float, N, K>(11828, NormalStream, 1.0);
+    Matrix<float, N, N> updatedMat = mat;
+    vectors.multiplyRight(vectors.transpose(), updatedMat);
+
+    auto refactorStart = std::chrono::steady_clock::now();
+    Matrix<float, N, N> refactored;
+    recursiveCholesky(updatedMat, refactored);
+    std::chrono::duration<double> refactorTime = std::chrono::steady_clock::now() - refactorStart;
+
+    Matrix<float, N, N> updated = factor;
+    auto updateStart = std::chrono::steady_clock::now();
+    choleskyUpdate(updated, vectors);
+    std::chrono::duration<double> updateTime = std::chrono::steady_clock::now() - updateStart;
+
+    Matrix<float, N, N> downdated = updated;
+    auto downdateStart = std::chrono::steady_clock::now();
+    const bool downdateSucceeded = choleskyDowndate(downdated, vectors);
+    std::chrono::duration<double> downdateTime = std::chrono::steady_clock::now() - downdateStart;
+
+    std::cout << "N = " << N << ", rank K = " << K << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    printFactorReport("Recursive refactorization of A + X X^T", refactorTime, updatedMat, refactored, verification);
+    printFactorReport("Rank-K update of the factor of A", updateTime, updatedMat, updated, verification);
+    if (!downdateSucceeded)
+    {
+        std::cout << "FATAL ERROR: downdate of an update was refused" << std::endl;
+        return;
+    }
+    printFactorReport("Rank-K downdate back to A", downdateTime, mat, downdated, verification);
+
+    Matrix<float, N, N> rankOneUpdated = factor;
+    for (std::size_t j = 0; j != K; ++j)
+    {
+        const Matrix<float, N, 1> column = vectors.column(j);
+        choleskyUpdate(rankOneUpdated, column);
+    }
+    std::cout << "Bitwise identical to " << K << " rank-1 updates: " << (rankOneUpdated.bitwiseEquals(updated) ? "yes" : "no") << std::endl;
+
+    Matrix<float, N, N> refused = factor;
+    Matrix<float, N, K> largeVectors = vectors;
+    largeVectors.add(vectors, 99.0);
+    std::cout << "Infeasible downdate refused, factor untouched: " << ((!choleskyDowndate(refused, largeVectors) && refused.bitwiseEquals(factor)) ? "yes" : "no") << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Covariance of a stationary process observed at unit time steps: squared-exponential correlation plus
+ * measurement noise on the diagonal.
+ */
+float windowCovariance(std::size_t i, std::size_t j)
+{
+    const float distance = ((float)i - (float)j) / 16.0f;
+    return std::exp(-0.5f * distance * distance) + ((i == j) ? 0.1f : 0.0f);
+}
+
+/**
+ * @brief Slide a window of N observations over a time series and compare one slide with a refactorization of the
+ * window.
+ */
+template <std::size_t N>
+void benchmarkSlidingWindow(std::size_t slides, VerificationMode verification)
+{
+    Matrix<float, N, N> window([](std::size_t i, std::size_t j)
+                               { return windowCovariance(i, j); });
+    Matrix<float, N, N> factor;
+    recursiveCholesky(window, factor);
+
+    auto slideStart = std::chrono::steady_clock::now();
+    for (std::size_t step = 1; step <= slides; ++step)
+    {
+        std::vector<float> column(N);
+        for (std::size_t m = 0; m != N; ++m)
+        {
+            column[m] = windowCovariance(step + m, step + N - 1);
+        }
+        if (!choleskySlide(factor, column))
+        {
+            std::cout << "FATAL ERROR: window matrix is not positive definite" << std::endl;
+            return;
+        }
+    }
+    std::chrono::duration<double> slideTime = std::chrono::steady_clock::now() - slideStart;
+
+    Matrix<float, N, N> finalWindow([slides](std::size_t i, std::size_t j)
+                                    { return windowCovariance(slides + i, slides + j); });
+    auto refactorStart = std::chrono::steady_clock::now();
+    Matrix<float, N, N> refactored;
+    recursiveCholesky(finalWindow, refactored);
+    std::chrono::duration<double> refactorTime = std::chrono::steady_clock::now() - refactorStart;
+
+    std::cout << "Sliding window, N = " << N << ", " << slides << " slides" << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    printFactorReport("Recursive refactorization of the final window", refactorTime, finalWindow, refactored, verification);
+    printFactorReport("All slides (remove oldest, append newest)", slideTime, finalWindow, factor, verification);
+    std::cout << "Milliseconds per slide: " << 1000 * slideTime.count() / slides << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+    std::cout << std::endl;
+    benchmarkRankUpdate<1024, 1>(verification);
+    benchmarkRankUpdate<1024, 16>(verification);
+    benchmarkRankUpdate<2048, 16>(verification);
+    benchmarkSlidingWindow<1024>(64, verification);
+}
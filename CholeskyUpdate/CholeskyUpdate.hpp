@@ -0,0 +1,338 @@
+#ifndef CHOLESKYUPDATEHPP
+#define CHOLESKYUPDATEHPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+
+/**
+ * @brief Columns per block of a blocked update: the rotations of one block are computed on the diagonal block, then
+ * applied to all rows below it in parallel.
+ */
+constexpr std::size_t updateBlockSize = 64;
+
+/**
+ * @brief The rotations of a rank-k update or downdate, one per vector and column.
+ *
+ * For vector j and column c, the new column of the factor is (column + signedSines * x) * inverseCosines and the
+ * vector becomes cosines * x - sines * (new column), where signedSines is -sines for a downdate (hyperbolic
+ * rotation) and sines for an update.
+ */
+template <typename TScalar>
+struct FactorRotations
+{
+    std::vector<std::vector<TScalar>> cosines;
+    std::vector<std::vector<TScalar>> inverseCosines;
+    std::vector<std::vector<TScalar>> sines;
+    std::vector<std::vector<TScalar>> signedSines;
+
+    FactorRotations(std::size_t k, std::size_t n) : cosines(k, std::vector<TScalar>(n)), inverseCosines(k, std::vector<TScalar>(n)), sines(k, std::vector<TScalar>(n)), signedSines(k, std::vector<TScalar>(n)){};
+};
+
+/**
+ * @brief Apply the rotations of vector j for columns firstCol, ..., lastCol - 1 to row i of the factor.
+ */
+template <typename TScalar>
+void rotateFactorRow(TScalar *row, std::size_t i, std::size_t firstCol, std::size_t lastCol, std::size_t j, std::vector<std::vector<TScalar>> &vectors, const FactorRotations<TScalar> &rotations)
+{
+    const TScalar *c = rotations.cosines[j].data();
+    const TScalar *ci = rotations.inverseCosines[j].data();
+    const TScalar *s = rotations.sines[j].data();
+    const TScalar *ss = rotations.signedSines[j].data();
+    TScalar x = vectors[j][i];
+    for (std::size_t col = firstCol; col != lastCol; ++col)
+    {
+        const TScalar l = (row[col] + ss[col] * x) * ci[col];
+        x = c[col] * x - s[col] * l;
+        row[col] = l;
+    }
+    vectors[j][i] = x;
+}
+
+/**
+ * @brief Apply the rotations of all vectors for columns firstCol, ..., lastCol - 1 to rows firstRow, ...,
+ * lastRow - 1 of the factor, vector by vector.
+ *
+ * Along a row every rotation depends on the previous one, so rows are handled four at a time to give the core
+ * four independent chains; each row still gets exactly the operations of rotateFactorRow.
+ */
+template <typename TScalar, std::size_t N>
+void rotateFactorRows(Matrix<TScalar, N, N> &factor, std::size_t firstRow, std::size_t lastRow, std::size_t firstCol, std::size_t lastCol, std::vector<std::vector<TScalar>> &vectors, const FactorRotations<TScalar> &rotations)
+{
+    std::size_t i = firstRow;
+    for (; i + 4 <= lastRow; i += 4)
+    {
+        TScalar *row0 = factor.rowData(i);
+        TScalar *row1 = factor.rowData(i + 1);
+        TScalar *row2 = factor.rowData(i + 2);
+        TScalar *row3 = factor.rowData(i + 3);
+        for (std::size_t j = 0; j != vectors.size(); ++j)
+        {
+            const TScalar *c = rotations.cosines[j].data();
+            const TScalar *ci = rotations.inverseCosines[j].data();
+            const TScalar *s = rotations.sines[j].data();
+            const TScalar *ss = rotations.signedSines[j].data();
+            TScalar *x = vectors[j].data() + i;
+            TScalar x0 = x[0];
+            TScalar x1 = x[1];
+            TScalar x2 = x[2];
+            TScalar x3 = x[3];
+            for (std::size_t col = firstCol; col != lastCol; ++col)
+            {
+                const TScalar l0 = (row0[col] + ss[col] * x0) * ci[col];
+                const TScalar l1 = (row1[col] + ss[col] * x1) * ci[col];
+                const TScalar l2 = (row2[col] + ss[col] * x2) * ci[col];
+                const TScalar l3 = (row3[col] + ss[col] * x3) * ci[col];
+                x0 = c[col] * x0 - s[col] * l0;
+                x1 = c[col] * x1 - s[col] * l1;
+                x2 = c[col] * x2 - s[col] * l2;
+                x3 = c[col] * x3 - s[col] * l3;
+                row0[col] = l0;
+                row1[col] = l1;
+                row2[col] = l2;
+                row3[col] = l3;
+            }
+            x[0] = x0;
+            x[1] = x1;
+            x[2] = x2;
+            x[3] = x3;
+        }
+    }
+    for (; i != lastRow; ++i)
+    {
+        for (std::size_t j = 0; j != vectors.size(); ++j)
+        {
+            rotateFactorRow(factor.rowData(i), i, firstCol, lastCol, j, vectors, rotations);
+        }
+    }
+}
+
+/**
+ * @brief Update (sign = 1) or downdate (sign = -1) the diagonal block of rows and columns first, ..., last - 1 of a
+ * lower-triangular factor: L L^T + sign * X X^T for the columns X of vectors (indexed by row; entries outside the
+ * block are ignored).
+ *
+ * Blocked by updateBlockSize columns: the rotations of a block are computed row by row on its diagonal block, then
+ * the rows below it are rotated in parallel. Every entry of the factor and of the vectors sees the same operations
+ * in the same order as with one rank-1 update per vector, so the result is bitwise identical to that for any block
+ * size and number of threads.
+ *
+ * @return false if a new diagonal entry is not positive (only possible for a downdate); the factor is then left
+ * partially updated.
+ */
+template <typename TScalar, std::size_t N>
+bool rankUpdateRange(Matrix<TScalar, N, N> &factor, std::size_t first, std::size_t last, std::vector<std::vector<TScalar>> &vectors, TScalar sign)
+{
+    FactorRotations<TScalar> rotations(vectors.size(), N);
+    for (std::size_t firstCol = first; firstCol < last; firstCol += updateBlockSize)
+    {
+        const std::size_t lastCol = std::min(firstCol + updateBlockSize, last);
+        for (std::size_t i = firstCol; i != lastCol; ++i)
+        {
+            TScalar *row = factor.rowData(i);
+            for (std::size_t j = 0; j != vectors.size(); ++j)
+            {
+                rotateFactorRow(row, i, firstCol, i, j, vectors, rotations);
+                const TScalar diagonal = row[i];
+                const TScalar x = vectors[j][i];
+                const TScalar squared = diagonal * diagonal + sign * (x * x);
+                if (!(squared > 0))
+                {
+                    return false;
+                }
+                const TScalar r = std::sqrt(squared);
+                rotations.cosines[j][i] = r / diagonal;
+                rotations.inverseCosines[j][i] = diagonal / r;
+                rotations.sines[j][i] = x / diagonal;
+                rotations.signedSines[j][i] = sign * (x / diagonal);
+                row[i] = r;
+            }
+        }
+        parallelForRange(last - lastCol, 6 * vectors.size() * (lastCol - firstCol), [&factor, &vectors, &rotations, firstCol, lastCol](std::size_t begin, std::size_t end)
+                         { rotateFactorRows(factor, lastCol + begin, lastCol + end, firstCol, lastCol, vectors, rotations); });
+    }
+    return true;
+}
+
+/**
+ * @brief Whether the block first, ..., last - 1 of L L^T - X X^T is positive definite, i.e. whether a downdate
+ * would succeed, in O(k * n^2) without touching the factor.
+ *
+ * With P = L^-1 X (a forward substitution per vector), L L^T - X X^T = L (I - P P^T) L^T, which is positive
+ * definite iff the k by k matrix I - P^T P is; the latter is checked by a small Cholesky factorization.
+ */
+template <typename TScalar, std::size_t N>
+bool downdateFeasible(const Matrix<TScalar, N, N> &factor, std::size_t first, std::size_t last, const std::vector<std::vector<TScalar>> &vectors)
+{
+    const std::size_t k = vectors.size();
+    std::vector<std::vector<TScalar>> p(k, std::vector<TScalar>(N, 0));
+    for (std::size_t i = first; i != last; ++i)
+    {
+        const TScalar *row = factor.rowData(i);
+        for (std::size_t j = 0; j != k; ++j)
+        {
+            p[j][i] = (vectors[j][i] - dotProduct(row + first, p[j].data() + first, i - first)) / row[i];
+        }
+    }
+
+    std::vector<std::vector<TScalar>> gram(k, std::vector<TScalar>(k));
+    for (std::size_t a = 0; a != k; ++a)
+    {
+        for (std::size_t b = 0; b <= a; ++b)
+        {
+            gram[a][b] = ((a == b) ? 1 : 0) - dotProduct(p[a].data() + first, p[b].data() + first, last - first);
+        }
+    }
+    for (std::size_t a = 0; a != k; ++a)
+    {
+        for (std::size_t b = 0; b <= a; ++b)
+        {
+            const TScalar sum = gram[a][b] - dotProduct(gram[a].data(), gram[b].data(), b);
+            if (a == b)
+            {
+                if (!(sum > 0))
+                {
+                    return false;
+                }
+                gram[a][a] = std::sqrt(sum);
+            }
+            else
+            {
+                gram[a][b] = sum / gram[b][b];
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copy the columns of a dense N by K matrix into K contiguous vectors.
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+std::vector<std::vector<TScalar>> columnVectors(const Matrix<TScalar, N, K> &mat)
+{
+    std::vector<std::vector<TScalar>> vectors(K, std::vector<TScalar>(N));
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        for (std::size_t j = 0; j != K; ++j)
+        {
+            vectors[j][i] = mat.rowData(i)[j];
+        }
+    }
+    return vectors;
+}
+
+/**
+ * @brief Turn the Cholesky factor L of A into the factor of A + X X^T in place, in O(K * N^2) instead of the
+ * O(N^3) of a new factorization.
+ *
+ * @tparam K The rank of the update (the number of columns of X)
+ * @param factor The lower-triangular factor L, with a positive diagonal.
+ * @param vectors The N by K matrix X
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+void choleskyUpdate(Matrix<TScalar, N, N> &factor, const Matrix<TScalar, N, K> &vectors)
+{
+    std::vector<std::vector<TScalar>> x = columnVectors(vectors);
+    rankUpdateRange(factor, 0, N, x, (TScalar)1);
+}
+
+/**
+ * @brief Turn the Cholesky factor L of A into the factor of A - X X^T in place (hyperbolic rotations), in
+ * O(K * N^2).
+ *
+ * Feasibility is checked first (downdateFeasible), so a downdate that would leave a matrix that is not positive
+ * definite returns false and leaves the factor untouched. Downdates towards a nearly singular matrix lose accuracy.
+ *
+ * @return false if A - X X^T is not positive definite (in working precision).
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+bool choleskyDowndate(Matrix<TScalar, N, N> &factor, const Matrix<TScalar, N, K> &vectors)
+{
+    std::vector<std::vector<TScalar>> x = columnVectors(vectors);
+    if (!downdateFeasible(factor, 0, N, x))
+    {
+        return false;
+    }
+    return rankUpdateRange(factor, 0, N, x, (TScalar)-1);
+}
+
+/**
+ * @brief Remove row and column index from a matrix of the given size through its Cholesky factor, in
+ * O((size - index)^2).
+ *
+ * The factor occupies the leading size by size block of a capacity-N matrix and everything else is zero. Rows
+ * index + 1, ... move up by one and lose their entry in column index, which is instead added back to the trailing
+ * block by a rank-1 update: L33' L33'^T = L33 L33^T + l32 l32^T. The factor then occupies size - 1 rows.
+ */
+template <typename TScalar, std::size_t N>
+void choleskyRemove(Matrix<TScalar, N, N> &factor, std::size_t size, std::size_t index)
+{
+    std::vector<std::vector<TScalar>> vectors(1, std::vector<TScalar>(N, 0));
+    for (std::size_t i = index + 1; i != size; ++i)
+    {
+        vectors[0][i - 1] = factor.rowData(i)[index];
+    }
+    parallelForRange(size - index - 1, size, [&factor, index](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = index + 1 + begin; i != index + 1 + end; ++i)
+                         {
+                             TScalar *row = factor.rowData(i);
+                             std::copy(row + index + 1, row + i + 1, row + index);
+                             row[i] = 0;
+                         }
+                     });
+    for (std::size_t i = index; i + 1 < size; ++i)
+    {
+        factor.swapRows(i, i + 1);
+    }
+    std::fill(factor.rowData(size - 1), factor.rowData(size - 1) + N, (TScalar)0);
+    rankUpdateRange(factor, index, size - 1, vectors, (TScalar)1);
+}
+
+/**
+ * @brief Append a row and column to a matrix of the given size (size < N) through its Cholesky factor, in
+ * O(size^2): the new row of the factor solves L l = a, and its diagonal is sqrt(alpha - l^T l).
+ *
+ * @param column The size + 1 entries of the new column: its couplings a with the existing rows, then its diagonal
+ * entry alpha.
+ * @return false if the extended matrix is not positive definite; the factor is then untouched.
+ */
+template <typename TScalar, std::size_t N>
+bool choleskyAppend(Matrix<TScalar, N, N> &factor, std::size_t size, const std::vector<TScalar> &column)
+{
+    std::vector<TScalar> row(size + 1);
+    for (std::size_t m = 0; m != size; ++m)
+    {
+        const TScalar *factorRow = factor.rowData(m);
+        row[m] = (column[m] - dotProduct(factorRow, row.data(), m)) / factorRow[m];
+    }
+    const TScalar squared = column[size] - dotProduct(row.data(), row.data(), size);
+    if (!(squared > 0))
+    {
+        return false;
+    }
+    row[size] = std::sqrt(squared);
+    std::copy(row.begin(), row.end(), factor.rowData(size));
+    return true;
+}
+
+/**
+ * @brief Slide a window of N observations by one through its Cholesky factor: drop the oldest (row and column 0)
+ * and append a new one as row and column N - 1, in O(N^2) instead of the O(N^3) of a new factorization.
+ *
+ * @param column The N entries of the new column: its couplings with the N - 1 observations that stay (oldest
+ * first), then its diagonal entry.
+ * @return false if the new window matrix is not positive definite; the factor then only holds the N - 1
+ * remaining observations.
+ */
+template <typename TScalar, std::size_t N>
+bool choleskySlide(Matrix<TScalar, N, N> &factor, const std::vector<TScalar> &column)
+{
+    choleskyRemove(factor, N, 0);
+    return choleskyAppend(factor, N - 1, column);
+}
+
+#endif
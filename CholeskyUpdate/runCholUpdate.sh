@@ -0,0 +1,5 @@
+#!/bin/bash
+
+g++ -Wall -std=c++17 -O3 -march=native -pthread -o cholUpdate ./CholeskyUpdate.cpp
+./cholUpdate "$@"
+rm ./cholUpdate
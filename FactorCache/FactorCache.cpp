@@ -0,0 +1,154 @@
+#define _USE_MATH_DEFINES
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../MessageQueue/MessageQueue.hpp"
+#include "../BackSubstitutionParallel/BackSubstitution.hpp"
+#include "FactorCache.hpp"
+
+void printCacheCounters(const FactorCache &cache)
+{
+    std::cout << "Cache hits / misses / evictions: " << cache.hits() << " / " << cache.misses() << " / " << cache.evictions() << std::endl;
+    std::cout << "Cached factors: " << cache.size() << ", bytes: " << cache.bytesUsed() << std::endl;
+}
+
+/**
+ * @brief Solve nSolves batches of right hand sides against the same SPD matrix, refactoring every time and through
+ * the cache.
+ */
+template <std::size_t N, std::size_t K>
+void benchmarkRepeatedSolves(std::size_t nSolves, VerificationMode verification)
+{
+    const Matrix<float, N, N> mat = wishart<float, N, N>(11828, 10.0, 1.0);
+    std::vector<Matrix<float, N, K>> batches{};
+    for (std::size_t s = 0; s != nSolves; ++s)
+    {
+        batches.push_back(randomNormal<float, N, K>(11828 + s, NormalStream, 1.0));
+    }
+
+    auto uncachedStart = std::chrono::steady_clock::now();
+    for (const Matrix<float, N, K> &rhs : batches)
+    {
+        Matrix<float, N, N> factor;
+        recursiveCholesky(mat, factor);
+        Matrix<float, N, K> result;
+        choleskySolve(factor, rhs, result);
+    }
+    std::chrono::duration<double> uncachedTime = std::chrono::steady_clock::now() - uncachedStart;
+
+    FactorCache cache(64 << 20);
+    std::vector<Matrix<float, N, K>> results(nSolves);
+    float maxResidual = 0;
+    auto cachedStart = std::chrono::steady_clock::now();
+    for (std::size_t s = 0; s != nSolves; ++s)
+    {
+        if (!cachedCholeskySolve(cache, mat, batches[s], results[s]))
+        {
+            std::cout << "FATAL ERROR: matrix is not positive definite" << std::endl;
+            return;
+        }
+    }
+    std::chrono::duration<double> cachedTime = std::chrono::steady_clock::now() - cachedStart;
+    for (std::size_t s = 0; s != nSolves; ++s)
+    {
+        maxResidual = std::max(maxResidual, solveResidual(mat, batches[s], results[s], verification));
+    }
+
+    auto hashStart = std::chrono::steady_clock::now();
+    const std::uint64_t fingerprint = matrixFingerprint(mat);
+    std::chrono::duration<double> hashTime = std::chrono::steady_clock::now() - hashStart;
+
+    std::cout << "Repeated Cholesky solves, N = " << N << ", K = " << K << ", " << nSolves << " batches" << std::endl;
+    std::cout << "Refactoring every batch, milliseconds: " << (int)(1000 * uncachedTime.count()) << std::endl;
+    std::cout << "Through the factor cache, milliseconds: " << (int)(1000 * cachedTime.count()) << std::endl;
+    std::cout << "Fingerprint milliseconds: " << 1000 * hashTime.count() << " (" << std::hex << fingerprint << std::dec << ")" << std::endl;
+    printCacheCounters(cache);
+    printResidual(maxResidual, verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Cycle through three matrices with room for two factors, and check that changing one entry misses.
+ */
+template <std::size_t N, std::size_t K>
+void demonstrateEviction()
+{
+    std::vector<Matrix<float, N, N>> mats{};
+    for (std::uint64_t seed : {1, 2, 3})
+    {
+        mats.push_back(wishart<float, N, N>(seed, 10.0, 1.0));
+    }
+    const Matrix<float, N, K> rhs = randomNormal<float, N, K>(11828, NormalStream, 1.0);
+    Matrix<float, N, K> result;
+
+    FactorCache cache(2 * N * N * sizeof(float));
+    for (std::size_t m : {0, 1, 0, 2, 0, 1})
+    {
+        cachedCholeskySolve(cache, mats[m], rhs, result);
+    }
+    std::cout << "Three matrices, room for two factors, access order 0 1 0 2 0 1" << std::endl;
+    printCacheCounters(cache);
+
+    Matrix<float, N, N> changed = mats[0];
+    changed.set(N - 1, N - 1, changed.get(N - 1, N - 1) + 1.0f);
+    const std::size_t missesBefore = cache.misses();
+    cachedCholeskySolve(cache, changed, rhs, result);
+    std::cout << "Changing one diagonal entry misses: " << ((cache.misses() == missesBefore + 1) ? "yes" : "no") << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Compare the parallel back substitution, which copies the matrix for its block threads on every call, with
+ * the in-place upper-triangular solve.
+ */
+template <std::size_t N, std::size_t NBlock, std::size_t K>
+void benchmarkTriangularSolves(std::size_t nSolves, VerificationMode verification)
+{
+    const Matrix<float, N, N> mat = randomUpperTriangular<float, N>(11828, 100.0);
+    const Matrix<float, N, K> rhs = randomNormal<float, N, K>(11828, NormalStream, 1.0);
+    Matrix<float, N, K> copiedResult;
+    Matrix<float, N, K> inPlaceResult;
+
+    auto copiedStart = std::chrono::steady_clock::now();
+    for (std::size_t s = 0; s != nSolves; ++s)
+    {
+        backSubstitutionParallel<float, N, NBlock, K>(mat, rhs, copiedResult);
+    }
+    std::chrono::duration<double> copiedTime = std::chrono::steady_clock::now() - copiedStart;
+
+    auto inPlaceStart = std::chrono::steady_clock::now();
+    for (std::size_t s = 0; s != nSolves; ++s)
+    {
+        upperTriangularSolve(mat, rhs, inPlaceResult);
+    }
+    std::chrono::duration<double> inPlaceTime = std::chrono::steady_clock::now() - inPlaceStart;
+
+    std::cout << "Repeated upper-triangular solves, N = " << N << ", K = " << K << ", " << nSolves << " batches" << std::endl;
+    std::cout << "Parallel back substitution (p = " << N / NBlock << "), milliseconds: " << (int)(1000 * copiedTime.count()) << std::endl;
+    printResidual(solveResidual(mat, rhs, copiedResult, verification), verification);
+    std::cout << "In-place triangular solve, milliseconds: " << (int)(1000 * inPlaceTime.count()) << std::endl;
+    printResidual(solveResidual(mat, rhs, inPlaceResult, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+    std::cout << std::endl;
+    benchmarkRepeatedSolves<1024, 16>(8, verification);
+    benchmarkRepeatedSolves<2048, 16>(8, verification);
+    demonstrateEviction<512, 4>();
+    benchmarkTriangularSolves<2048, 256, 16>(8, verification);
+    benchmarkTriangularSolves<2048, 256, 1>(8, verification);
+}
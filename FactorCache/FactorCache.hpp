@@ -0,0 +1,344 @@
+#ifndef FACTORCACHEHPP
+#define FACTORCACHEHPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Hash.hpp"
+#include "../Matrix/ColumnSolve.hpp"
+#include "../CholeskyParallel/RecursiveCholesky.hpp"
+
+/**
+ * @brief What a cached factor was computed by.
+ */
+enum class FactorKind
+{
+    Cholesky
+};
+
+/**
+ * @brief Identifies the factor of one matrix: the content hash of its entries, its shape and scalar type, and the
+ * factorization. Two different matrices share a key only on a 64-bit hash collision.
+ */
+struct FactorKey
+{
+    std::uint64_t fingerprint;
+    std::size_t rows;
+    std::size_t cols;
+    std::size_t scalarType;
+    FactorKind kind;
+
+    bool operator==(const FactorKey &other) const
+    {
+        return fingerprint == other.fingerprint && rows == other.rows && cols == other.cols && scalarType == other.scalarType && kind == other.kind;
+    };
+};
+
+struct FactorKeyHash
+{
+    std::size_t operator()(const FactorKey &key) const
+    {
+        return (std::size_t)(key.fingerprint ^ (key.scalarType * 31 + key.rows * 7 + key.cols + (std::size_t)key.kind));
+    };
+};
+
+template <typename TScalar, std::size_t NRows, std::size_t NCols>
+FactorKey factorKey(const Matrix<TScalar, NRows, NCols> &mat, FactorKind kind)
+{
+    return FactorKey{matrixFingerprint(mat), NRows, NCols, typeid(TScalar).hash_code(), kind};
+}
+
+/**
+ * @brief A bounded-memory LRU cache of factorizations, keyed by FactorKey; safe to share between threads.
+ *
+ * Factors of any type live in the same cache (the key fixes the type) and are handed out as shared pointers to
+ * const, so an evicted factor stays valid for whoever still uses it. Inserting evicts the least recently used
+ * factors until the new one fits the budget; a factor larger than the whole budget is not cached. Two threads that
+ * miss on the same key at the same time both factor, and the second insert replaces the first.
+ */
+class FactorCache
+{
+private:
+    struct Entry
+    {
+        std::shared_ptr<const void> factor;
+        std::size_t bytes;
+        std::list<FactorKey>::iterator recency;
+    };
+
+    std::size_t budget;
+    std::size_t used = 0;
+    std::unordered_map<FactorKey, Entry, FactorKeyHash> entries{};
+    std::list<FactorKey> recency{};
+    mutable std::mutex mutex;
+
+    std::size_t nHits = 0;
+    std::size_t nMisses = 0;
+    std::size_t nEvictions = 0;
+
+    /**
+     * @brief Remove an entry. Called with the mutex held.
+     */
+    void erase(std::unordered_map<FactorKey, Entry, FactorKeyHash>::iterator found)
+    {
+        used -= found->second.bytes;
+        recency.erase(found->second.recency);
+        entries.erase(found);
+    };
+
+public:
+    /**
+     * @param budgetBytes Upper bound on the total size of the cached factors.
+     */
+    explicit FactorCache(std::size_t budgetBytes) : budget(budgetBytes){};
+
+    FactorCache(const FactorCache &) = delete;
+    FactorCache &operator=(const FactorCache &) = delete;
+
+    /**
+     * @brief Return the factor cached under key, or null; counts a hit or a miss.
+     *
+     * @tparam TFactor The type the factor was inserted with.
+     */
+    template <typename TFactor>
+    std::shared_ptr<const TFactor> find(const FactorKey &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(key);
+        if (found == entries.end())
+        {
+            ++nMisses;
+            return nullptr;
+        }
+        ++nHits;
+        recency.splice(recency.begin(), recency, found->second.recency);
+        return std::static_pointer_cast<const TFactor>(found->second.factor);
+    };
+
+    /**
+     * @brief Cache a factor of the given size under key, evicting least recently used factors as needed.
+     */
+    template <typename TFactor>
+    void insert(const FactorKey &key, std::shared_ptr<const TFactor> factor, std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(key);
+        if (found != entries.end())
+        {
+            erase(found);
+        }
+        if (bytes > budget)
+        {
+            return;
+        }
+        while (used + bytes > budget)
+        {
+            erase(entries.find(recency.back()));
+            ++nEvictions;
+        }
+        recency.push_front(key);
+        entries[key] = Entry{std::static_pointer_cast<const void>(factor), bytes, recency.begin()};
+        used += bytes;
+    };
+
+    /**
+     * @brief Drop every cached factor (the counters are kept).
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        recency.clear();
+        used = 0;
+    };
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    };
+
+    std::size_t bytesUsed() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return used;
+    };
+
+    std::size_t hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nHits;
+    };
+
+    std::size_t misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nMisses;
+    };
+
+    /**
+     * @brief Factors dropped to make room for new ones.
+     */
+    std::size_t evictions() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nEvictions;
+    };
+};
+
+/**
+ * @brief Rows per block of the dense triangular sweeps below: the diagonal block of a sweep runs on one thread, and
+ * the update of the rows past it is split across threads when there are fewer right hand sides than threads.
+ */
+template <std::size_t N>
+constexpr std::size_t triangularSweepBlock = N / 8 > 64 ? N / 8 : 64;
+
+/**
+ * @brief Solve A * X = B from the Cholesky factor L of A, reading L in place: L * Y = B forward by rows of L (dot
+ * products), then L^T * X = Y backward by the same rows (updates), in O(N^2 * K).
+ *
+ * Like bandCholeskySolve, every right hand side is copied into a contiguous vector (solveContiguousColumns) and
+ * every row of L is applied to all right hand sides of a thread while it is in cache. Both sweeps go by blocks of
+ * triangularSweepBlock rows, so with few right hand sides the off-diagonal blocks are split across threads by rows.
+ * Unlike backSubstitutionParallel, the matrix is not copied.
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+void choleskySolve(const Matrix<TScalar, N, N> &factor, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    solveContiguousColumns(rhs, result, 2 * N * N, [&factor](std::vector<std::vector<TScalar>> &x)
+                           {
+                               for (std::size_t first = 0; first < N; first += triangularSweepBlock<N>)
+                               {
+                                   const std::size_t last = std::min(N, first + triangularSweepBlock<N>);
+                                   for (std::size_t i = first; i != last; ++i)
+                                   {
+                                       const TScalar *row = factor.rowData(i);
+                                       for (auto &xn : x)
+                                       {
+                                           xn[i] = (xn[i] - dotProduct(row + first, xn.data() + first, i - first)) / row[i];
+                                       }
+                                   }
+                                   parallelForRange(N - last, 2 * (last - first) * x.size(), [&factor, &x, first, last](std::size_t begin, std::size_t end)
+                                                    {
+                                                        for (std::size_t i = last + begin; i != last + end; ++i)
+                                                        {
+                                                            const TScalar *row = factor.rowData(i);
+                                                            for (auto &xn : x)
+                                                            {
+                                                                xn[i] -= dotProduct(row + first, xn.data() + first, last - first);
+                                                            }
+                                                        }
+                                                    });
+                               }
+                               for (std::size_t last = N; last != 0;)
+                               {
+                                   const std::size_t first = last - std::min(last, triangularSweepBlock<N>);
+                                   for (std::size_t i = last; i-- != first;)
+                                   {
+                                       const TScalar *row = factor.rowData(i);
+                                       for (auto &xn : x)
+                                       {
+                                           const TScalar value = xn[i] / row[i];
+                                           xn[i] = value;
+                                           TScalar *above = xn.data();
+                                           for (std::size_t m = first; m != i; ++m)
+                                           {
+                                               above[m] -= row[m] * value;
+                                           }
+                                       }
+                                   }
+                                   parallelForRange(first, 2 * (last - first) * x.size(), [&factor, &x, first, last](std::size_t begin, std::size_t end)
+                                                    {
+                                                        for (std::size_t i = first; i != last; ++i)
+                                                        {
+                                                            const TScalar *row = factor.rowData(i);
+                                                            for (auto &xn : x)
+                                                            {
+                                                                const TScalar value = xn[i];
+                                                                TScalar *above = xn.data();
+                                                                for (std::size_t m = begin; m != end; ++m)
+                                                                {
+                                                                    above[m] -= row[m] * value;
+                                                                }
+                                                            }
+                                                        }
+                                                    });
+                                   last = first;
+                               }
+                           });
+}
+
+/**
+ * @brief Solve A * X = B for upper-triangular A, reading A in place, in O(N^2 * K); each unknown is a dot product of
+ * a row of A with the unknowns below it. The right hand sides and the row blocks are split across threads as in
+ * choleskySolve.
+ *
+ * A triangular matrix needs no factorization, so there is nothing to cache: this is the hit path for triangular
+ * systems, without the per-call copies of backSubstitutionParallel.
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+void upperTriangularSolve(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    solveContiguousColumns(rhs, result, N * N, [&mat](std::vector<std::vector<TScalar>> &x)
+                           {
+                               for (std::size_t last = N; last != 0;)
+                               {
+                                   const std::size_t first = last - std::min(last, triangularSweepBlock<N>);
+                                   for (std::size_t i = last; i-- != first;)
+                                   {
+                                       const TScalar *row = mat.rowData(i);
+                                       for (auto &xn : x)
+                                       {
+                                           xn[i] = (xn[i] - dotProduct(row + i + 1, xn.data() + i + 1, last - 1 - i)) / row[i];
+                                       }
+                                   }
+                                   parallelForRange(first, 2 * (last - first) * x.size(), [&mat, &x, first, last](std::size_t begin, std::size_t end)
+                                                    {
+                                                        for (std::size_t i = begin; i != end; ++i)
+                                                        {
+                                                            const TScalar *row = mat.rowData(i);
+                                                            for (auto &xn : x)
+                                                            {
+                                                                xn[i] -= dotProduct(row + first, xn.data() + first, last - first);
+                                                            }
+                                                        }
+                                                    });
+                                   last = first;
+                               }
+                           });
+}
+
+/**
+ * @brief Solve A * X = B for symmetric positive definite A through the cache: on a hit the cached Cholesky factor of
+ * A goes straight to choleskySolve; on a miss A is factored (recursiveCholesky) and the factor is cached.
+ *
+ * The lookup hashes A, which costs one pass over its N^2 entries.
+ *
+ * @return false if A is not positive definite (nothing is cached then).
+ */
+template <typename TScalar, std::size_t N, std::size_t K>
+bool cachedCholeskySolve(FactorCache &cache, const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result)
+{
+    const FactorKey key = factorKey(mat, FactorKind::Cholesky);
+    std::shared_ptr<const Matrix<TScalar, N, N>> factor = cache.find<Matrix<TScalar, N, N>>(key);
+    if (!factor)
+    {
+        std::shared_ptr<Matrix<TScalar, N, N>> computed = std::make_shared<Matrix<TScalar, N, N>>();
+        if (!recursiveCholesky(mat, *computed))
+        {
+            return false;
+        }
+        factor = computed;
+        cache.insert(key, factor, N * N * sizeof(TScalar));
+    }
+    choleskySolve(*factor, rhs, result);
+    return true;
+}
+
+#endif
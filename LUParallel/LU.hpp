@@ -0,0 +1,236 @@
+#ifndef LUHPP
+#define LUHPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+#include "../BackSubstitutionParallel/BackSubstitution.hpp"
+
+/**
+ * @brief Columns of the trailing matrix updated per pass of luTrailingUpdate, so that the NB rows of U12 being
+ * applied stay in cache.
+ */
+constexpr std::size_t luUpdateTileCols = 512;
+
+/**
+ * @brief Factor columns firstCol to lastCol - 1 of rows firstCol to N - 1 (the panel) with partial pivoting.
+ *
+ * Pivot rows are swapped across the whole matrix, so the columns left of the panel (already L) and right of it
+ * (not yet updated) are permuted along with it, as in LAPACK's getrf.
+ *
+ * @return false if a pivot column is exactly zero (the matrix is singular).
+ */
+template <typename TScalar, std::size_t N>
+bool luPanel(Matrix<TScalar, N, N> &mat, std::vector<std::size_t> &pivots, std::size_t firstCol, std::size_t lastCol)
+{
+    for (std::size_t j = firstCol; j != lastCol; ++j)
+    {
+        std::size_t pivotIdx = j;
+        for (std::size_t r = j + 1; r != N; ++r)
+        {
+            if (std::abs(mat.rowData(r)[j]) > std::abs(mat.rowData(pivotIdx)[j]))
+            {
+                pivotIdx = r;
+            }
+        }
+        pivots[j] = pivotIdx;
+        if (mat.rowData(pivotIdx)[j] == 0)
+        {
+            return false;
+        }
+        mat.swapRows(j, pivotIdx);
+
+        const TScalar *pivotRow = mat.rowData(j);
+        const TScalar pivot = pivotRow[j];
+        parallelForRange(N - j - 1, lastCol - j, [&mat, pivotRow, pivot, j, lastCol](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t r = j + 1 + begin; r != j + 1 + end; ++r)
+                             {
+                                 TScalar *row = mat.rowData(r);
+                                 const TScalar multiplier = row[j] / pivot;
+                                 row[j] = multiplier;
+                                 for (std::size_t c = j + 1; c != lastCol; ++c)
+                                 {
+                                     row[c] -= multiplier * pivotRow[c];
+                                 }
+                             }
+                         });
+    }
+    return true;
+}
+
+/**
+ * @brief U12 = L11^-1 * A12 for the block row firstRow to lastRow - 1 (unit lower L11), split across threads by columns.
+ */
+template <typename TScalar, std::size_t N>
+void luBlockRowSolve(Matrix<TScalar, N, N> &mat, std::size_t firstRow, std::size_t lastRow)
+{
+    const std::size_t nBlock = lastRow - firstRow;
+    parallelForRange(N - lastRow, nBlock * nBlock, [&mat, firstRow, lastRow](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t j = firstRow; j != lastRow; ++j)
+                         {
+                             const TScalar *sourceRow = mat.rowData(j);
+                             for (std::size_t r = j + 1; r != lastRow; ++r)
+                             {
+                                 TScalar *row = mat.rowData(r);
+                                 const TScalar multiplier = row[j];
+                                 for (std::size_t c = lastRow + begin; c != lastRow + end; ++c)
+                                 {
+                                     row[c] -= multiplier * sourceRow[c];
+                                 }
+                             }
+                         }
+                     });
+}
+
+/**
+ * @brief A22 -= L21 * U12, where the panel spans rows and columns firstCol to lastCol - 1. Split across threads by
+ * rows of A22; each row sees the NB rank-1 terms in increasing order, so the result does not depend on the number of
+ * threads.
+ */
+template <typename TScalar, std::size_t N>
+void luTrailingUpdate(Matrix<TScalar, N, N> &mat, std::size_t firstCol, std::size_t lastCol)
+{
+    parallelForRange(N - lastCol, (lastCol - firstCol) * (N - lastCol), [&mat, firstCol, lastCol](std::size_t begin, std::size_t end)
+                     {
+                         const std::size_t firstRow = lastCol + begin;
+                         const std::size_t lastRow = lastCol + end;
+                         const std::size_t lastBlockedRow = firstRow + (lastRow - firstRow) / 4 * 4;
+                         for (std::size_t firstTileCol = lastCol; firstTileCol < N; firstTileCol += luUpdateTileCols)
+                         {
+                             const std::size_t lastTileCol = std::min(firstTileCol + luUpdateTileCols, N);
+                             std::size_t i = firstRow;
+                             for (; i != lastBlockedRow; i += 4)
+                             {
+                                 TScalar *c0 = mat.rowData(i);
+                                 TScalar *c1 = mat.rowData(i + 1);
+                                 TScalar *c2 = mat.rowData(i + 2);
+                                 TScalar *c3 = mat.rowData(i + 3);
+                                 for (std::size_t k = firstCol; k != lastCol; ++k)
+                                 {
+                                     const TScalar a0 = c0[k];
+                                     const TScalar a1 = c1[k];
+                                     const TScalar a2 = c2[k];
+                                     const TScalar a3 = c3[k];
+                                     const TScalar *uRow = mat.rowData(k);
+                                     for (std::size_t j = firstTileCol; j < lastTileCol; ++j)
+                                     {
+                                         c0[j] -= a0 * uRow[j];
+                                         c1[j] -= a1 * uRow[j];
+                                         c2[j] -= a2 * uRow[j];
+                                         c3[j] -= a3 * uRow[j];
+                                     }
+                                 }
+                             }
+                             for (; i != lastRow; ++i)
+                             {
+                                 TScalar *row = mat.rowData(i);
+                                 for (std::size_t k = firstCol; k != lastCol; ++k)
+                                 {
+                                     const TScalar multiplier = row[k];
+                                     const TScalar *uRow = mat.rowData(k);
+                                     for (std::size_t j = firstTileCol; j < lastTileCol; ++j)
+                                     {
+                                         row[j] -= multiplier * uRow[j];
+                                     }
+                                 }
+                             }
+                         }
+                     });
+}
+
+/**
+ * @brief Blocked right-looking LU factorization with partial pivoting, P * A = L * U, in place.
+ *
+ * For every block column of width NB: factor the panel (luPanel), solve for the block row of U (luBlockRowSolve) and
+ * apply the rank-NB update to the trailing matrix (luTrailingUpdate), which carries almost all of the 2/3 N^3 flops
+ * and runs on all cores. On return the strictly lower triangle holds L (unit diagonal implied), the upper triangle
+ * holds U, and rows j and pivots[j] were swapped at step j.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam N Matrix size
+ * @tparam NB Panel width. Must divide N.
+ * @param mat The matrix A, overwritten with L and U.
+ * @param pivots Receives the N pivot rows.
+ * @return false if A is singular (an exact zero pivot was met); mat is then only partially factored.
+ */
+template <typename TScalar, std::size_t N, std::size_t NB>
+bool luFactor(Matrix<TScalar, N, N> &mat, std::vector<std::size_t> &pivots)
+{
+    static_assert(N % NB == 0, "NB must divide N");
+    pivots.assign(N, 0);
+    for (std::size_t firstCol = 0; firstCol != N; firstCol += NB)
+    {
+        const std::size_t lastCol = firstCol + NB;
+        if (!luPanel(mat, pivots, firstCol, lastCol))
+        {
+            return false;
+        }
+        if (lastCol != N)
+        {
+            luBlockRowSolve(mat, firstCol, lastCol);
+            luTrailingUpdate(mat, firstCol, lastCol);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Return the matrix with the order of its rows reversed.
+ */
+template <typename TScalar, std::size_t NRows, std::size_t NCols>
+Matrix<TScalar, NRows, NCols> reverseRows(const Matrix<TScalar, NRows, NCols> &mat)
+{
+    Matrix<TScalar, NRows, NCols> result = mat;
+    for (std::size_t i = 0; i != NRows / 2; ++i)
+    {
+        result.swapRows(i, NRows - 1 - i);
+    }
+    return result;
+}
+
+/**
+ * @brief Solve A * X = B from the factorization of luFactor, with the parallel back substitution for both
+ * triangular solves (N / NBlock threads each).
+ *
+ * The forward solve L * Y = P * B runs as a back substitution on J * L * J, the unit lower factor with rows and
+ * columns reversed (J is the reversal permutation), which is upper triangular: (J L J) (J Y) = J P B.
+ *
+ * @return Whether both triangular solves completed.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
+bool luSolve(const Matrix<TScalar, N, N> &lu, const std::vector<std::size_t> &pivots, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result, bool deterministic = false)
+{
+    Matrix<TScalar, N, K> permutedRhs = rhs;
+    for (std::size_t j = 0; j != N; ++j)
+    {
+        permutedRhs.swapRows(j, pivots[j]);
+    }
+
+    Matrix<TScalar, N, N> reversedLower(0);
+    parallelForRange(N, N / 2, [&lu, &reversedLower](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             TScalar *row = reversedLower.rowData(i);
+                             const TScalar *luRow = lu.rowData(N - 1 - i);
+                             row[i] = 1;
+                             for (std::size_t j = i + 1; j != N; ++j)
+                             {
+                                 row[j] = luRow[N - 1 - j];
+                             }
+                         }
+                     });
+
+    Matrix<TScalar, N, K> reversedIntermediate;
+    if (!backSubstitutionParallel<TScalar, N, NBlock, K>(reversedLower, reverseRows(permutedRhs), reversedIntermediate, deterministic))
+    {
+        return false;
+    }
+    return backSubstitutionParallel<TScalar, N, NBlock, K>(lu, reverseRows(reversedIntermediate), result, deterministic);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "LU.hpp"
+
+template <std::size_t N, std::size_t K>
+void generateLUInputs(Matrix<float, N, N> &mat, Matrix<float, N, K> &rhs)
+{
+    mat = randomNormal<float, N, N>(11828, NormalStream, 1.0);
+    rhs = randomNormal<float, N, K>(11829, NormalStream, 1.0);
+}
+
+/**
+ * @brief Factor a general matrix with panel width NB, solve for K right hand sides with N / NBlock back-substitution
+ * threads, and report the time and GFLOP/s of each phase (2/3 N^3 flops for the factorization, 2 N^2 K for the
+ * solves).
+ */
+template <typename TScalar, std::size_t N, std::size_t NB, std::size_t NBlock, std::size_t K>
+void computeLU(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, VerificationMode verification)
+{
+    Matrix<TScalar, N, N> lu = mat;
+    std::vector<std::size_t> pivots;
+
+    auto timerStart = std::chrono::steady_clock::now();
+    const bool factored = luFactor<TScalar, N, NB>(lu, pivots);
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> factorSeconds = timerStop - timerStart;
+    if (!factored)
+    {
+        std::cout << "FATAL ERROR: matrix is singular" << std::endl;
+        return;
+    }
+
+    Matrix<TScalar, N, K> result;
+    timerStart = std::chrono::steady_clock::now();
+    const bool solved = luSolve<TScalar, N, NBlock, K>(lu, pivots, rhs, result);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> solveSeconds = timerStop - timerStart;
+    if (!solved)
+    {
+        std::cout << "FATAL ERROR: parallel back substitution aborted unexpectedly" << std::endl;
+        return;
+    }
+
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = solveResidual(mat, rhs, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
+
+    std::cout << "Blocked LU with partial pivoting, N = " << N << ", NB = " << NB << ", K = " << K << ", solve p = " << N / NBlock << std::endl;
+    std::cout << "Factorization milliseconds: " << (int)(1000 * factorSeconds.count()) << std::endl;
+    std::cout << "Factorization GFLOP/s: " << 2.0 / 3.0 * N * N * N / factorSeconds.count() / 1e9 << std::endl;
+    std::cout << "Solve milliseconds: " << (int)(1000 * solveSeconds.count()) << std::endl;
+    std::cout << "Solve GFLOP/s: " << 2.0 * N * N * K / solveSeconds.count() / 1e9 << std::endl;
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+template <std::size_t N, std::size_t NB, std::size_t NBlock, std::size_t K>
+void calculateLU(VerificationMode verification)
+{
+    Matrix<float, N, N> mat;
+    Matrix<float, N, K> rhs;
+    generateLUInputs(mat, rhs);
+    computeLU<float, N, NB, NBlock, K>(mat, rhs, verification);
+}
+
+int main(int argc, char **argv)
+{
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+
+    calculateLU<1024, 32, 128, 102>(verification);
+    calculateLU<1024, 64, 128, 102>(verification);
+    calculateLU<1024, 128, 128, 102>(verification);
+
+    calculateLU<2048, 64, 256, 205>(verification);
+    calculateLU<2048, 128, 256, 205>(verification);
+
+    calculateLU<4096, 128, 512, 410>(verification);
+}
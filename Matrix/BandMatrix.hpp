@@ -0,0 +1,124 @@
+#ifndef BANDMATRIXHPP
+#define BANDMATRIXHPP
+
+#include <vector>
+#include <algorithm>
+
+#include "Matrix.hpp"
+
+/**
+ * @brief A symmetric N by N matrix with bandwidth B (A[i][j] = 0 for |i - j| > B), stored as its lower band in
+ * LAPACK's layout for uplo = 'L': a column-major (B + 1) by N array with A[j + d][j] at position j * (B + 1) + d.
+ *
+ * Each column of the band is contiguous, from the diagonal down; entries past the last row are padding. Storage is
+ * O(N * B) instead of O(N^2).
+ *
+ * All indices are zero-based.
+ *
+ * @tparam TScalar The scalar type (must support +, -, *)
+ * @tparam N Matrix size
+ * @tparam B Bandwidth: the number of nonzero diagonals below the main diagonal.
+ */
+template <typename TScalar, std::size_t N, std::size_t B>
+class SymmetricBandMatrix
+{
+private:
+    std::vector<TScalar> bands;
+
+public:
+    SymmetricBandMatrix() : bands((B + 1) * N, 0){};
+
+    /**
+     * @brief Copy the lower band of a dense symmetric matrix; entries outside the band are ignored.
+     */
+    explicit SymmetricBandMatrix(const Matrix<TScalar, N, N> &dense) : bands((B + 1) * N, 0)
+    {
+        for (std::size_t j = 0; j != N; ++j)
+        {
+            for (std::size_t i = j; i != std::min(j + B + 1, N); ++i)
+            {
+                bands[j * (B + 1) + i - j] = dense.rowData(i)[j];
+            }
+        }
+    };
+
+    /**
+     * @brief Return an entry of the matrix (zero outside the band); there is no bounds checking.
+     */
+    TScalar get(std::size_t i, std::size_t j) const
+    {
+        if (i < j)
+        {
+            std::swap(i, j);
+        }
+        return (i - j > B) ? (TScalar)0 : bands[j * (B + 1) + i - j];
+    };
+
+    /**
+     * @brief Set the entries (i, j) and (j, i), which must lie in the band; there is no bounds checking.
+     */
+    void set(std::size_t i, std::size_t j, TScalar value)
+    {
+        if (i < j)
+        {
+            std::swap(i, j);
+        }
+        bands[j * (B + 1) + i - j] = value;
+    };
+
+    /**
+     * @brief Pointer to the B + 1 contiguous band entries A[j][j], A[j + 1][j], ..., A[j + B][j] of column j.
+     */
+    TScalar *columnData(std::size_t j)
+    {
+        return bands.data() + j * (B + 1);
+    };
+
+    /**
+     * @brief Pointer to the B + 1 contiguous band entries A[j][j], A[j + 1][j], ..., A[j + B][j] of column j.
+     */
+    const TScalar *columnData(std::size_t j) const
+    {
+        return bands.data() + j * (B + 1);
+    };
+
+    /**
+     * @brief Return the dense symmetric matrix.
+     */
+    Matrix<TScalar, N, N> toDense() const
+    {
+        return Matrix<TScalar, N, N>([this](std::size_t rowIdx, std::size_t colIdx)
+                                     { return get(rowIdx, colIdx); });
+    };
+
+    /**
+     * @brief Multiply the current (symmetric) matrix from the right by a dense matrix and add the product to the
+     * result matrix, in O(N * B * NColsProduct).
+     */
+    template <std::size_t NColsProduct>
+    void multiplyRight(const Matrix<TScalar, N, NColsProduct> &other, Matrix<TScalar, N, NColsProduct> &result) const
+    {
+        for (std::size_t j = 0; j != N; ++j)
+        {
+            const TScalar *column = columnData(j);
+            const TScalar *otherRowJ = other.rowData(j);
+            TScalar *resultRowJ = result.rowData(j);
+            for (std::size_t n = 0; n != NColsProduct; ++n)
+            {
+                resultRowJ[n] += column[0] * otherRowJ[n];
+            }
+            for (std::size_t d = 1; d != std::min(B + 1, N - j); ++d)
+            {
+                const TScalar *otherRowI = other.rowData(j + d);
+                TScalar *resultRowI = result.rowData(j + d);
+                for (std::size_t n = 0; n != NColsProduct; ++n)
+                {
+                    resultRowI[n] += column[d] * otherRowJ[n];
+                    resultRowJ[n] += column[d] * otherRowI[n];
+                }
+            }
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef COLUMNSOLVEHPP
+#define COLUMNSOLVEHPP
+
+#include <vector>
+
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+
+/**
+ * @brief Solve for every column of B with solve(x) and write the solutions to X, where x holds one contiguous vector
+ * per right hand side, so the sweeps of a solver run over contiguous memory.
+ *
+ * With at least as many right hand sides as threads, the right hand sides are split across threads and each thread
+ * calls solve on its own columns (its kernels then run sequentially). With fewer, all of them go to one call on the
+ * calling thread, and solve may split its sweeps across threads itself (parallelForRange), so that a single right
+ * hand side does not run on a single core.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam N Number of unknowns
+ * @tparam K Number of right hand sides
+ * @param rhs The right hand sides B
+ * @param result The solutions X
+ * @param workPerColumn The approximate number of scalar operations to solve for one right hand side.
+ * @param solve Callable taking (std::vector<std::vector<TScalar>> &x), x[n][i] = B(i, n) on entry and X(i, n) on exit.
+ */
+template <typename TScalar, std::size_t N, std::size_t K, typename TSolve>
+void solveContiguousColumns(const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result, std::size_t workPerColumn, TSolve solve)
+{
+    auto solveRange = [&rhs, &result, &solve](std::size_t begin, std::size_t end)
+    {
+        std::vector<std::vector<TScalar>> x(end - begin, std::vector<TScalar>(N));
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            for (std::size_t n = begin; n != end; ++n)
+            {
+                x[n - begin][i] = rhs.rowData(i)[n];
+            }
+        }
+        solve(x);
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            for (std::size_t n = begin; n != end; ++n)
+            {
+                result.rowData(i)[n] = x[n - begin][i];
+            }
+        }
+    };
+
+    if (K < parallelThreadCount(K * workPerColumn, 1))
+    {
+        solveRange(0, K);
+        return;
+    }
+    parallelForRange(K, workPerColumn, solveRange);
+}
+
+#endif
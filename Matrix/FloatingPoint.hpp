@@ -0,0 +1,52 @@
+#ifndef FLOATINGPOINTHPP
+#define FLOATINGPOINTHPP
+
+#include <cfenv>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief RAII guard that puts the current thread's floating-point environment into a fixed, reproducible state.
+ *
+ * Rounding is set to round-to-nearest and, on x86, flush-to-zero and denormals-are-zero are switched off, so a
+ * library or a previous job that changed them cannot change our results. The environment is per thread, so every
+ * worker thread of a deterministic solve must hold its own guard. The previous environment is restored on exit.
+ *
+ * Bitwise reproducibility also requires a fixed binary: compiler flags such as -ffast-math or a different
+ * -ffp-contract setting change the arithmetic itself.
+ */
+class DeterministicFloatingPointScope
+{
+private:
+    std::fenv_t previous;
+#if defined(__SSE__)
+    unsigned int previousCsr;
+#endif
+
+public:
+    DeterministicFloatingPointScope()
+    {
+        std::fegetenv(&previous);
+        std::fesetround(FE_TONEAREST);
+#if defined(__SSE__)
+        previousCsr = _mm_getcsr();
+        const unsigned int flushToZero = 0x8000;
+        const unsigned int denormalsAreZero = 0x0040;
+        _mm_setcsr(previousCsr & ~(flushToZero | denormalsAreZero));
+#endif
+    };
+
+    ~DeterministicFloatingPointScope()
+    {
+#if defined(__SSE__)
+        _mm_setcsr(previousCsr);
+#endif
+        std::fesetenv(&previous);
+    };
+
+    DeterministicFloatingPointScope(const DeterministicFloatingPointScope &) = delete;
+    DeterministicFloatingPointScope &operator=(const DeterministicFloatingPointScope &) = delete;
+};
+
+#endif
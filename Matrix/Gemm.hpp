@@ -0,0 +1,75 @@
+#ifndef GEMMHPP
+#define GEMMHPP
+
+#include <vector>
+#include <algorithm>
+#include "Parallel.hpp"
+
+/**
+ * @brief Tile sizes of gemmAccumulate: a gemmTileDepth by gemmTileCols block of B (512 KB of floats) stays in L2
+ * while the rows of A and C stream past it.
+ */
+constexpr std::size_t gemmTileCols = 512;
+constexpr std::size_t gemmTileDepth = 256;
+
+/**
+ * @brief C += A * B on row-of-rows storage, where A is m by k, B is k by n and C is m by n.
+ *
+ * Loop order is i-k-j inside (gemmTileDepth x gemmTileCols) tiles of B, with four rows of C updated per row of B
+ * loaded. Every entry of C still accumulates its k terms in increasing k order, so the result does not depend on
+ * the tiling or on the number of threads. Large products are split across threads by rows of C.
+ */
+template <typename TScalar>
+void gemmAccumulate(const std::vector<std::vector<TScalar>> &a, const std::vector<std::vector<TScalar>> &b, std::vector<std::vector<TScalar>> &c, std::size_t m, std::size_t k, std::size_t n)
+{
+    parallelForRange(m, k * n, [&a, &b, &c, k, n](std::size_t firstRow, std::size_t lastRow)
+                     {
+                         for (std::size_t firstCol = 0; firstCol < n; firstCol += gemmTileCols)
+                         {
+                             const std::size_t lastCol = std::min(firstCol + gemmTileCols, n);
+                             for (std::size_t firstK = 0; firstK < k; firstK += gemmTileDepth)
+                             {
+                                 const std::size_t lastK = std::min(firstK + gemmTileDepth, k);
+                                 const std::size_t lastBlockedRow = firstRow + (lastRow - firstRow) / 4 * 4;
+                                 std::size_t i = firstRow;
+                                 for (; i != lastBlockedRow; i += 4)
+                                 {
+                                     TScalar *c0 = c[i].data();
+                                     TScalar *c1 = c[i + 1].data();
+                                     TScalar *c2 = c[i + 2].data();
+                                     TScalar *c3 = c[i + 3].data();
+                                     for (std::size_t kk = firstK; kk != lastK; ++kk)
+                                     {
+                                         const TScalar a0 = a[i][kk];
+                                         const TScalar a1 = a[i + 1][kk];
+                                         const TScalar a2 = a[i + 2][kk];
+                                         const TScalar a3 = a[i + 3][kk];
+                                         const TScalar *bRow = b[kk].data();
+                                         for (std::size_t j = firstCol; j < lastCol; ++j)
+                                         {
+                                             c0[j] += a0 * bRow[j];
+                                             c1[j] += a1 * bRow[j];
+                                             c2[j] += a2 * bRow[j];
+                                             c3[j] += a3 * bRow[j];
+                                         }
+                                     }
+                                 }
+                                 for (; i != lastRow; ++i)
+                                 {
+                                     TScalar *cRow = c[i].data();
+                                     for (std::size_t kk = firstK; kk != lastK; ++kk)
+                                     {
+                                         const TScalar aik = a[i][kk];
+                                         const TScalar *bRow = b[kk].data();
+                                         for (std::size_t j = firstCol; j < lastCol; ++j)
+                                         {
+                                             cRow[j] += aik * bRow[j];
+                                         }
+                                     }
+                                 }
+                             }
+                         }
+                     });
+}
+
+#endif
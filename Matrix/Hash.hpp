@@ -0,0 +1,183 @@
+#ifndef HASHHPP
+#define HASHHPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "Matrix.hpp"
+
+/**
+ * @brief Streaming XXH64 (xxHash, 64-bit variant) of a sequence of byte ranges.
+ *
+ * Four independent accumulators consume 32 bytes per step, so the hash runs at several bytes per cycle without
+ * explicit SIMD. The result equals the reference XXH64 of the concatenated input on little-endian machines.
+ */
+class XXHash64
+{
+private:
+    static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+    static constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    std::uint64_t seed;
+    std::uint64_t lanes[4];
+    unsigned char buffer[32];
+    std::size_t buffered = 0;
+    std::uint64_t totalLength = 0;
+
+    static std::uint64_t rotateLeft(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    };
+
+    static std::uint64_t read64(const unsigned char *bytes)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    };
+
+    static std::uint32_t read32(const unsigned char *bytes)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    };
+
+    static std::uint64_t round(std::uint64_t accumulator, std::uint64_t input)
+    {
+        return rotateLeft(accumulator + input * prime2, 31) * prime1;
+    };
+
+    static std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t lane)
+    {
+        return (accumulator ^ round(0, lane)) * prime1 + prime4;
+    };
+
+    void consumeStripes(const unsigned char *bytes, std::size_t nStripes)
+    {
+        std::uint64_t lane0 = lanes[0];
+        std::uint64_t lane1 = lanes[1];
+        std::uint64_t lane2 = lanes[2];
+        std::uint64_t lane3 = lanes[3];
+        for (std::size_t stripe = 0; stripe != nStripes; ++stripe, bytes += 32)
+        {
+            lane0 = round(lane0, read64(bytes));
+            lane1 = round(lane1, read64(bytes + 8));
+            lane2 = round(lane2, read64(bytes + 16));
+            lane3 = round(lane3, read64(bytes + 24));
+        }
+        lanes[0] = lane0;
+        lanes[1] = lane1;
+        lanes[2] = lane2;
+        lanes[3] = lane3;
+    };
+
+public:
+    explicit XXHash64(std::uint64_t seed = 0) : seed(seed)
+    {
+        lanes[0] = seed + prime1 + prime2;
+        lanes[1] = seed + prime2;
+        lanes[2] = seed;
+        lanes[3] = seed - prime1;
+    };
+
+    void update(const void *data, std::size_t length)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        totalLength += length;
+        if (buffered != 0)
+        {
+            const std::size_t taken = std::min(length, 32 - buffered);
+            std::memcpy(buffer + buffered, bytes, taken);
+            buffered += taken;
+            bytes += taken;
+            length -= taken;
+            if (buffered != 32)
+            {
+                return;
+            }
+            consumeStripes(buffer, 1);
+            buffered = 0;
+        }
+        consumeStripes(bytes, length / 32);
+        bytes += length / 32 * 32;
+        buffered = length % 32;
+        std::memcpy(buffer, bytes, buffered);
+    };
+
+    /**
+     * @brief The hash of everything passed to update so far; more input may follow.
+     */
+    std::uint64_t digest() const
+    {
+        std::uint64_t hash;
+        if (totalLength >= 32)
+        {
+            hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+            for (std::uint64_t lane : lanes)
+            {
+                hash = mergeRound(hash, lane);
+            }
+        }
+        else
+        {
+            hash = seed + prime5;
+        }
+        hash += totalLength;
+
+        const unsigned char *bytes = buffer;
+        std::size_t remaining = buffered;
+        for (; remaining >= 8; remaining -= 8, bytes += 8)
+        {
+            hash = rotateLeft(hash ^ round(0, read64(bytes)), 27) * prime1 + prime4;
+        }
+        if (remaining >= 4)
+        {
+            hash = rotateLeft(hash ^ (read32(bytes) * prime1), 23) * prime2 + prime3;
+            remaining -= 4;
+            bytes += 4;
+        }
+        for (; remaining != 0; --remaining, ++bytes)
+        {
+            hash = rotateLeft(hash ^ (*bytes * prime5), 11) * prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+    };
+};
+
+/**
+ * @brief XXH64 of a byte range.
+ */
+inline std::uint64_t xxHash64(const void *data, std::size_t length, std::uint64_t seed = 0)
+{
+    XXHash64 state(seed);
+    state.update(data, length);
+    return state.digest();
+}
+
+/**
+ * @brief XXH64 of the entries of a matrix, row by row; two matrices of the same type with the same bits have the
+ * same fingerprint. The shape and the scalar type are not part of the hash (see FactorKey).
+ */
+template <typename TScalar, std::size_t NRows, std::size_t NCols>
+std::uint64_t matrixFingerprint(const Matrix<TScalar, NRows, NCols> &mat)
+{
+    XXHash64 state;
+    for (std::size_t i = 0; i != NRows; ++i)
+    {
+        state.update(mat.rowData(i), NCols * sizeof(TScalar));
+    }
+    return state.digest();
+}
+
+#endif
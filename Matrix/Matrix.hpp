@@ -4,6 +4,13 @@
 #include <vector>
 #include <functional>
 #include <cmath>
+#include <algorithm>
+#include <cstring>
+
+#include "Parallel.hpp"
+#include "Summation.hpp"
+#include "Transpose.hpp"
+#include "Gemm.hpp"
 
 /**
  * @brief A numerical matrix class with compile-time shape specified.
@@ -41,20 +48,56 @@ public:
         }
     };
 
+    /**
+     * @brief Return the transpose of the current matrix.
+     *
+     * The copy is done tile by tile (see transposeTileSize) so that the rows being read and the rows being written
+     * both stay in cache; large matrices are split across threads by tile columns of the current matrix.
+     */
     Matrix<TScalar, NCols, NRows> transpose() const
     {
         Matrix<TScalar, NCols, NRows> transpose(0);
         std::vector<std::vector<TScalar>> &transposeMat = transpose.mat;
-        for (std::size_t i = 0; i < NRows; ++i)
-        {
-            for (std::size_t j = 0; j < NCols; ++j)
-            {
-                transposeMat[j][i] = mat[i][j];
-            }
-        }
+        const std::size_t nTileCols = (NCols + transposeTileSize - 1) / transposeTileSize;
+        parallelForRange(nTileCols, transposeTileSize * NRows, [this, &transposeMat](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t colTile = begin; colTile != end; ++colTile)
+                             {
+                                 std::size_t firstCol = colTile * transposeTileSize;
+                                 std::size_t lastCol = std::min(firstCol + transposeTileSize, NCols);
+                                 for (std::size_t firstRow = 0; firstRow < NRows; firstRow += transposeTileSize)
+                                 {
+                                     std::size_t lastRow = std::min(firstRow + transposeTileSize, NRows);
+                                     transposeTile(mat, transposeMat, firstRow, lastRow, firstCol, lastCol);
+                                 }
+                             }
+                         });
         return transpose;
     };
 
+    /**
+     * @brief Transpose the current (square) matrix in place, without allocating a copy.
+     *
+     * Pairs of tiles mirrored across the diagonal are swapped; the tile rows of the upper triangle are dealt to
+     * threads cyclically so that each thread gets a similar share of the triangle.
+     */
+    void transposeInPlace()
+    {
+        static_assert(NRows == NCols, "transposeInPlace requires a square matrix");
+        const std::size_t nTiles = (NRows + transposeTileSize - 1) / transposeTileSize;
+        parallelForCyclic(nTiles, transposeTileSize * NRows / 2, [this, nTiles](std::size_t rowTile)
+                          {
+                              std::size_t firstRow = rowTile * transposeTileSize;
+                              std::size_t lastRow = std::min(firstRow + transposeTileSize, NRows);
+                              for (std::size_t colTile = rowTile; colTile != nTiles; ++colTile)
+                              {
+                                  std::size_t firstCol = colTile * transposeTileSize;
+                                  std::size_t lastCol = std::min(firstCol + transposeTileSize, NCols);
+                                  transposeTileInPlace(mat, firstRow, lastRow, firstCol, lastCol);
+                              }
+                          });
+    };
+
     void print() const
     {
         for (auto &row : mat)
@@ -67,6 +110,25 @@ public:
         }
     };
 
+    /**
+     * @brief Whether every entry of the current matrix has the same bit pattern as the corresponding entry of another.
+     * 
+     * Unlike ==, this tells apart +0 and -0 and treats identical NaNs as equal, which is what regression diffs need.
+     * 
+     * @param other Another matrix of the same shape.
+     */
+    bool bitwiseEquals(const Matrix<TScalar, NRows, NCols> &other) const
+    {
+        for (std::size_t i = 0; i != NRows; ++i)
+        {
+            if (std::memcmp(mat[i].data(), other.mat[i].data(), NCols * sizeof(TScalar)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
     /**
      * @brief Get an entry of the matrix; there is no bounds checking.
      * 
@@ -91,7 +153,38 @@ public:
     };
 
     /**
-     * @brief Add a scalar times another matrix to the current matrix.
+     * @brief Swap two rows in O(1) (the row storage is exchanged, not copied). There is no bounds checking.
+     * 
+     * @param i Row index: 0 <= i < NRows
+     * @param j Row index: 0 <= j < NRows
+     */
+    void swapRows(std::size_t i, std::size_t j)
+    {
+        mat[i].swap(mat[j]);
+    };
+
+    /**
+     * @brief Pointer to the NCols contiguous entries of a row, for kernels that work on raw rows. There is no bounds checking.
+     * 
+     * @param i Row index: 0 <= i < NRows
+     */
+    TScalar *rowData(std::size_t i)
+    {
+        return mat[i].data();
+    };
+
+    /**
+     * @brief Pointer to the NCols contiguous entries of a row, for kernels that work on raw rows. There is no bounds checking.
+     * 
+     * @param i Row index: 0 <= i < NRows
+     */
+    const TScalar *rowData(std::size_t i) const
+    {
+        return mat[i].data();
+    };
+
+    /**
+     * @brief Add a scalar times another matrix to the current matrix. Large matrices are split across threads by rows.
      * 
      * @param other Another matrix of the same shape.
      * @param scalar The scalar to multiply.
@@ -99,34 +192,45 @@ public:
     void add(const Matrix<TScalar, NRows, NCols> &other, TScalar scalar)
     {
         const std::vector<std::vector<TScalar>> &otherMat = other.mat;
-        for (std::size_t i = 0; i != NRows; ++i)
-        {
-            for (std::size_t j = 0; j != NCols; ++j)
-            {
-                mat[i][j] += scalar * otherMat[i][j];
-            }
-        }
+        parallelForRange(NRows, NCols, [this, &otherMat, scalar](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t i = begin; i != end; ++i)
+                             {
+                                 TScalar *row = mat[i].data();
+                                 const TScalar *otherRow = otherMat[i].data();
+                                 for (std::size_t j = 0; j != NCols; ++j)
+                                 {
+                                     row[j] += scalar * otherRow[j];
+                                 }
+                             }
+                         });
     };
 
     /**
-     * @brief Multiply the current matrix by a given scalar.
+     * @brief Multiply the current matrix by a given scalar. Large matrices are split across threads by rows.
      * 
      * @param scalar The scalar by which to multiply.
      */
     void multiplyScalar(TScalar scalar)
     {
-        for (auto &row : mat)
-        {
-            for (auto &entry : row)
-            {
-                entry *= scalar;
-            }
-        }
+        parallelForRange(NRows, NCols, [this, scalar](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t i = begin; i != end; ++i)
+                             {
+                                 TScalar *row = mat[i].data();
+                                 for (std::size_t j = 0; j != NCols; ++j)
+                                 {
+                                     row[j] *= scalar;
+                                 }
+                             }
+                         });
     };
 
     /**
      * @brief Multiply the current matrix from the right and add the product to the result matrix; the current matrix is unchanged.
      *
+     * Uses the tiled, multi-threaded kernel gemmAccumulate.
+     *
      * @tparam NColsProduct The number of columns of the product matrix.
      * @param other The other matrix
      * @param result The result matrix
@@ -134,23 +238,14 @@ public:
     template <std::size_t NColsProduct>
     void multiplyRight(const Matrix<TScalar, NCols, NColsProduct> &other, Matrix<TScalar, NRows, NColsProduct> &result) const
     {
-        const std::vector<std::vector<TScalar>> &otherMat = other.mat;
-        std::vector<std::vector<TScalar>> &resultMat = result.mat;
-        for (std::size_t i = 0; i != NRows; ++i)
-        {
-            for (std::size_t k = 0; k != NCols; ++k)
-            {
-                for (std::size_t j = 0; j != NColsProduct; ++j)
-                {
-                    resultMat[i][j] += mat[i][k] * otherMat[k][j];
-                }
-            }
-        }
+        gemmAccumulate(mat, other.mat, result.mat, NRows, NCols, NColsProduct);
     };
 
     /**
      * @brief Multiply the current matrix from the left and add the product to the result matrix; the current matrix is unchanged.
      *
+     * Uses the tiled, multi-threaded kernel gemmAccumulate.
+     *
      * @tparam NRowsProduct The number of rows of the product matrix.
      * @param other The other matrix
      * @param result The result matrix
@@ -158,18 +253,7 @@ public:
     template <std::size_t NRowsProduct>
     void multiplyLeft(const Matrix<TScalar, NRowsProduct, NRows> &other, Matrix<TScalar, NRowsProduct, NCols> &result) const
     {
-        const std::vector<std::vector<TScalar>> &otherMat = other.mat;
-        std::vector<std::vector<TScalar>> &resultMat = result.mat;
-        for (std::size_t i = 0; i != NRowsProduct; ++i)
-        {
-            for (std::size_t k = 0; k != NRows; ++k)
-            {
-                for (std::size_t j = 0; j != NCols; ++j)
-                {
-                    resultMat[i][j] += otherMat[i][k] * mat[k][j];
-                }
-            }
-        }
+        gemmAccumulate(other.mat, mat, result.mat, NRowsProduct, NRows, NCols);
     };
 
     /**
@@ -332,51 +416,65 @@ public:
     /**
      * @brief Return a quantity proportional to the Frobenius norm (element-wise 2-norm) of the current matrix.
      * 
+     * Each row is summed with compensated summation and the row sums are combined pairwise, so the result does not
+     * depend on how many threads were used.
+     * 
      * @return TScalar The computed norm.
      */
     TScalar frobNorm() const
     {
-        TScalar sum = 0;
-        for (std::size_t i = 0; i != NRows; ++i)
-        {
-            for (std::size_t j = 0; j != NCols; ++j)
-            {
-                TScalar elem = mat[i][j];
-                sum += elem * elem / (NRows * NCols);
-            }
-        }
-
-        return std::sqrt(std::abs(sum));
+        std::vector<TScalar> rowSums = reduceRows([](TScalar elem)
+                                                  { return elem * elem; });
+        TScalar sum = pairwiseSum(rowSums.data(), NRows);
+        return std::sqrt(std::abs(sum / (NRows * NCols)));
     };
 
     /**
      * @brief Compute the biased sample variance of the entries of the current matrix
      * 
+     * Uses the same reproducible two-level summation as frobNorm.
+     * 
      * @return The sample variance
      */
     TScalar sample_dev() const
     {
-        TScalar mean = 0;
-        for (std::size_t i = 0; i != NRows; ++i)
-        {
-            for (std::size_t j = 0; j != NCols; ++j)
-            {
-                mean += mat[i][j] / (NRows * NCols);
-            }
-        }
+        std::vector<TScalar> rowSums = reduceRows([](TScalar elem)
+                                                  { return elem; });
+        TScalar mean = pairwiseSum(rowSums.data(), NRows) / (NRows * NCols);
 
-        TScalar variance = 0;
-        for (std::size_t i = 0; i != NRows; ++i)
-        {
-            for (std::size_t j = 0; j != NCols; ++j)
-            {
-                TScalar diff = mat[i][j] - mean;
-                variance += diff * diff / (NRows * NCols);
-            }
-        }
+        rowSums = reduceRows([mean](TScalar elem)
+                             {
+                                 TScalar diff = elem - mean;
+                                 return diff * diff;
+                             });
+        TScalar variance = pairwiseSum(rowSums.data(), NRows) / (NRows * NCols);
 
         return std::sqrt(std::abs(variance));
     };
+
+private:
+    /**
+     * @brief Return, for every row, the compensated sum of fun(entry) over the row. Rows are split across threads.
+     */
+    template <typename TFunction>
+    std::vector<TScalar> reduceRows(TFunction fun) const
+    {
+        std::vector<TScalar> rowSums(NRows);
+        parallelForRange(NRows, NCols, [this, &rowSums, &fun](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t i = begin; i != end; ++i)
+                             {
+                                 const TScalar *row = mat[i].data();
+                                 KahanSum<TScalar> sum;
+                                 for (std::size_t j = 0; j != NCols; ++j)
+                                 {
+                                     sum.add(fun(row[j]));
+                                 }
+                                 rowSums[i] = sum.sum;
+                             }
+                         });
+        return rowSums;
+    };
 };
 
 #endif
\ No newline at end of file
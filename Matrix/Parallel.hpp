@@ -0,0 +1,137 @@
+#ifndef PARALLELHPP
+#define PARALLELHPP
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Kernels with fewer scalar operations than this run on the calling thread.
+ */
+constexpr std::size_t parallelThreshold = std::size_t(1) << 16;
+
+/**
+ * @brief Whether the current thread is already a worker of a parallel kernel (or asked to stay sequential).
+ */
+inline bool &sequentialKernelsOnly()
+{
+    thread_local bool sequentialOnly = false;
+    return sequentialOnly;
+}
+
+/**
+ * @brief RAII guard that makes Matrix kernels run sequentially on the current thread.
+ *
+ * Solver worker threads hold one of these so that their kernels do not spawn threads of their own.
+ */
+class SequentialKernelsGuard
+{
+private:
+    bool previous;
+
+public:
+    SequentialKernelsGuard() : previous(sequentialKernelsOnly())
+    {
+        sequentialKernelsOnly() = true;
+    };
+
+    ~SequentialKernelsGuard()
+    {
+        sequentialKernelsOnly() = previous;
+    };
+
+    SequentialKernelsGuard(const SequentialKernelsGuard &) = delete;
+    SequentialKernelsGuard &operator=(const SequentialKernelsGuard &) = delete;
+};
+
+/**
+ * @brief The number of threads a parallel kernel may use for the given amount of work.
+ *
+ * @param count The number of work items.
+ * @param workPerItem The approximate number of scalar operations per item.
+ */
+inline std::size_t parallelThreadCount(std::size_t count, std::size_t workPerItem)
+{
+    if (sequentialKernelsOnly() || count * workPerItem < parallelThreshold)
+    {
+        return 1;
+    }
+    std::size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min(count, hardwareThreads));
+}
+
+/**
+ * @brief Split [0, count) into contiguous chunks and call fun(begin, end) on each chunk, one chunk per thread.
+ *
+ * Small problems (see parallelThreshold) run on the calling thread as a single chunk.
+ *
+ * @param count The number of work items.
+ * @param workPerItem The approximate number of scalar operations per item.
+ * @param fun Callable taking (std::size_t begin, std::size_t end).
+ */
+template <typename TFunction>
+void parallelForRange(std::size_t count, std::size_t workPerItem, TFunction fun)
+{
+    const std::size_t nThreads = parallelThreadCount(count, workPerItem);
+    if (nThreads == 1)
+    {
+        fun(std::size_t(0), count);
+        return;
+    }
+
+    std::vector<std::thread> threads{};
+    for (std::size_t t = 1; t != nThreads; ++t)
+    {
+        std::size_t begin = count * t / nThreads;
+        std::size_t end = count * (t + 1) / nThreads;
+        threads.push_back(std::thread([&fun, begin, end]()
+                                      {
+                                          SequentialKernelsGuard guard;
+                                          fun(begin, end);
+                                      }));
+    }
+    {
+        SequentialKernelsGuard guard;
+        fun(std::size_t(0), count / nThreads);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Call fun(i) for every i in [0, count), dealing the indices to threads cyclically (i mod p).
+ *
+ * Useful when the cost of item i varies with i, e.g. over the tiles of a triangle.
+ *
+ * @param count The number of work items.
+ * @param workPerItem The approximate number of scalar operations per item.
+ * @param fun Callable taking (std::size_t i).
+ */
+template <typename TFunction>
+void parallelForCyclic(std::size_t count, std::size_t workPerItem, TFunction fun)
+{
+    const std::size_t nThreads = parallelThreadCount(count, workPerItem);
+    auto work = [&fun, count, nThreads](std::size_t first)
+    {
+        SequentialKernelsGuard guard;
+        for (std::size_t i = first; i < count; i += nThreads)
+        {
+            fun(i);
+        }
+    };
+
+    std::vector<std::thread> threads{};
+    for (std::size_t t = 1; t < nThreads; ++t)
+    {
+        threads.push_back(std::thread(work, t));
+    }
+    work(0);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef PERFCOUNTERSHPP
+#define PERFCOUNTERSHPP
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief The hardware events recorded per region and per thread.
+ */
+enum class PerfEvent
+{
+    Cycles,
+    Instructions,
+    LlcMisses,
+    DtlbMisses
+};
+
+constexpr std::size_t perfEventCount = 4;
+
+/**
+ * @brief Bytes transferred per last-level cache miss, for the bytes-per-flop estimate.
+ */
+constexpr double perfCacheLineBytes = 64;
+
+/**
+ * @brief Whether the drivers should collect hardware counters, i.e. whether PERF_COUNTERS is set to something other
+ * than 0 in the environment.
+ */
+inline bool perfCountersRequested()
+{
+    const char *value = std::getenv("PERF_COUNTERS");
+    return value != nullptr && std::string(value) != "" && std::string(value) != "0";
+}
+
+/**
+ * @brief Counter values of one region or thread. An event that could not be counted is marked unavailable, and
+ * unavailableReason says why.
+ */
+struct PerfCounts
+{
+    bool requested = false;
+    std::array<bool, perfEventCount> available{};
+    std::array<std::uint64_t, perfEventCount> values{};
+    std::string unavailableReason{};
+
+    bool has(PerfEvent event) const
+    {
+        return available[(std::size_t)event];
+    };
+
+    std::uint64_t get(PerfEvent event) const
+    {
+        return values[(std::size_t)event];
+    };
+
+    /**
+     * @brief Instructions per cycle, or 0 if either event is unavailable.
+     */
+    double ipc() const
+    {
+        if (!has(PerfEvent::Cycles) || !has(PerfEvent::Instructions) || get(PerfEvent::Cycles) == 0)
+        {
+            return 0;
+        }
+        return (double)get(PerfEvent::Instructions) / get(PerfEvent::Cycles);
+    };
+};
+
+/**
+ * @brief Counts cycles, instructions, last-level cache misses and data TLB misses of the calling thread from
+ * construction on, through perf_event_open; user space only, so it works with kernel.perf_event_paranoid up to 2.
+ *
+ * Nothing fails hard: an event the kernel refuses (no permission, no PMU in a virtual machine, not Linux) is just
+ * reported as unavailable. Events that had to share the PMU are scaled by the fraction of time they were counted.
+ * There is no generic event for floating-point operations, so the flop count comes from the algorithm instead (see
+ * printPerfCounts).
+ */
+class PerfCounters
+{
+private:
+    std::array<int, perfEventCount> fds;
+    PerfCounts opened{};
+
+#if defined(__linux__)
+    static bool eventConfig(PerfEvent event, perf_event_attr &attr)
+    {
+        const std::uint64_t readMiss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+        switch (event)
+        {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            return true;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            return true;
+        case PerfEvent::LlcMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            return true;
+        case PerfEvent::DtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss;
+            return true;
+        }
+        return false;
+    };
+
+    static std::string failureReason(int error)
+    {
+        if (error == EACCES || error == EPERM)
+        {
+            std::string paranoid = "?";
+            std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+            file >> paranoid;
+            return "permission denied (kernel.perf_event_paranoid = " + paranoid + ")";
+        }
+        if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV)
+        {
+            return "event not supported by this CPU or hypervisor";
+        }
+        return std::strerror(error);
+    };
+#endif
+
+public:
+    /**
+     * @param enabled Whether to count at all (usually perfCountersRequested()); if false, nothing is opened.
+     * @param inheritThreads Whether to also count the threads started by the calling thread while counting. Their
+     * counts are added when they exit, so read after joining them.
+     */
+    PerfCounters(bool enabled, bool inheritThreads)
+    {
+        fds.fill(-1);
+        opened.requested = enabled;
+        if (!enabled)
+        {
+            return;
+        }
+#if defined(__linux__)
+        for (std::size_t e = 0; e != perfEventCount; ++e)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            eventConfig((PerfEvent)e, attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = inheritThreads ? 1 : 0;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds[e] < 0 && opened.unavailableReason.empty())
+            {
+                opened.unavailableReason = std::string("perf_event_open: ") + failureReason(errno);
+            }
+            opened.available[e] = (fds[e] >= 0);
+        }
+        for (int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#else
+        opened.unavailableReason = "perf_event_open is only available on Linux";
+#endif
+    };
+
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+        for (int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+#endif
+    };
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+     * @brief The counts since construction; counting goes on.
+     */
+    PerfCounts read() const
+    {
+        PerfCounts counts = opened;
+#if defined(__linux__)
+        for (std::size_t e = 0; e != perfEventCount; ++e)
+        {
+            std::uint64_t data[3] = {0, 0, 0};
+            if (fds[e] < 0 || ::read(fds[e], data, sizeof(data)) != (ssize_t)sizeof(data))
+            {
+                counts.available[e] = false;
+                continue;
+            }
+            const double scale = (data[2] != 0 && data[2] < data[1]) ? (double)data[1] / data[2] : 1.0;
+            counts.values[e] = (std::uint64_t)(data[0] * scale);
+        }
+#endif
+        return counts;
+    };
+};
+
+/**
+ * @brief Print IPC, last-level cache and TLB misses and the bytes moved per flop (LLC misses * 64 B / flops) of a
+ * region, or why they are unavailable; prints nothing if counters were not requested.
+ *
+ * @param flops The number of floating-point operations of the region, as counted for its GFLOP/s.
+ */
+inline void printPerfCounts(const PerfCounts &counts, double flops)
+{
+    if (!counts.requested)
+    {
+        return;
+    }
+    if (counts.has(PerfEvent::Cycles) && counts.has(PerfEvent::Instructions))
+    {
+        std::cout << "IPC: " << counts.ipc() << " (" << counts.get(PerfEvent::Instructions) << " instructions, "
+                  << counts.get(PerfEvent::Cycles) << " cycles)" << std::endl;
+    }
+    if (counts.has(PerfEvent::LlcMisses))
+    {
+        const double misses = (double)counts.get(PerfEvent::LlcMisses);
+        std::cout << "LLC misses: " << counts.get(PerfEvent::LlcMisses) << ", bytes per flop: " << misses * perfCacheLineBytes / flops << std::endl;
+    }
+    if (counts.has(PerfEvent::DtlbMisses))
+    {
+        std::cout << "dTLB misses: " << counts.get(PerfEvent::DtlbMisses) << std::endl;
+    }
+    if (!counts.unavailableReason.empty())
+    {
+        std::cout << "Performance counters unavailable: " << counts.unavailableReason << std::endl;
+    }
+}
+
+#endif
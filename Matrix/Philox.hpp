@@ -0,0 +1,81 @@
+#ifndef PHILOXHPP
+#define PHILOXHPP
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+
+/**
+ * @brief The Philox4x32-10 counter-based random number generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011).
+ *
+ * There is no state to advance: the output is a pure function of a 128-bit counter and a 64-bit key. Giving every
+ * matrix entry its own counter makes generated matrices independent of the order (and the number of threads) in
+ * which entries are produced.
+ */
+struct Philox4x32
+{
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+    static Counter generate(Counter counter, Key key)
+    {
+        for (std::size_t round = 0; round != 10; ++round)
+        {
+            if (round != 0)
+            {
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            const std::uint64_t product0 = std::uint64_t(0xD2511F53) * counter[0];
+            const std::uint64_t product1 = std::uint64_t(0xCD9E8D57) * counter[2];
+            counter = {std::uint32_t(product1 >> 32) ^ counter[1] ^ key[0], std::uint32_t(product1),
+                       std::uint32_t(product0 >> 32) ^ counter[3] ^ key[1], std::uint32_t(product0)};
+        }
+        return counter;
+    };
+};
+
+/**
+ * @brief Random scalars addressed by (stream, index) on top of Philox4x32-10.
+ *
+ * The seed is the key; the stream and the 64-bit index form the counter. Use a different stream for every matrix
+ * generated from the same seed, and the linear entry index as the index.
+ */
+class CounterRng
+{
+private:
+    Philox4x32::Key key;
+
+    static double toOpenUnitInterval(std::uint32_t bits)
+    {
+        return (bits + 0.5) * (1.0 / 4294967296.0);
+    };
+
+public:
+    CounterRng(std::uint64_t seed) : key{std::uint32_t(seed), std::uint32_t(seed >> 32)} {};
+
+    Philox4x32::Counter bits(std::uint32_t stream, std::uint64_t index) const
+    {
+        return Philox4x32::generate({std::uint32_t(index), std::uint32_t(index >> 32), stream, 0}, key);
+    };
+
+    /**
+     * @brief A uniform sample from the open interval (0, 1).
+     */
+    double uniform(std::uint32_t stream, std::uint64_t index) const
+    {
+        return toOpenUnitInterval(bits(stream, index)[0]);
+    };
+
+    /**
+     * @brief A standard normal sample (Box-Muller on two words of the same counter).
+     */
+    double normal(std::uint32_t stream, std::uint64_t index) const
+    {
+        const Philox4x32::Counter words = bits(stream, index);
+        const double radius = std::sqrt(-2.0 * std::log(toOpenUnitInterval(words[0])));
+        return radius * std::cos(6.283185307179586 * toOpenUnitInterval(words[1]));
+    };
+};
+
+#endif
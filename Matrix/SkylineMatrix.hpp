@@ -0,0 +1,140 @@
+#ifndef SKYLINEMATRIXHPP
+#define SKYLINEMATRIXHPP
+
+#include <vector>
+#include <algorithm>
+
+#include "Matrix.hpp"
+
+/**
+ * @brief A symmetric N by N matrix in skyline (profile, or variable-band) storage: row i of the lower triangle is
+ * stored contiguously from its first column firstColumn(i) to the diagonal, and everything left of it is zero.
+ *
+ * Unlike SymmetricBandMatrix, every row has its own bandwidth, so a few wide rows do not cost storage or work on
+ * all the others. A Cholesky factor has the same profile as the matrix, so it can overwrite it.
+ *
+ * All indices are zero-based.
+ *
+ * @tparam TScalar The scalar type (must support +, -, *)
+ * @tparam N Matrix size
+ */
+template <typename TScalar, std::size_t N>
+class SkylineMatrix
+{
+private:
+    std::vector<std::size_t> firstColumns;
+    std::vector<std::size_t> rowPointers;
+    std::vector<TScalar> entries;
+
+public:
+    /**
+     * @brief An all-zero matrix with the given profile.
+     *
+     * @param firstColumns The first stored column of every row; firstColumns[i] <= i.
+     */
+    explicit SkylineMatrix(std::vector<std::size_t> firstColumns) : firstColumns(std::move(firstColumns)), rowPointers(N + 1, 0)
+    {
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            rowPointers[i + 1] = rowPointers[i] + i - this->firstColumns[i] + 1;
+        }
+        entries.assign(rowPointers[N], 0);
+    };
+
+    /**
+     * @brief The first stored column of row i.
+     */
+    std::size_t firstColumn(std::size_t i) const
+    {
+        return firstColumns[i];
+    };
+
+    /**
+     * @brief The number of stored entries (the profile of the lower triangle, diagonal included).
+     */
+    std::size_t profileSize() const
+    {
+        return entries.size();
+    };
+
+    /**
+     * @brief Pointer to the contiguous entries A[i][firstColumn(i)], ..., A[i][i] of row i.
+     */
+    TScalar *rowData(std::size_t i)
+    {
+        return entries.data() + rowPointers[i];
+    };
+
+    /**
+     * @brief Pointer to the contiguous entries A[i][firstColumn(i)], ..., A[i][i] of row i.
+     */
+    const TScalar *rowData(std::size_t i) const
+    {
+        return entries.data() + rowPointers[i];
+    };
+
+    /**
+     * @brief Return an entry of the matrix (zero outside the profile); there is no bounds checking.
+     */
+    TScalar get(std::size_t i, std::size_t j) const
+    {
+        if (i < j)
+        {
+            std::swap(i, j);
+        }
+        return (j < firstColumns[i]) ? (TScalar)0 : rowData(i)[j - firstColumns[i]];
+    };
+
+    /**
+     * @brief Set the entries (i, j) and (j, i), which must lie in the profile; there is no bounds checking.
+     */
+    void set(std::size_t i, std::size_t j, TScalar value)
+    {
+        if (i < j)
+        {
+            std::swap(i, j);
+        }
+        rowData(i)[j - firstColumns[i]] = value;
+    };
+
+    /**
+     * @brief Return the dense symmetric matrix.
+     */
+    Matrix<TScalar, N, N> toDense() const
+    {
+        return Matrix<TScalar, N, N>([this](std::size_t rowIdx, std::size_t colIdx)
+                                     { return get(rowIdx, colIdx); });
+    };
+
+    /**
+     * @brief Multiply the current (symmetric) matrix from the right by a dense matrix and add the product to the
+     * result matrix, in O(profileSize() * NColsProduct).
+     */
+    template <std::size_t NColsProduct>
+    void multiplyRight(const Matrix<TScalar, N, NColsProduct> &other, Matrix<TScalar, N, NColsProduct> &result) const
+    {
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            const TScalar *row = rowData(i);
+            const TScalar *otherRowI = other.rowData(i);
+            TScalar *resultRowI = result.rowData(i);
+            for (std::size_t j = firstColumns[i]; j != i; ++j)
+            {
+                const TScalar value = row[j - firstColumns[i]];
+                const TScalar *otherRowJ = other.rowData(j);
+                TScalar *resultRowJ = result.rowData(j);
+                for (std::size_t n = 0; n != NColsProduct; ++n)
+                {
+                    resultRowI[n] += value * otherRowJ[n];
+                    resultRowJ[n] += value * otherRowI[n];
+                }
+            }
+            for (std::size_t n = 0; n != NColsProduct; ++n)
+            {
+                resultRowI[n] += row[i - firstColumns[i]] * otherRowI[n];
+            }
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef SOLVECONTROLHPP
+#define SOLVECONTROLHPP
+
+#include <atomic>
+
+/**
+ * @brief Progress and cancellation shared between a running solver and the thread that submitted it.
+ *
+ * The solver announces its total number of steps (e.g. columns of a factor), advances as steps are published, and
+ * checks cancelled() wherever a worker would otherwise wait or start new work. Cancellation is cooperative: workers
+ * return at their next check, and the solver reports that it did not finish.
+ */
+class SolveControl
+{
+private:
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<std::size_t> stepsDone{0};
+    std::atomic<std::size_t> stepsTotal{0};
+
+public:
+    /**
+     * @brief Ask the solver to stop at its next check; may be called from any thread.
+     */
+    void cancel()
+    {
+        cancelRequested.store(true, std::memory_order_relaxed);
+    };
+
+    bool cancelled() const
+    {
+        return cancelRequested.load(std::memory_order_relaxed);
+    };
+
+    /**
+     * @brief Called by the solver once it knows how many steps it will take.
+     */
+    void start(std::size_t totalSteps)
+    {
+        stepsDone.store(0, std::memory_order_relaxed);
+        stepsTotal.store(totalSteps, std::memory_order_relaxed);
+    };
+
+    void advance(std::size_t steps = 1)
+    {
+        stepsDone.fetch_add(steps, std::memory_order_relaxed);
+    };
+
+    /**
+     * @brief The fraction of steps done, in [0, 1]; 0 before the solver started.
+     */
+    double progress() const
+    {
+        const std::size_t total = stepsTotal.load(std::memory_order_relaxed);
+        return (total == 0) ? 0.0 : (double)stepsDone.load(std::memory_order_relaxed) / total;
+    };
+};
+
+#endif
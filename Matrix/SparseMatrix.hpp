@@ -0,0 +1,227 @@
+#ifndef SPARSEMATRIXHPP
+#define SPARSEMATRIXHPP
+
+#include <vector>
+#include <algorithm>
+
+#include "Matrix.hpp"
+
+/**
+ * @brief The compressed dimension of a SparseMatrix: Csr stores the entries row by row, Csc column by column.
+ */
+enum class SparseLayout
+{
+    Csr,
+    Csc
+};
+
+/**
+ * @brief A sparse matrix in compressed sparse row (CSR) or compressed sparse column (CSC) form, with compile-time
+ * shape specified.
+ *
+ * Along the major dimension (rows for CSR, columns for CSC), the entries of major index i are
+ * values()[pointers()[i]] to values()[pointers()[i + 1] - 1], and indices() holds their minor indices in increasing
+ * order. Only the values can be changed after construction; the structure is fixed, so analyses of it (see
+ * SparseTriangularSolver) stay valid.
+ *
+ * All indices are zero-based.
+ *
+ * @tparam TScalar The scalar type (must support +, -, *)
+ * @tparam NRows The number of rows
+ * @tparam NCols The number of columns
+ * @tparam Layout Csr or Csc
+ */
+template <typename TScalar, std::size_t NRows, std::size_t NCols, SparseLayout Layout = SparseLayout::Csr>
+class SparseMatrix
+{
+    template <typename TScalarOther, std::size_t NRowsOther, std::size_t NColsOther, SparseLayout LayoutOther>
+    friend class SparseMatrix;
+
+private:
+    static constexpr std::size_t NMajor = (Layout == SparseLayout::Csr) ? NRows : NCols;
+    static constexpr std::size_t NMinor = (Layout == SparseLayout::Csr) ? NCols : NRows;
+
+    std::vector<std::size_t> majorPointers;
+    std::vector<std::size_t> minorIndices{};
+    std::vector<TScalar> entries{};
+
+public:
+    /**
+     * @brief An all-zero matrix (no stored entries).
+     */
+    SparseMatrix() : majorPointers(NMajor + 1, 0){};
+
+    /**
+     * @brief Compress a dense matrix, keeping its nonzero entries.
+     */
+    explicit SparseMatrix(const Matrix<TScalar, NRows, NCols> &dense) : majorPointers(NMajor + 1, 0)
+    {
+        for (std::size_t i = 0; i != NMajor; ++i)
+        {
+            for (std::size_t j = 0; j != NMinor; ++j)
+            {
+                const TScalar value = (Layout == SparseLayout::Csr) ? dense.rowData(i)[j] : dense.rowData(j)[i];
+                if (value != 0)
+                {
+                    minorIndices.push_back(j);
+                    entries.push_back(value);
+                }
+            }
+            majorPointers[i + 1] = entries.size();
+        }
+    };
+
+    /**
+     * @brief Take the compressed arrays as they are; minor indices must be increasing within every major index.
+     */
+    SparseMatrix(std::vector<std::size_t> pointers, std::vector<std::size_t> indices, std::vector<TScalar> values) : majorPointers(std::move(pointers)), minorIndices(std::move(indices)), entries(std::move(values)){};
+
+    const std::vector<std::size_t> &pointers() const
+    {
+        return majorPointers;
+    };
+
+    const std::vector<std::size_t> &indices() const
+    {
+        return minorIndices;
+    };
+
+    const std::vector<TScalar> &values() const
+    {
+        return entries;
+    };
+
+    /**
+     * @brief The stored values, which may be changed in place without changing the structure.
+     */
+    std::vector<TScalar> &values()
+    {
+        return entries;
+    };
+
+    /**
+     * @brief The number of stored entries.
+     */
+    std::size_t nonZeros() const
+    {
+        return entries.size();
+    };
+
+    /**
+     * @brief Whether other stores entries at exactly the same positions.
+     */
+    bool sameStructure(const SparseMatrix<TScalar, NRows, NCols, Layout> &other) const
+    {
+        return majorPointers == other.majorPointers && minorIndices == other.minorIndices;
+    };
+
+    /**
+     * @brief Return the dense matrix.
+     */
+    Matrix<TScalar, NRows, NCols> toDense() const
+    {
+        Matrix<TScalar, NRows, NCols> dense(0);
+        for (std::size_t i = 0; i != NMajor; ++i)
+        {
+            for (std::size_t k = majorPointers[i]; k != majorPointers[i + 1]; ++k)
+            {
+                if (Layout == SparseLayout::Csr)
+                {
+                    dense.rowData(i)[minorIndices[k]] = entries[k];
+                }
+                else
+                {
+                    dense.rowData(minorIndices[k])[i] = entries[k];
+                }
+            }
+        }
+        return dense;
+    };
+
+    /**
+     * @brief Return the same matrix in the other layout (CSR to CSC or CSC to CSR), in O(nonZeros + NRows + NCols).
+     *
+     * Entries are bucketed by minor index with a counting sort; visiting the major indices in order keeps the new
+     * minor indices sorted.
+     */
+    template <SparseLayout OtherLayout = (Layout == SparseLayout::Csr ? SparseLayout::Csc : SparseLayout::Csr)>
+    SparseMatrix<TScalar, NRows, NCols, OtherLayout> convert() const
+    {
+        if (OtherLayout == Layout)
+        {
+            return SparseMatrix<TScalar, NRows, NCols, OtherLayout>(majorPointers, minorIndices, entries);
+        }
+        std::vector<std::size_t> pointers(NMinor + 1, 0);
+        for (std::size_t j : minorIndices)
+        {
+            ++pointers[j + 1];
+        }
+        for (std::size_t j = 0; j != NMinor; ++j)
+        {
+            pointers[j + 1] += pointers[j];
+        }
+        std::vector<std::size_t> next(pointers.begin(), pointers.end() - 1);
+        std::vector<std::size_t> indices(entries.size());
+        std::vector<TScalar> values(entries.size());
+        for (std::size_t i = 0; i != NMajor; ++i)
+        {
+            for (std::size_t k = majorPointers[i]; k != majorPointers[i + 1]; ++k)
+            {
+                const std::size_t position = next[minorIndices[k]]++;
+                indices[position] = i;
+                values[position] = entries[k];
+            }
+        }
+        return SparseMatrix<TScalar, NRows, NCols, OtherLayout>(std::move(pointers), std::move(indices), std::move(values));
+    };
+
+    /**
+     * @brief Multiply the current matrix from the right by a dense matrix and add the product to the result matrix.
+     *
+     * In CSR layout rows of the result are split across threads; in CSC layout the columns are scattered
+     * sequentially.
+     *
+     * @tparam NColsProduct The number of columns of the product matrix.
+     * @param other The other matrix
+     * @param result The result matrix
+     */
+    template <std::size_t NColsProduct>
+    void multiplyRight(const Matrix<TScalar, NCols, NColsProduct> &other, Matrix<TScalar, NRows, NColsProduct> &result) const
+    {
+        if (Layout == SparseLayout::Csr)
+        {
+            parallelForRange(NRows, NColsProduct * (entries.size() / NRows + 1), [this, &other, &result](std::size_t begin, std::size_t end)
+                             {
+                                 for (std::size_t i = begin; i != end; ++i)
+                                 {
+                                     TScalar *resultRow = result.rowData(i);
+                                     for (std::size_t k = majorPointers[i]; k != majorPointers[i + 1]; ++k)
+                                     {
+                                         const TScalar value = entries[k];
+                                         const TScalar *otherRow = other.rowData(minorIndices[k]);
+                                         for (std::size_t j = 0; j != NColsProduct; ++j)
+                                         {
+                                             resultRow[j] += value * otherRow[j];
+                                         }
+                                     }
+                                 }
+                             });
+            return;
+        }
+        for (std::size_t col = 0; col != NCols; ++col)
+        {
+            const TScalar *otherRow = other.rowData(col);
+            for (std::size_t k = majorPointers[col]; k != majorPointers[col + 1]; ++k)
+            {
+                const TScalar value = entries[k];
+                TScalar *resultRow = result.rowData(minorIndices[k]);
+                for (std::size_t j = 0; j != NColsProduct; ++j)
+                {
+                    resultRow[j] += value * otherRow[j];
+                }
+            }
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef STRASSENHPP
+#define STRASSENHPP
+
+#include <future>
+#include <thread>
+#include "Matrix.hpp"
+
+/**
+ * @brief The algorithm used for large square products.
+ */
+enum class GemmAlgorithm
+{
+    Classical,
+    StrassenWinograd
+};
+
+/**
+ * @brief Recursion always stops at or below this size, whatever the runtime cutoff.
+ */
+constexpr std::size_t strassenMinimumSize = 64;
+
+/**
+ * @brief Default runtime cutoff: blocks of this size or smaller use the classical kernel. See Matrix/benchmark.
+ */
+constexpr std::size_t defaultStrassenCutoff = 512;
+
+/**
+ * @brief Default number of recursion levels whose seven sub-products run as parallel tasks (7 tasks per level).
+ */
+constexpr std::size_t defaultStrassenTaskDepth = 1;
+
+template <typename TScalar, std::size_t N>
+void strassenProduct(const Matrix<TScalar, N, N> &a, const Matrix<TScalar, N, N> &b, Matrix<TScalar, N, N> &c, std::size_t cutoff, std::size_t taskDepth);
+
+/**
+ * @brief Computes c = a * b (c must be zero on entry) for matrices too small or of odd size to split.
+ */
+template <typename TScalar, std::size_t N, bool Splittable = (N % 2 == 0 && N > strassenMinimumSize)>
+struct StrassenStep
+{
+    static void product(const Matrix<TScalar, N, N> &a, const Matrix<TScalar, N, N> &b, Matrix<TScalar, N, N> &c, std::size_t cutoff, std::size_t taskDepth)
+    {
+        a.multiplyRight(b, c);
+    };
+};
+
+/**
+ * @brief One level of the Strassen-Winograd recursion (7 half-size products, 15 additions).
+ *
+ * With A, B and C split into 2 by 2 blocks:
+ *
+ * S1 = A21 + A22, S2 = S1 - A11, S3 = A11 - A21, S4 = A12 - S2
+ * T1 = B12 - B11, T2 = B22 - T1, T3 = B22 - B12, T4 = T2 - B21
+ * P1 = A11 B11, P2 = A12 B21, P3 = S4 B22, P4 = A22 T4, P5 = S1 T1, P6 = S2 T2, P7 = S3 T3
+ * U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5
+ * C11 = P1 + P2, C12 = U4 + P3, C21 = U3 - P4, C22 = U3 + P5
+ */
+template <typename TScalar, std::size_t N>
+struct StrassenStep<TScalar, N, true>
+{
+    static void product(const Matrix<TScalar, N, N> &a, const Matrix<TScalar, N, N> &b, Matrix<TScalar, N, N> &c, std::size_t cutoff, std::size_t taskDepth)
+    {
+        if (N <= cutoff)
+        {
+            a.multiplyRight(b, c);
+            return;
+        }
+
+        constexpr std::size_t H = N / 2;
+        typedef Matrix<TScalar, H, H> Half;
+        const Half a11 = a.template submatrix<H, H>(0, 0);
+        const Half a12 = a.template submatrix<H, H>(0, H);
+        const Half a21 = a.template submatrix<H, H>(H, 0);
+        const Half a22 = a.template submatrix<H, H>(H, H);
+        const Half b11 = b.template submatrix<H, H>(0, 0);
+        const Half b12 = b.template submatrix<H, H>(0, H);
+        const Half b21 = b.template submatrix<H, H>(H, 0);
+        const Half b22 = b.template submatrix<H, H>(H, H);
+
+        Half s1 = a21;
+        s1.add(a22, 1);
+        Half s2 = s1;
+        s2.add(a11, -1);
+        Half s3 = a11;
+        s3.add(a21, -1);
+        Half s4 = a12;
+        s4.add(s2, -1);
+        Half t1 = b12;
+        t1.add(b11, -1);
+        Half t2 = b22;
+        t2.add(t1, -1);
+        Half t3 = b22;
+        t3.add(b12, -1);
+        Half t4 = t2;
+        t4.add(b21, -1);
+
+        const Half *left[7] = {&a11, &a12, &s4, &a22, &s1, &s2, &s3};
+        const Half *right[7] = {&b11, &b21, &b22, &t4, &t1, &t2, &t3};
+        Half products[7];
+        const bool spawnTasks = taskDepth > 0;
+        std::vector<std::future<void>> tasks{};
+        for (std::size_t p = 0; p != 7; ++p)
+        {
+            if (spawnTasks && p != 6)
+            {
+                tasks.push_back(std::async(std::launch::async, [&left, &right, &products, p, cutoff, taskDepth]()
+                                           {
+                                               SequentialKernelsGuard guard;
+                                               strassenProduct(*left[p], *right[p], products[p], cutoff, taskDepth - 1);
+                                           }));
+            }
+            else if (spawnTasks)
+            {
+                // Runs alongside the six tasks, so it must not start kernel threads of its own either.
+                SequentialKernelsGuard guard;
+                strassenProduct(*left[p], *right[p], products[p], cutoff, taskDepth - 1);
+            }
+            else
+            {
+                strassenProduct(*left[p], *right[p], products[p], cutoff, 0);
+            }
+        }
+        for (auto &task : tasks)
+        {
+            task.get();
+        }
+
+        Half &u2 = products[0];
+        Half c11 = products[0];
+        c11.add(products[1], 1);
+        u2.add(products[5], 1);
+        Half u3 = u2;
+        u3.add(products[6], 1);
+        Half &c12 = u2;
+        c12.add(products[4], 1);
+        c12.add(products[2], 1);
+        Half c21 = u3;
+        c21.add(products[3], -1);
+        Half &c22 = u3;
+        c22.add(products[4], 1);
+
+        c.overwriteSubmatrix(c11, 0, 0);
+        c.overwriteSubmatrix(c12, 0, H);
+        c.overwriteSubmatrix(c21, H, 0);
+        c.overwriteSubmatrix(c22, H, H);
+    };
+};
+
+/**
+ * @brief Compute c = a * b with Strassen-Winograd recursion; c must be zero on entry.
+ */
+template <typename TScalar, std::size_t N>
+void strassenProduct(const Matrix<TScalar, N, N> &a, const Matrix<TScalar, N, N> &b, Matrix<TScalar, N, N> &c, std::size_t cutoff, std::size_t taskDepth)
+{
+    StrassenStep<TScalar, N>::product(a, b, c, cutoff, taskDepth);
+}
+
+/**
+ * @brief Multiply two square matrices with the Strassen-Winograd recursion and add the product to the result matrix.
+ *
+ * The recursion halves N while N is even and larger than both cutoff and strassenMinimumSize, and uses the
+ * classical kernel (multiplyRight) below that. The seven sub-products of the top taskDepth levels run as parallel
+ * tasks. The cost is about (7/8)^L of the classical flops for L levels, plus O(N^2) additions and copies per level.
+ *
+ * Accuracy: the bound is normwise, not componentwise. For L levels stopping at n0 = N / 2^L, Higham (Accuracy
+ * and Stability of Numerical Algorithms, 2nd ed., chapter 23) gives
+ *
+ * max|C - fl(C)| <= [(N / n0)^(log2 18) (n0^2 + 6 n0) - 6 N] u max|A| max|B| + O(u^2)
+ *
+ * against |C - fl(C)| <= N u |A| |B| (componentwise) for the classical product, where u is the unit roundoff.
+ * Each extra level multiplies the leading constant by about 18 / 4, and entries of C that are much smaller than
+ * max|A| max|B| can lose all relative accuracy. Keep the cutoff high and the number of levels small.
+ *
+ * @param a The left factor.
+ * @param b The right factor.
+ * @param result The result matrix; the product is added to it.
+ * @param cutoff Blocks of this size or smaller use the classical kernel.
+ * @param taskDepth The number of top recursion levels whose sub-products run in parallel. Called on a thread that
+ * holds a SequentialKernelsGuard, the product stays on that thread.
+ */
+template <typename TScalar, std::size_t N>
+void strassenMultiplyRight(const Matrix<TScalar, N, N> &a, const Matrix<TScalar, N, N> &b, Matrix<TScalar, N, N> &result, std::size_t cutoff = defaultStrassenCutoff, std::size_t taskDepth = defaultStrassenTaskDepth)
+{
+    Matrix<TScalar, N, N> product;
+    // Decided once here: the tasks hold a SequentialKernelsGuard, which must not stop their own sub-products from
+    // spawning tasks down to taskDepth.
+    strassenProduct(a, b, product, cutoff, sequentialKernelsOnly() ? 0 : taskDepth);
+    result.add(product, 1);
+}
+
+/**
+ * @brief Add a * b to the result matrix with the given algorithm.
+ */
+template <typename TScalar, std::size_t N>
+void multiplySquare(const Matrix<TScalar, N, N> &a, const Matrix<TScalar, N, N> &b, Matrix<TScalar, N, N> &result, GemmAlgorithm algorithm)
+{
+    if (algorithm == GemmAlgorithm::StrassenWinograd)
+    {
+        strassenMultiplyRight(a, b, result);
+    }
+    else
+    {
+        a.multiplyRight(b, result);
+    }
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef SUMMATIONHPP
+#define SUMMATIONHPP
+
+#include <cstddef>
+
+/**
+ * @brief Compensated (Kahan) running sum: the rounding error of each addition is carried into the next one.
+ *
+ * Must not be compiled with -ffast-math, which lets the compiler cancel out the compensation.
+ *
+ * @tparam TScalar The scalar type
+ */
+template <typename TScalar>
+struct KahanSum
+{
+    TScalar sum = 0;
+    TScalar compensation = 0;
+
+    void add(TScalar value)
+    {
+        TScalar corrected = value - compensation;
+        TScalar next = sum + corrected;
+        compensation = (next - sum) - corrected;
+        sum = next;
+    };
+};
+
+/**
+ * @brief Pairwise (cascade) sum of values[0], ..., values[count - 1].
+ *
+ * The summation tree depends only on count, so the result is the same no matter how the values were produced.
+ *
+ * @tparam TScalar The scalar type
+ * @param values Pointer to the first value.
+ * @param count The number of values.
+ */
+template <typename TScalar>
+TScalar pairwiseSum(const TScalar *values, std::size_t count)
+{
+    if (count <= 8)
+    {
+        TScalar sum = 0;
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            sum += values[i];
+        }
+        return sum;
+    }
+    std::size_t half = count / 2;
+    return pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+}
+
+/**
+ * @brief Dot product of a[0], ..., a[count - 1] and b[0], ..., b[count - 1].
+ *
+ * Entry i goes to partial sum i mod 8, so the compiler can keep the partial sums in one vector register without
+ * reassociating anything; the partial sums are then added in order. The order of operations depends only on count.
+ *
+ * @tparam TScalar The scalar type
+ */
+template <typename TScalar>
+TScalar dotProduct(const TScalar *a, const TScalar *b, std::size_t count)
+{
+    TScalar partial[8] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        for (std::size_t lane = 0; lane != 8; ++lane)
+        {
+            partial[lane] += a[i + lane] * b[i + lane];
+        }
+    }
+    for (std::size_t lane = 0; lane != count - i; ++lane)
+    {
+        partial[lane] += a[i + lane] * b[i + lane];
+    }
+    return pairwiseSum(partial, 8);
+}
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef TESTMATRICESHPP
+#define TESTMATRICESHPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "BandMatrix.hpp"
+#include "SkylineMatrix.hpp"
+#include "Philox.hpp"
+
+/**
+ * @brief Philox streams of the generators below, so that matrices generated from the same seed are independent.
+ */
+enum TestMatrixStream : std::uint32_t
+{
+    NormalStream = 1,
+    SPDStream = 2,
+    TriangularStream = 3,
+    WishartStream = 4,
+    SparseStream = 5,
+    BandStream = 6
+};
+
+/**
+ * @brief Return a matrix with independent N(0, stddev^2) entries.
+ *
+ * Entry (i, j) only depends on (seed, stream, i, j), so the result does not depend on the number of threads.
+ *
+ * @param seed The seed.
+ * @param stream The Philox stream; use different streams for different matrices generated from one seed.
+ * @param stddev The standard deviation of the entries.
+ */
+template <typename TScalar, std::size_t NRows, std::size_t NCols>
+Matrix<TScalar, NRows, NCols> randomNormal(std::uint64_t seed, std::uint32_t stream, TScalar stddev)
+{
+    const CounterRng rng(seed);
+    Matrix<TScalar, NRows, NCols> result;
+    parallelForRange(NRows, 64 * NCols, [&rng, &result, stream, stddev](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             TScalar *row = result.rowData(i);
+                             for (std::size_t j = 0; j != NCols; ++j)
+                             {
+                                 row[j] = stddev * rng.normal(stream, i * NCols + j);
+                             }
+                         }
+                     });
+    return result;
+}
+
+/**
+ * @brief Entry (i, j) of the N by N matrix returned by randomSPD; can be evaluated on its own, e.g. tile by tile.
+ */
+template <typename TScalar>
+TScalar randomSPDEntry(const CounterRng &rng, std::size_t n, std::size_t i, std::size_t j)
+{
+    if (i == j)
+    {
+        return (TScalar)(n + rng.uniform(SPDStream, i * n + j));
+    }
+    const std::size_t first = std::min(i, j);
+    const std::size_t second = std::max(i, j);
+    return (TScalar)(2.0 * rng.uniform(SPDStream, first * n + second) - 1.0);
+}
+
+/**
+ * @brief Return a random symmetric positive definite matrix in O(N^2) time.
+ *
+ * Off-diagonal entries are uniform in (-1, 1) and diagonal entries are uniform in (N, N + 1), so the matrix is
+ * strictly diagonally dominant and hence SPD (its eigenvalues lie in (1, 2N)). Prefer wishart when the spectrum
+ * matters.
+ *
+ * @param seed The seed.
+ */
+template <typename TScalar, std::size_t N>
+Matrix<TScalar, N, N> randomSPD(std::uint64_t seed)
+{
+    const CounterRng rng(seed);
+    Matrix<TScalar, N, N> result;
+    parallelForRange(N, 32 * N, [&rng, &result](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             TScalar *row = result.rowData(i);
+                             for (std::size_t j = 0; j != N; ++j)
+                             {
+                                 row[j] = randomSPDEntry<TScalar>(rng, N, i, j);
+                             }
+                         }
+                     });
+    return result;
+}
+
+/**
+ * @brief Return a random upper-triangular matrix whose 2-norm condition number is within a factor 3 of conditionNumber.
+ *
+ * The matrix is D * (I + E): D is diagonal with entries decreasing geometrically from 1 to 1 / conditionNumber,
+ * and E is strictly upper triangular with N(0, 1 / (16 N)) entries, so that |E| <= 1/2 with high probability and
+ * cond(I + E) <= 3.
+ *
+ * @param seed The seed.
+ * @param conditionNumber The target condition number (at least 1).
+ */
+template <typename TScalar, std::size_t N>
+Matrix<TScalar, N, N> randomUpperTriangular(std::uint64_t seed, double conditionNumber)
+{
+    const CounterRng rng(seed);
+    const double offDiagonalStddev = 0.25 / std::sqrt((double)N);
+    Matrix<TScalar, N, N> result;
+    parallelForRange(N, 32 * N, [&rng, &result, conditionNumber, offDiagonalStddev](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             const double diagElem = (N > 1) ? std::pow(conditionNumber, -(double)i / (N - 1)) : 1.0;
+                             TScalar *row = result.rowData(i);
+                             row[i] = (TScalar)diagElem;
+                             for (std::size_t j = i + 1; j != N; ++j)
+                             {
+                                 row[j] = (TScalar)(diagElem * offDiagonalStddev * rng.normal(TriangularStream, i * N + j));
+                             }
+                         }
+                     });
+    return result;
+}
+
+/**
+ * @brief Return a random upper-triangular matrix with unit diagonal and about density * N (N - 1) / 2 nonzero
+ * entries above it, each N(0, 1 / (16 density N)), so that the strictly upper part has 2-norm at most 1/2 with high
+ * probability and the matrix is well conditioned whatever its density.
+ *
+ * @param seed The seed.
+ * @param density The probability that an entry above the diagonal is nonzero, in (0, 1].
+ */
+template <typename TScalar, std::size_t N>
+Matrix<TScalar, N, N> randomSparseUpperTriangular(std::uint64_t seed, double density)
+{
+    const CounterRng rng(seed);
+    const double offDiagonalStddev = 0.25 / std::sqrt(density * N);
+    Matrix<TScalar, N, N> result;
+    parallelForRange(N, 32 * N, [&rng, &result, density, offDiagonalStddev](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             TScalar *row = result.rowData(i);
+                             row[i] = 1;
+                             for (std::size_t j = i + 1; j != N; ++j)
+                             {
+                                 if (rng.uniform(SparseStream, 2 * (i * N + j)) < density)
+                                 {
+                                     row[j] = (TScalar)(offDiagonalStddev * rng.normal(SparseStream, 2 * (i * N + j) + 1));
+                                 }
+                             }
+                         }
+                     });
+    return result;
+}
+
+/**
+ * @brief Return a random symmetric positive definite matrix with bandwidth B in O(N * B) time and storage.
+ *
+ * Entries in the band are uniform in (-1, 1) and diagonal entries are uniform in (2B + 1, 2B + 2), so the matrix is
+ * strictly diagonally dominant and hence SPD.
+ *
+ * @param seed The seed.
+ */
+template <typename TScalar, std::size_t N, std::size_t B>
+SymmetricBandMatrix<TScalar, N, B> randomBandSPD(std::uint64_t seed)
+{
+    const CounterRng rng(seed);
+    SymmetricBandMatrix<TScalar, N, B> result;
+    parallelForRange(N, 32 * B, [&rng, &result](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t j = begin; j != end; ++j)
+                         {
+                             TScalar *column = result.columnData(j);
+                             column[0] = (TScalar)(2 * B + 1 + rng.uniform(BandStream, j * (B + 1)));
+                             for (std::size_t d = 1; d != std::min(B + 1, N - j); ++d)
+                             {
+                                 column[d] = (TScalar)(2.0 * rng.uniform(BandStream, j * (B + 1) + d) - 1.0);
+                             }
+                         }
+                     });
+    return result;
+}
+
+/**
+ * @brief Return a random symmetric positive definite skyline matrix whose rows have bandwidths uniform in
+ * [0, maxBandwidth], with entries as in randomBandSPD (diagonal in (2 maxBandwidth + 1, 2 maxBandwidth + 2)).
+ *
+ * @param seed The seed.
+ * @param maxBandwidth The largest bandwidth of a row.
+ */
+template <typename TScalar, std::size_t N>
+SkylineMatrix<TScalar, N> randomSkylineSPD(std::uint64_t seed, std::size_t maxBandwidth)
+{
+    const CounterRng rng(seed);
+    std::vector<std::size_t> firstColumns(N);
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        const std::size_t bandwidth = std::min((std::size_t)(rng.uniform(BandStream, 2 * i * N) * (maxBandwidth + 1)), maxBandwidth);
+        firstColumns[i] = i - std::min(bandwidth, i);
+    }
+    SkylineMatrix<TScalar, N> result(firstColumns);
+    parallelForRange(N, 32 * maxBandwidth, [&rng, &result, maxBandwidth](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             TScalar *row = result.rowData(i);
+                             const std::size_t first = result.firstColumn(i);
+                             for (std::size_t j = first; j != i; ++j)
+                             {
+                                 row[j - first] = (TScalar)(2.0 * rng.uniform(BandStream, (2 * i + 1) * N + j) - 1.0);
+                             }
+                             row[i - first] = (TScalar)(2 * maxBandwidth + 1 + rng.uniform(BandStream, (2 * i + 1) * N + i));
+                         }
+                     });
+    return result;
+}
+
+/**
+ * @brief Return the sample covariance X^T * X / M + diagonalShift * I, where X is M by N with N(0, stddev^2) entries.
+ *
+ * Only tiles on or above the diagonal are computed (in parallel, as cache-sized rank-256 updates), then mirrored.
+ * Every entry is accumulated over k = 0, ..., M - 1 in order, so the result does not depend on the number of
+ * threads.
+ *
+ * @param seed The seed.
+ * @param stddev The standard deviation of the entries of X.
+ * @param diagonalShift Added to every diagonal entry; any positive shift makes the result positive definite.
+ */
+template <typename TScalar, std::size_t N, std::size_t M>
+Matrix<TScalar, N, N> wishart(std::uint64_t seed, TScalar stddev, TScalar diagonalShift)
+{
+    constexpr std::size_t tileRows = 64;
+    constexpr std::size_t tileCols = 256;
+    constexpr std::size_t tileDepth = 256;
+
+    const Matrix<TScalar, M, N> samples = randomNormal<TScalar, M, N>(seed, WishartStream, stddev);
+    Matrix<TScalar, N, N> result;
+
+    std::vector<std::pair<std::size_t, std::size_t>> upperTiles{};
+    for (std::size_t firstRow = 0; firstRow < N; firstRow += tileRows)
+    {
+        for (std::size_t firstCol = 0; firstCol < N; firstCol += tileCols)
+        {
+            if (firstCol + tileCols > firstRow)
+            {
+                upperTiles.emplace_back(firstRow, firstCol);
+            }
+        }
+    }
+
+    parallelForCyclic(upperTiles.size(), tileRows * tileCols * M, [&upperTiles, &samples, &result](std::size_t t)
+                      {
+                          const std::size_t firstRow = upperTiles[t].first;
+                          const std::size_t lastRow = std::min(firstRow + tileRows, N);
+                          const std::size_t firstCol = upperTiles[t].second;
+                          const std::size_t width = std::min(firstCol + tileCols, N) - firstCol;
+                          for (std::size_t firstK = 0; firstK < M; firstK += tileDepth)
+                          {
+                              const std::size_t lastK = std::min(firstK + tileDepth, M);
+                              for (std::size_t i = firstRow; i != lastRow; ++i)
+                              {
+                                  TScalar *resultRow = result.rowData(i) + firstCol;
+                                  for (std::size_t k = firstK; k != lastK; ++k)
+                                  {
+                                      const TScalar *sampleRow = samples.rowData(k);
+                                      const TScalar weight = sampleRow[i];
+                                      sampleRow += firstCol;
+                                      for (std::size_t j = 0; j != width; ++j)
+                                      {
+                                          resultRow[j] += weight * sampleRow[j];
+                                      }
+                                  }
+                              }
+                          }
+                      });
+
+    parallelForRange(N, N, [&result, diagonalShift](std::size_t begin, std::size_t end)
+                     {
+                         for (std::size_t i = begin; i != end; ++i)
+                         {
+                             TScalar *row = result.rowData(i);
+                             for (std::size_t j = i; j != N; ++j)
+                             {
+                                 row[j] /= M;
+                             }
+                             row[i] += diagonalShift;
+                         }
+                     });
+
+    const std::size_t nMirrorTiles = (N + tileRows - 1) / tileRows;
+    parallelForCyclic(nMirrorTiles, tileRows * N / 2, [&result](std::size_t rowTile)
+                      {
+                          const std::size_t firstRow = rowTile * tileRows;
+                          const std::size_t lastRow = std::min(firstRow + tileRows, N);
+                          for (std::size_t firstCol = 0; firstCol < lastRow; firstCol += tileRows)
+                          {
+                              for (std::size_t i = firstRow; i != lastRow; ++i)
+                              {
+                                  TScalar *row = result.rowData(i);
+                                  const std::size_t lastCol = std::min(firstCol + tileRows, i);
+                                  for (std::size_t j = firstCol; j < lastCol; ++j)
+                                  {
+                                      row[j] = result.rowData(j)[i];
+                                  }
+                              }
+                          }
+                      });
+    return result;
+}
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef TRANSPOSEHPP
+#define TRANSPOSEHPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Side length of the square tiles used by the tiled transpose; a tile of floats is 16 KB.
+ */
+constexpr std::size_t transposeTileSize = 64;
+
+/**
+ * @brief In-register transpose of a small square block; the generic version handles one entry at a time.
+ *
+ * Specializations transpose size by size blocks with SIMD registers. All entry points take the row-of-rows
+ * storage of Matrix and the top-left corner of the block.
+ *
+ * @tparam TScalar The scalar type
+ */
+template <typename TScalar>
+struct TransposeMicroKernel
+{
+    static constexpr std::size_t size = 1;
+
+    static void transpose(const std::vector<std::vector<TScalar>> &src, std::vector<std::vector<TScalar>> &dst, std::size_t row, std::size_t col)
+    {
+        dst[col][row] = src[row][col];
+    };
+
+    static void transposeDiagonal(std::vector<std::vector<TScalar>> &mat, std::size_t idx){};
+
+    static void swapTranspose(std::vector<std::vector<TScalar>> &mat, std::size_t row, std::size_t col)
+    {
+        std::swap(mat[row][col], mat[col][row]);
+    };
+};
+
+#if defined(__AVX__)
+
+template <>
+struct TransposeMicroKernel<float>
+{
+    static constexpr std::size_t size = 8;
+
+    static void load(const std::vector<std::vector<float>> &mat, std::size_t row, std::size_t col, __m256 *r)
+    {
+        for (std::size_t k = 0; k != 8; ++k)
+        {
+            r[k] = _mm256_loadu_ps(mat[row + k].data() + col);
+        }
+    };
+
+    static void store(std::vector<std::vector<float>> &mat, std::size_t row, std::size_t col, const __m256 *r)
+    {
+        for (std::size_t k = 0; k != 8; ++k)
+        {
+            _mm256_storeu_ps(mat[row + k].data() + col, r[k]);
+        }
+    };
+
+    static void transposeRegisters(__m256 *r)
+    {
+        __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+        __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+        __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+        __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+        __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+        __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+        __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+        __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+        __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+        r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+        r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+        r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+        r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+        r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+        r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+        r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+    };
+
+    static void transpose(const std::vector<std::vector<float>> &src, std::vector<std::vector<float>> &dst, std::size_t row, std::size_t col)
+    {
+        __m256 r[8];
+        load(src, row, col, r);
+        transposeRegisters(r);
+        store(dst, col, row, r);
+    };
+
+    static void transposeDiagonal(std::vector<std::vector<float>> &mat, std::size_t idx)
+    {
+        __m256 r[8];
+        load(mat, idx, idx, r);
+        transposeRegisters(r);
+        store(mat, idx, idx, r);
+    };
+
+    static void swapTranspose(std::vector<std::vector<float>> &mat, std::size_t row, std::size_t col)
+    {
+        __m256 upper[8];
+        __m256 lower[8];
+        load(mat, row, col, upper);
+        load(mat, col, row, lower);
+        transposeRegisters(upper);
+        transposeRegisters(lower);
+        store(mat, col, row, upper);
+        store(mat, row, col, lower);
+    };
+};
+
+template <>
+struct TransposeMicroKernel<double>
+{
+    static constexpr std::size_t size = 4;
+
+    static void load(const std::vector<std::vector<double>> &mat, std::size_t row, std::size_t col, __m256d *r)
+    {
+        for (std::size_t k = 0; k != 4; ++k)
+        {
+            r[k] = _mm256_loadu_pd(mat[row + k].data() + col);
+        }
+    };
+
+    static void store(std::vector<std::vector<double>> &mat, std::size_t row, std::size_t col, const __m256d *r)
+    {
+        for (std::size_t k = 0; k != 4; ++k)
+        {
+            _mm256_storeu_pd(mat[row + k].data() + col, r[k]);
+        }
+    };
+
+    static void transposeRegisters(__m256d *r)
+    {
+        __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]);
+        __m256d t1 = _mm256_unpackhi_pd(r[0], r[1]);
+        __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]);
+        __m256d t3 = _mm256_unpackhi_pd(r[2], r[3]);
+        r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+    };
+
+    static void transpose(const std::vector<std::vector<double>> &src, std::vector<std::vector<double>> &dst, std::size_t row, std::size_t col)
+    {
+        __m256d r[4];
+        load(src, row, col, r);
+        transposeRegisters(r);
+        store(dst, col, row, r);
+    };
+
+    static void transposeDiagonal(std::vector<std::vector<double>> &mat, std::size_t idx)
+    {
+        __m256d r[4];
+        load(mat, idx, idx, r);
+        transposeRegisters(r);
+        store(mat, idx, idx, r);
+    };
+
+    static void swapTranspose(std::vector<std::vector<double>> &mat, std::size_t row, std::size_t col)
+    {
+        __m256d upper[4];
+        __m256d lower[4];
+        load(mat, row, col, upper);
+        load(mat, col, row, lower);
+        transposeRegisters(upper);
+        transposeRegisters(lower);
+        store(mat, col, row, upper);
+        store(mat, row, col, lower);
+    };
+};
+
+#endif
+
+/**
+ * @brief Write the transpose of the tile [rowBegin, rowEnd) x [colBegin, colEnd) of src into dst.
+ */
+template <typename TScalar>
+void transposeTile(const std::vector<std::vector<TScalar>> &src, std::vector<std::vector<TScalar>> &dst, std::size_t rowBegin, std::size_t rowEnd, std::size_t colBegin, std::size_t colEnd)
+{
+    typedef TransposeMicroKernel<TScalar> Kernel;
+    std::size_t i = rowBegin;
+    for (; i + Kernel::size <= rowEnd; i += Kernel::size)
+    {
+        std::size_t j = colBegin;
+        for (; j + Kernel::size <= colEnd; j += Kernel::size)
+        {
+            Kernel::transpose(src, dst, i, j);
+        }
+        for (; j < colEnd; ++j)
+        {
+            for (std::size_t r = i; r != i + Kernel::size; ++r)
+            {
+                dst[j][r] = src[r][j];
+            }
+        }
+    }
+    for (; i < rowEnd; ++i)
+    {
+        for (std::size_t j = colBegin; j < colEnd; ++j)
+        {
+            dst[j][i] = src[i][j];
+        }
+    }
+}
+
+/**
+ * @brief Swap every entry (i, j) with j > i of the tile [rowBegin, rowEnd) x [colBegin, colEnd) with entry (j, i).
+ *
+ * The tile must either lie on the diagonal (same row and column range) or strictly above it.
+ */
+template <typename TScalar>
+void transposeTileInPlace(std::vector<std::vector<TScalar>> &mat, std::size_t rowBegin, std::size_t rowEnd, std::size_t colBegin, std::size_t colEnd)
+{
+    typedef TransposeMicroKernel<TScalar> Kernel;
+    const bool diagonal = (rowBegin == colBegin);
+    std::size_t i = rowBegin;
+    for (; i + Kernel::size <= rowEnd; i += Kernel::size)
+    {
+        std::size_t j = colBegin;
+        if (diagonal)
+        {
+            Kernel::transposeDiagonal(mat, i);
+            j = i + Kernel::size;
+        }
+        for (; j + Kernel::size <= colEnd; j += Kernel::size)
+        {
+            Kernel::swapTranspose(mat, i, j);
+        }
+        for (; j < colEnd; ++j)
+        {
+            for (std::size_t r = i; r != i + Kernel::size; ++r)
+            {
+                std::swap(mat[r][j], mat[j][r]);
+            }
+        }
+    }
+    for (; i < rowEnd; ++i)
+    {
+        for (std::size_t j = std::max(colBegin, i + 1); j < colEnd; ++j)
+        {
+            std::swap(mat[i][j], mat[j][i]);
+        }
+    }
+}
+
+#endif
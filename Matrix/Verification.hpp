@@ -0,0 +1,223 @@
+#ifndef VERIFICATIONHPP
+#define VERIFICATIONHPP
+
+#include <iostream>
+#include <random>
+#include <limits>
+#include "Matrix.hpp"
+#include "Strassen.hpp"
+
+/**
+ * @brief How a solver should check its result after the timed section.
+ *
+ * None skips the check entirely. Freivalds multiplies both sides of the identity by a few random sign vectors,
+ * which costs O(N^2) per probe. Full forms the complete product, which costs as much as the solve itself.
+ */
+enum class VerificationMode
+{
+    None,
+    Freivalds,
+    Full
+};
+
+/**
+ * @brief The default number of random probe vectors for Freivalds verification.
+ */
+constexpr std::size_t defaultVerificationProbes = 4;
+
+/**
+ * @brief Return a matrix of random signs (+1 or -1) used as probe vectors.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam NRows The length of each probe vector
+ * @tparam NProbes The number of probe vectors
+ */
+template <typename TScalar, std::size_t NRows, std::size_t NProbes>
+Matrix<TScalar, NRows, NProbes> randomSignProbes()
+{
+    std::mt19937 rng;
+    rng.seed(11828);
+    std::bernoulli_distribution coin(0.5);
+    return Matrix<TScalar, NRows, NProbes>([&rng, &coin](std::size_t rowIdx, std::size_t colIdx)
+                                           { return coin(rng) ? (TScalar)1 : (TScalar)-1; });
+}
+
+/**
+ * @brief Return the percent residual of a Cholesky factor, 100 * |L * L^T - A| / |A|.
+ *
+ * In Full mode the norms are Frobenius norms of the N by N matrices. In Freivalds mode both sides are applied to
+ * NProbes random sign vectors X and the norms are taken of L * (L^T * X) - A * X and A * X, which never forms an
+ * N by N product. Returns NaN in None mode.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam N Matrix size
+ * @tparam NProbes The number of probe vectors for Freivalds mode
+ * @param mat The symmetric positive definite matrix A
+ * @param factor The lower-triangular factor L
+ * @param mode The verification mode
+ * @param gemm The algorithm for the N by N product in Full mode
+ */
+template <typename TScalar, std::size_t N, std::size_t NProbes = defaultVerificationProbes>
+TScalar choleskyResidual(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, N> &factor, VerificationMode mode, GemmAlgorithm gemm = GemmAlgorithm::Classical)
+{
+    if (mode == VerificationMode::None)
+    {
+        return std::numeric_limits<TScalar>::quiet_NaN();
+    }
+
+    if (mode == VerificationMode::Full)
+    {
+        Matrix<TScalar, N, N> computed;
+        multiplySquare(factor, factor.transpose(), computed, gemm);
+        computed.add(mat, -1.0);
+        return 100.0 * computed.frobNorm() / mat.frobNorm();
+    }
+
+    const Matrix<TScalar, N, NProbes> probes = randomSignProbes<TScalar, N, NProbes>();
+
+    // L^T * X is formed as (X^T * L)^T so that L is only ever read row by row.
+    Matrix<TScalar, NProbes, N> probesTransposeTimesFactor;
+    factor.multiplyLeft(probes.transpose(), probesTransposeTimesFactor);
+    Matrix<TScalar, N, NProbes> computed;
+    factor.multiplyRight(probesTransposeTimesFactor.transpose(), computed);
+
+    Matrix<TScalar, N, NProbes> expected;
+    mat.multiplyRight(probes, expected);
+    computed.add(expected, -1.0);
+    return 100.0 * computed.frobNorm() / expected.frobNorm();
+}
+
+/**
+ * @brief Return the percent residual of a linear solve, 100 * |A * X - B| / |B|.
+ *
+ * In Full mode the norms are Frobenius norms of the N by K matrices. In Freivalds mode both sides are applied to
+ * NProbes random sign vectors P and the norms are taken of A * (X * P) - B * P and B * P. Returns NaN in None mode.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam N Matrix size
+ * @tparam K Number of right hand sides
+ * @tparam NProbes The number of probe vectors for Freivalds mode
+ * @param mat The matrix A
+ * @param rhs The right hand sides B
+ * @param result The computed solution X
+ * @param mode The verification mode
+ */
+template <typename TScalar, std::size_t N, std::size_t K, std::size_t NProbes = defaultVerificationProbes>
+TScalar solveResidual(const Matrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, const Matrix<TScalar, N, K> &result, VerificationMode mode)
+{
+    if (mode == VerificationMode::None)
+    {
+        return std::numeric_limits<TScalar>::quiet_NaN();
+    }
+
+    if (mode == VerificationMode::Full)
+    {
+        Matrix<TScalar, N, K> computed;
+        mat.multiplyRight(result, computed);
+        computed.add(rhs, -1.0);
+        return 100.0 * computed.frobNorm() / rhs.frobNorm();
+    }
+
+    const Matrix<TScalar, K, NProbes> probes = randomSignProbes<TScalar, K, NProbes>();
+
+    Matrix<TScalar, N, NProbes> resultTimesProbes;
+    result.multiplyRight(probes, resultTimesProbes);
+    Matrix<TScalar, N, NProbes> computed;
+    mat.multiplyRight(resultTimesProbes, computed);
+
+    Matrix<TScalar, N, NProbes> expected;
+    rhs.multiplyRight(probes, expected);
+    computed.add(expected, -1.0);
+    return 100.0 * computed.frobNorm() / expected.frobNorm();
+}
+
+/**
+ * @brief Return the percent optimality residual of a least-squares solve, 100 * |A^T * R| / (|A| * (|A| * |X| + |B|))
+ * with R = A * X - B. A^T * R vanishes exactly at the minimizer (the residual is then orthogonal to the range of A).
+ *
+ * The scaling is that of LAPACK's xQRT17 test ratio, without its division by machine epsilon: it does not divide by
+ * |R|, which is tiny or zero when the system is consistent (e.g. square), so a solve that fits B exactly reads as 0.
+ *
+ * In Full mode R, X and B are the complete matrices. In Freivalds mode they are replaced by R * P, X * P and B * P
+ * for NProbes random sign vectors P. A^T * R is formed as (R^T * A)^T so that A is only ever read row by row.
+ * Returns NaN in None mode.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam M Number of rows of A
+ * @tparam N Number of columns of A
+ * @tparam K Number of right hand sides
+ * @tparam NProbes The number of probe vectors for Freivalds mode
+ * @param mat The matrix A
+ * @param rhs The right hand sides B
+ * @param result The computed solution X
+ * @param mode The verification mode
+ */
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t K, std::size_t NProbes = defaultVerificationProbes>
+TScalar leastSquaresResidual(const Matrix<TScalar, M, N> &mat, const Matrix<TScalar, M, K> &rhs, const Matrix<TScalar, N, K> &result, VerificationMode mode)
+{
+    if (mode == VerificationMode::None)
+    {
+        return std::numeric_limits<TScalar>::quiet_NaN();
+    }
+
+    // A zero numerator means an exact fit, even if A, X and B are all zero.
+    auto ratio = [&mat](TScalar normalNorm, TScalar resultNorm, TScalar rhsNorm) -> TScalar
+    {
+        if (normalNorm == 0)
+        {
+            return 0;
+        }
+        const TScalar matNorm = mat.frobNorm();
+        return 100.0 * normalNorm / (matNorm * (matNorm * resultNorm + rhsNorm));
+    };
+
+    if (mode == VerificationMode::Full)
+    {
+        Matrix<TScalar, M, K> residual;
+        mat.multiplyRight(result, residual);
+        residual.add(rhs, -1.0);
+        Matrix<TScalar, K, N> normal;
+        mat.multiplyLeft(residual.transpose(), normal);
+        return ratio(normal.frobNorm(), result.frobNorm(), rhs.frobNorm());
+    }
+
+    const Matrix<TScalar, K, NProbes> probes = randomSignProbes<TScalar, K, NProbes>();
+
+    Matrix<TScalar, N, NProbes> resultTimesProbes;
+    result.multiplyRight(probes, resultTimesProbes);
+    Matrix<TScalar, M, NProbes> residual;
+    mat.multiplyRight(resultTimesProbes, residual);
+    Matrix<TScalar, M, NProbes> expected;
+    rhs.multiplyRight(probes, expected);
+    residual.add(expected, -1.0);
+
+    Matrix<TScalar, NProbes, N> normal;
+    mat.multiplyLeft(residual.transpose(), normal);
+    return ratio(normal.frobNorm(), resultTimesProbes.frobNorm(), expected.frobNorm());
+}
+
+/**
+ * @brief Print the residual line of a solver report for the given verification mode.
+ *
+ * @param residual The percent residual returned by choleskyResidual, solveResidual or leastSquaresResidual.
+ * @param mode The verification mode used to compute it.
+ * @param probes The NProbes it was computed with in Freivalds mode.
+ */
+template <typename TScalar>
+void printResidual(TScalar residual, VerificationMode mode, std::size_t probes = defaultVerificationProbes)
+{
+    switch (mode)
+    {
+    case VerificationMode::None:
+        std::cout << "Percent residual: not verified" << std::endl;
+        break;
+    case VerificationMode::Freivalds:
+        std::cout << "Percent residual (Freivalds, " << probes << " probes): " << residual << std::endl;
+        break;
+    case VerificationMode::Full:
+        std::cout << "Percent residual (Frobenius): " << residual << std::endl;
+        break;
+    }
+}
+
+#endif
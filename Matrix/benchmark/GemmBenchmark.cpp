@@ -0,0 +1,59 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "../Matrix.hpp"
+#include "../TestMatrices.hpp"
+#include "../Strassen.hpp"
+#include "../PerfCounters.hpp"
+
+/**
+ * @brief Time the classical product against Strassen-Winograd with a few cutoffs for N by N float matrices, and
+ * print the relative difference of each Strassen result from the classical one.
+ */
+template <std::size_t N>
+void benchmarkSize()
+{
+    const Matrix<float, N, N> a = randomNormal<float, N, N>(11828, NormalStream, 1.0f);
+    const Matrix<float, N, N> b = randomNormal<float, N, N>(11828, SPDStream, 1.0f);
+
+    Matrix<float, N, N> classical;
+    PerfCounters counters(perfCountersRequested(), true);
+    auto timerStart = std::chrono::steady_clock::now();
+    a.multiplyRight(b, classical);
+    auto timerStop = std::chrono::steady_clock::now();
+    const PerfCounts counts = counters.read();
+    std::chrono::duration<double> seconds = timerStop - timerStart;
+    std::cout << "N = " << N << std::endl;
+    std::cout << "  Classical milliseconds: " << (int)(1000 * seconds.count()) << ", GFLOP/s: " << 2.0 * N * N * N / seconds.count() / 1e9 << std::endl;
+    printPerfCounts(counts, 2.0 * N * N * N);
+
+    for (std::size_t cutoff : {128, 256, 512})
+    {
+        if (cutoff >= N)
+        {
+            continue;
+        }
+        Matrix<float, N, N> fast;
+        timerStart = std::chrono::steady_clock::now();
+        strassenMultiplyRight(a, b, fast, cutoff);
+        timerStop = std::chrono::steady_clock::now();
+        seconds = timerStop - timerStart;
+        fast.add(classical, -1.0f);
+        std::cout << "  Strassen-Winograd, cutoff " << cutoff << ": milliseconds " << (int)(1000 * seconds.count())
+                  << ", relative difference " << fast.frobNorm() / classical.frobNorm() << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mode = (argc > 1) ? argv[1] : "";
+    benchmarkSize<256>();
+    benchmarkSize<512>();
+    benchmarkSize<1024>();
+    benchmarkSize<2048>();
+    if (mode == "large")
+    {
+        benchmarkSize<4096>();
+    }
+    return 0;
+}
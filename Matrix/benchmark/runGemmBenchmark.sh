@@ -0,0 +1,5 @@
+#!/bin/bash
+
+g++ -Wall -std=c++11 -O3 -march=native -pthread -o gemm_benchmark ./GemmBenchmark.cpp
+./gemm_benchmark "$@"
+rm ./gemm_benchmark
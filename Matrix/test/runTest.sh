@@ -1,5 +1,5 @@
 #!/bin/bash
 
-g++ -Wall -std=c++11 -o matrix_test ./test.cpp
+g++ -Wall -std=c++11 -O3 -march=native -pthread -o matrix_test ./test.cpp
 ./matrix_test
 rm ./matrix_test
\ No newline at end of file
@@ -1,6 +1,12 @@
 #include <iostream>
 
 #include "../Matrix.hpp"
+#include "../TestMatrices.hpp"
+#include "../Strassen.hpp"
+#include "../SparseMatrix.hpp"
+#include "../BandMatrix.hpp"
+#include "../SkylineMatrix.hpp"
+#include "../Hash.hpp"
 
 void printSeparator()
 {
@@ -105,6 +111,186 @@ void testTen()
     matrix.print();
 }
 
+void testEleven()
+{
+    std::cout << "Tiled transpose (large, ragged tiles): should print 1" << std::endl;
+    const Matrix<float, 203, 341> matrix([](std::size_t rowIdx, std::size_t colIdx)
+                                         { return (float)(1000 * rowIdx + colIdx); });
+    const Matrix<float, 341, 203> transpose = matrix.transpose();
+    bool matches = true;
+    for (std::size_t i = 0; i != 203; ++i)
+    {
+        for (std::size_t j = 0; j != 341; ++j)
+        {
+            matches = matches && (transpose.get(j, i) == matrix.get(i, j));
+        }
+    }
+    std::cout << matches << std::endl;
+}
+
+void testTwelve()
+{
+    std::cout << "In-place transpose: should print a 5 by 5 matrix of (j-i), then 1" << std::endl;
+    Matrix<int, 5, 5> small([](std::size_t rowIdx, std::size_t colIdx)
+                            { return rowIdx - colIdx; });
+    small.transposeInPlace();
+    small.print();
+
+    Matrix<double, 300, 300> matrix([](std::size_t rowIdx, std::size_t colIdx)
+                                    { return (double)(1000 * rowIdx + colIdx); });
+    matrix.transposeInPlace();
+    bool matches = true;
+    for (std::size_t i = 0; i != 300; ++i)
+    {
+        for (std::size_t j = 0; j != 300; ++j)
+        {
+            matches = matches && (matrix.get(i, j) == (double)(1000 * j + i));
+        }
+    }
+    std::cout << matches << std::endl;
+}
+
+void testThirteen()
+{
+    std::cout << "Norm and deviation: should print 2 0, then 1 1" << std::endl;
+    const Matrix<double, 300, 400> constant(2);
+    std::cout << constant.frobNorm() << " " << constant.sample_dev() << std::endl;
+    const Matrix<double, 300, 400> alternating([](std::size_t rowIdx, std::size_t colIdx)
+                                               { return ((rowIdx + colIdx) % 2 == 0) ? 1.0 : -1.0; });
+    std::cout << alternating.frobNorm() << " " << alternating.sample_dev() << std::endl;
+}
+
+void testFourteen()
+{
+    std::cout << "Large sum and scalar multiply: should print 1" << std::endl;
+    Matrix<float, 400, 500> matrix(1);
+    const Matrix<float, 400, 500> other([](std::size_t rowIdx, std::size_t colIdx)
+                                        { return (float)(rowIdx + colIdx); });
+    matrix.multiplyScalar(3);
+    matrix.add(other, -2);
+    bool matches = true;
+    for (std::size_t i = 0; i != 400; ++i)
+    {
+        for (std::size_t j = 0; j != 500; ++j)
+        {
+            matches = matches && (matrix.get(i, j) == 3 - 2 * (float)(i + j));
+        }
+    }
+    std::cout << matches << std::endl;
+}
+
+void testFifteen()
+{
+    std::cout << "Bitwise equality: should print 1 0 (the second pair differs only by the sign of a zero)" << std::endl;
+    const Matrix<float, 3, 4> matrix(0.5f);
+    const Matrix<float, 3, 4> copy = matrix;
+    Matrix<float, 3, 4> positiveZero(0.0f);
+    Matrix<float, 3, 4> negativeZero(0.0f);
+    negativeZero.set(1, 2, -0.0f);
+    std::cout << matrix.bitwiseEquals(copy) << " " << positiveZero.bitwiseEquals(negativeZero) << std::endl;
+}
+
+void testSixteen()
+{
+    std::cout << "Philox4x32-10 known answer: should print 6627e8d5 e169c58d bc57ac4c 9b00dbd8" << std::endl;
+    const Philox4x32::Counter words = Philox4x32::generate({0, 0, 0, 0}, {0, 0});
+    std::cout << std::hex << words[0] << " " << words[1] << " " << words[2] << " " << words[3] << std::dec << std::endl;
+}
+
+void testSeventeen()
+{
+    std::cout << "Generated test matrices: should print 1 1 1 (symmetric SPD, triangular, reproducible Wishart)" << std::endl;
+    const Matrix<float, 40, 40> spd = randomSPD<float, 40>(7);
+    const Matrix<float, 40, 40> upper = randomUpperTriangular<float, 40>(7, 10.0);
+    const Matrix<float, 40, 40> wishartOne = wishart<float, 40, 30>(7, 1.0f, 1.0f);
+    const Matrix<float, 40, 40> wishartTwo = wishart<float, 40, 30>(7, 1.0f, 1.0f);
+    bool symmetric = true;
+    bool triangular = true;
+    for (std::size_t i = 0; i != 40; ++i)
+    {
+        for (std::size_t j = 0; j != 40; ++j)
+        {
+            symmetric = symmetric && (spd.get(i, j) == spd.get(j, i)) && (wishartOne.get(i, j) == wishartOne.get(j, i));
+            triangular = triangular && (i <= j || upper.get(i, j) == 0);
+        }
+    }
+    std::cout << symmetric << " " << triangular << " " << wishartOne.bitwiseEquals(wishartTwo) << std::endl;
+}
+
+void testEighteen()
+{
+    std::cout << "Strassen-Winograd product: should print 1 1 (matches the classical product, same result with and without tasks)" << std::endl;
+    const Matrix<double, 256, 256> a = randomNormal<double, 256, 256>(5, NormalStream, 1.0);
+    const Matrix<double, 256, 256> b = randomNormal<double, 256, 256>(5, SPDStream, 1.0);
+    Matrix<double, 256, 256> classical(1);
+    a.multiplyRight(b, classical);
+    Matrix<double, 256, 256> fast(1);
+    strassenMultiplyRight(a, b, fast, 64, 1);
+    Matrix<double, 256, 256> difference = fast;
+    difference.add(classical, -1.0);
+    Matrix<double, 256, 256> sequential(1);
+    strassenMultiplyRight(a, b, sequential, 64, 0);
+    std::cout << (difference.frobNorm() < 1e-10 * classical.frobNorm()) << " " << sequential.bitwiseEquals(fast) << std::endl;
+}
+
+void testNineteen()
+{
+    std::cout << "Sparse matrix: should print 1 1 1 (CSR and CSC round trips, sparse times dense matches dense product)" << std::endl;
+    const Matrix<double, 60, 50> dense([](std::size_t rowIdx, std::size_t colIdx)
+                                       { return (rowIdx * 7 + colIdx * 3) % 11 == 0 ? (double)rowIdx - (double)colIdx + 0.5 : 0.0; });
+    const SparseMatrix<double, 60, 50> csr(dense);
+    const SparseMatrix<double, 60, 50, SparseLayout::Csc> csc = csr.convert();
+    const SparseMatrix<double, 60, 50, SparseLayout::Csc> cscFromDense(dense);
+    const Matrix<double, 50, 4> other = randomNormal<double, 50, 4>(3, NormalStream, 1.0);
+    Matrix<double, 60, 4> expected(0);
+    dense.multiplyRight(other, expected);
+    Matrix<double, 60, 4> fromCsr(0);
+    csr.multiplyRight(other, fromCsr);
+    Matrix<double, 60, 4> fromCsc(0);
+    csc.multiplyRight(other, fromCsc);
+    fromCsr.add(expected, -1.0);
+    fromCsc.add(expected, -1.0);
+    std::cout << (csr.toDense().bitwiseEquals(dense) && csc.toDense().bitwiseEquals(dense)) << " "
+              << (csc.sameStructure(cscFromDense) && csc.convert().sameStructure(csr)) << " "
+              << (fromCsr.frobNorm() < 1e-12 && fromCsc.frobNorm() < 1e-12) << std::endl;
+}
+
+void testTwenty()
+{
+    std::cout << "Band and skyline storage: should print 1 1 (products match the dense products of the same matrices)" << std::endl;
+    const SymmetricBandMatrix<double, 50, 3> band = randomBandSPD<double, 50, 3>(9);
+    const SkylineMatrix<double, 50> skyline = randomSkylineSPD<double, 50>(9, 6);
+    const Matrix<double, 50, 3> other = randomNormal<double, 50, 3>(9, NormalStream, 1.0);
+    Matrix<double, 50, 3> bandProduct(0);
+    band.multiplyRight(other, bandProduct);
+    Matrix<double, 50, 3> skylineProduct(0);
+    skyline.multiplyRight(other, skylineProduct);
+    Matrix<double, 50, 3> expected(0);
+    band.toDense().multiplyRight(other, expected);
+    bandProduct.add(expected, -1.0);
+    expected = Matrix<double, 50, 3>(0);
+    skyline.toDense().multiplyRight(other, expected);
+    skylineProduct.add(expected, -1.0);
+    std::cout << (bandProduct.frobNorm() < 1e-12) << " " << (skylineProduct.frobNorm() < 1e-12) << std::endl;
+}
+
+void testTwentyOne()
+{
+    std::cout << "XXH64 and matrix fingerprints: should print 1 1 1 1 0 (reference hashes of \"\" and \"abc\", streaming equals one-shot, equal matrices match, a changed entry does not)" << std::endl;
+    const char *text = "Nobody inspects the spammish repetition";
+    XXHash64 streaming;
+    for (std::size_t i = 0; i < 39; i += 5)
+    {
+        streaming.update(text + i, std::min<std::size_t>(5, 39 - i));
+    }
+    const Matrix<float, 7, 5> mat = randomNormal<float, 7, 5>(9, NormalStream, 1.0);
+    Matrix<float, 7, 5> changed = mat;
+    changed.set(6, 4, changed.get(6, 4) + 1);
+    std::cout << (xxHash64("", 0) == 0xEF46DB3751D8E999ULL) << " " << (xxHash64("abc", 3) == 0x44BC2CF5AD770999ULL) << " "
+              << (streaming.digest() == xxHash64(text, 39)) << " " << (matrixFingerprint(mat) == matrixFingerprint(Matrix<float, 7, 5>(mat))) << " "
+              << (matrixFingerprint(mat) == matrixFingerprint(changed)) << std::endl;
+}
+
 int main()
 {
     testOne();
@@ -126,6 +312,28 @@ int main()
     testNine();
     printSeparator();
     testTen();
+    printSeparator();
+    testEleven();
+    printSeparator();
+    testTwelve();
+    printSeparator();
+    testThirteen();
+    printSeparator();
+    testFourteen();
+    printSeparator();
+    testFifteen();
+    printSeparator();
+    testSixteen();
+    printSeparator();
+    testSeventeen();
+    printSeparator();
+    testEighteen();
+    printSeparator();
+    testNineteen();
+    printSeparator();
+    testTwenty();
+    printSeparator();
+    testTwentyOne();
 
     return 0;
 }
\ No newline at end of file
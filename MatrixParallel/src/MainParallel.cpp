@@ -1,35 +1,144 @@
 #include<stdio.h> 
 #include<iostream>
-#include "include\MatrixMath.h"
+#include "include/MatrixMath.h"
 #include<chrono>
+#include<cstdlib>
+#include<stdexcept>
 using namespace std;
 using namespace std::chrono;
 
 int** createArray(int row, int col);
 int** createZeroArray(int row,int col);
+int** createRandomArray(int row, int col, int low, int high);
+void deleteArray(int** a, int row);
 void printMatrix(int **a, int row, int col);
+bool sameValues(int** a, const DenseMatrix<int>& b, int row, int col);
+void multiplyInt(MatrixMath& mm, const IntMatrix<int8_t>& a, const IntMatrix<int8_t>& b, IntMatrix<int32_t>& c, IntGemmKernel kernel);
+void multiplyInt(MatrixMath& mm, const IntMatrix<int16_t>& a, const IntMatrix<int16_t>& b, IntMatrix<int64_t>& c, IntGemmKernel kernel);
+template <typename TIn, typename TOut>
+void benchmarkIntGemm(MatrixMath& mm, int n, int low, int high, const char* label);
 //Example From: 
 //https://medium.com/swlh/introduction-to-the-openmp-with-c-and-some-integrals-approximation-a7f03e9ebb65
 //
-int main() { 
+//Usage: matrixPll [maxN]
+//Benchmarks parallelMultiply2D (int**) against tiledMultiply (contiguous, int and float) for
+//n = 500, 1000, ..., maxN (default 4000), then the integer GEMM kernels for int8 and int16 at
+//n = 256, 512, ..., min(maxN, 2048).
+int main(int argc, char** argv) { 
 
-    int n = 2500 ; // square matrix
-    int** array1 = createArray(n,n);
-    int** array2 = createArray(n,n);
-    int** array3 = createZeroArray(n,n);
+    int maxN = (argc > 1) ? atoi(argv[1]) : 4000;
     MatrixMath mm;
 
-    auto start = high_resolution_clock::now();
-    //parallelMultiply(array1, array2, array3, n);
-    mm.parallelMultiply2D(array1,array2,array3,n);
-    auto stop = high_resolution_clock::now();
-    auto duration = duration_cast<milliseconds>(stop - start);
-    cout << "Mutiply Test Time(Milli Sec) " << duration.count() <<endl;
-    //printMatrix(array3,n,n);
+    for(int n = 500; n <= maxN; n += 500){
+        int** array1 = createArray(n,n);
+        int** array2 = createArray(n,n);
+        int** array3 = createZeroArray(n,n);
+
+        auto start = high_resolution_clock::now();
+        mm.parallelMultiply2D(array1,array2,array3,n);
+        auto stop = high_resolution_clock::now();
+        auto jaggedDuration = duration_cast<milliseconds>(stop - start);
+
+        DenseMatrix<int> denseA = DenseMatrix<int>::fromJagged(array1,n,n);
+        DenseMatrix<int> denseB = DenseMatrix<int>::fromJagged(array2,n,n);
+        DenseMatrix<int> denseC(n,n);
+        start = high_resolution_clock::now();
+        mm.tiledMultiply(denseA,denseB,denseC);
+        stop = high_resolution_clock::now();
+        auto tiledDuration = duration_cast<milliseconds>(stop - start);
+
+        DenseMatrix<float> floatA = DenseMatrix<float>::fromJagged(array1,n,n);
+        DenseMatrix<float> floatB = DenseMatrix<float>::fromJagged(array2,n,n);
+        DenseMatrix<float> floatC(n,n);
+        start = high_resolution_clock::now();
+        mm.tiledMultiply(floatA,floatB,floatC);
+        stop = high_resolution_clock::now();
+        auto floatDuration = duration_cast<milliseconds>(stop - start);
+
+        cout << "n = " << n << endl;
+        cout << "Mutiply Test Time(Milli Sec) int** " << jaggedDuration.count() << endl;
+        cout << "Mutiply Test Time(Milli Sec) tiled int " << tiledDuration.count() << (sameValues(array3,denseC,n,n) ? "" : " MISMATCH") << endl;
+        cout << "Mutiply Test Time(Milli Sec) tiled float " << floatDuration.count() << endl;
+
+        deleteArray(array1,n);
+        deleteArray(array2,n);
+        deleteArray(array3,n);
+    }
+
+    cout << "Integer GEMM kernel: " << MatrixMath::kernelName(MatrixMath::bestIntGemmKernel()) << endl;
+    try{
+        for(int size = 256; size <= std::min(maxN, 2048); size *= 2){
+            benchmarkIntGemm<int8_t, int32_t>(mm, size, -128, 127, "int8");
+            benchmarkIntGemm<int16_t, int64_t>(mm, size, -32768, 32767, "int16");
+        }
+    }
+    catch(const std::invalid_argument& error){
+        cout << "FATAL ERROR: " << error.what() << endl;
+        return 1;
+    }
         
     return 0; 
 }
 
+void multiplyInt(MatrixMath& mm, const IntMatrix<int8_t>& a, const IntMatrix<int8_t>& b, IntMatrix<int32_t>& c, IntGemmKernel kernel){
+    mm.multiplyInt8(a, b, c, kernel);
+}
+
+void multiplyInt(MatrixMath& mm, const IntMatrix<int16_t>& a, const IntMatrix<int16_t>& b, IntMatrix<int64_t>& c, IntGemmKernel kernel){
+    mm.multiplyInt16(a, b, c, kernel);
+}
+
+//Times every kernel this CPU supports on random n x n matrices with entries in [low, high]
+//and checks them against the scalar kernel, and the scalar kernel against parallelMultiply2D
+//where the int** result cannot overflow.
+template <typename TIn, typename TOut>
+void benchmarkIntGemm(MatrixMath& mm, int n, int low, int high, const char* label){
+    int** array1 = createRandomArray(n,n,low,high);
+    int** array2 = createRandomArray(n,n,low,high);
+    IntMatrix<TIn> a = IntMatrix<TIn>::fromJagged(array1,n,n);
+    IntMatrix<TIn> b = IntMatrix<TIn>::fromJagged(array2,n,n);
+    IntMatrix<TOut> reference(n,n);
+    multiplyInt(mm, a, b, reference, IntGemmKernel::Scalar);
+
+    cout << "n = " << n << ", " << label << endl;
+    if((long long)n * high * high <= 2147483647LL){
+        int** array3 = createZeroArray(n,n);
+        mm.parallelMultiply2D(array1,array2,array3,n);
+        bool same = true;
+        for(int i = 0; i < n && same; i++){
+            for(int j = 0; j < n; j++){
+                same = same && array3[i][j] == reference(i, j);
+            }
+        }
+        cout << "Scalar kernel matches parallelMultiply2D: " << (same ? "yes" : "no") << endl;
+        deleteArray(array3,n);
+    }
+    const IntGemmKernel kernels[] = {IntGemmKernel::Scalar, IntGemmKernel::Avx2, IntGemmKernel::Avx512Vnni};
+    for(IntGemmKernel kernel : kernels){
+        if(!MatrixMath::supports(kernel)){
+            continue;
+        }
+        IntMatrix<TOut> c(n,n);
+        auto start = high_resolution_clock::now();
+        multiplyInt(mm, a, b, c, kernel);
+        auto stop = high_resolution_clock::now();
+        duration<double> seconds = stop - start;
+        bool same = true;
+        for(int i = 0; i < n && same; i++){
+            for(int j = 0; j < n; j++){
+                same = same && c(i, j) == reference(i, j);
+            }
+        }
+        cout << "Mutiply Test Time(Milli Sec) " << MatrixMath::kernelName(kernel) << " " << (int)(1000 * seconds.count())
+             << ", GOP/s " << 2.0 * n * n * n / seconds.count() / 1e9 << endl;
+        if(kernel != IntGemmKernel::Scalar){
+            cout << MatrixMath::kernelName(kernel) << " kernel vs scalar: " << (same ? "match" : "MISMATCH") << endl;
+        }
+    }
+    deleteArray(array1,n);
+    deleteArray(array2,n);
+}
+
 int** createArray(int row, int col){
     int** arr = 0;
     arr = new int*[row];
@@ -54,6 +163,18 @@ int** createZeroArray(int row,int col){
     return arr; 
 }
 
+//Entries in [low, high] from rand(), so the same on every run
+int** createRandomArray(int row, int col, int low, int high){
+    int** arr = new int*[row];
+    for(int i = 0; i < row; i++){
+        arr[i] = new int[col];
+        for(int j = 0; j < col ; j++){
+            arr[i][j] = low + rand() % (high - low + 1);
+        }
+    }
+    return arr;
+}
+
 void printMatrix(int **a, int row, int col){
 
     cout << "int print Matrix" << endl;
@@ -66,4 +187,22 @@ void printMatrix(int **a, int row, int col){
         }
         cout << endl;
     }
-}
\ No newline at end of file
+}
+
+void deleteArray(int** a, int row){
+    for(int i = 0; i < row; i++){
+        delete[] a[i];
+    }
+    delete[] a;
+}
+
+bool sameValues(int** a, const DenseMatrix<int>& b, int row, int col){
+    for(int i = 0; i < row; i++){
+        for(int j = 0; j < col; j++){
+            if(a[i][j] != b(i, j)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -1,4 +1,4 @@
-#include "include\MatrixMath.h"
+#include "include/MatrixMath.h"
 #include <omp.h>
 MatrixMath::MatrixMath(){}
 
@@ -8,9 +8,11 @@ void MatrixMath::parallelMultiply2D(int** matrixA, int** matrixB, int** matrixC,
     #pragma omp parallel for
 	for(int i=0; i<dimension; i++){
 		for(int j=0; j<dimension; j++){
+			int64_t sum = 0;
 			for(int k=0; k<dimension; k++){
-				matrixC[i][j] += matrixA[i][k] * matrixB[k][j];
+				sum += (int64_t)matrixA[i][k] * matrixB[k][j];
 			}
+			matrixC[i][j] += (int)sum;
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef DENSEMATRIX_H
+#define DENSEMATRIX_H
+
+#include <vector>
+
+//Row-major matrix in one contiguous buffer: row i starts at data() + i*cols().
+//Unlike the int** arrays, consecutive rows are adjacent in memory, so tiles of
+//rows stream through the cache and the hardware prefetcher can follow them.
+template <typename T>
+class DenseMatrix{
+
+public:
+    DenseMatrix(int rows, int cols) : nRows(rows), nCols(cols), values((size_t)rows * cols, T(0)){}
+
+    //Copy of a jagged row-pointer array of the given shape
+    static DenseMatrix<T> fromJagged(int** a, int rows, int cols){
+        DenseMatrix<T> result(rows, cols);
+        for(int i = 0; i < rows; i++){
+            for(int j = 0; j < cols; j++){
+                result(i, j) = (T)a[i][j];
+            }
+        }
+        return result;
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+
+    T* data() { return values.data(); }
+    const T* data() const { return values.data(); }
+
+    T* row(int i) { return values.data() + (size_t)i * nCols; }
+    const T* row(int i) const { return values.data() + (size_t)i * nCols; }
+
+    T& operator()(int i, int j) { return values[(size_t)i * nCols + j]; }
+    const T& operator()(int i, int j) const { return values[(size_t)i * nCols + j]; }
+
+    void fill(T value){
+        for(size_t i = 0; i < values.size(); i++){
+            values[i] = value;
+        }
+    }
+
+private:
+    int nRows;
+    int nCols;
+    std::vector<T> values;
+};
+
+#endif
@@ -1,11 +1,108 @@
 #ifndef MATRIXMATH_H
 #define MATRIXMATH_H
 
+#include <algorithm>
+#include <cstdint>
+#include "DenseMatrix.h"
+#include "IntMatrix.h"
+
+//Instruction set used by the integer GEMM kernels
+enum class IntGemmKernel{
+    Scalar,
+    Avx2,       //vpmaddwd on 256-bit vectors
+    Avx512Vnni  //vpdpwssd (int8) and vpmaddwd (int16) on 512-bit vectors
+};
+
 class MatrixMath{
 
 public:
     MatrixMath();
+    //C += A * B. Every entry is summed in 64 bits, but the result is stored in int, so it
+    //wraps for large entries; use multiplyInt8/multiplyInt16 for exact widening products.
     void parallelMultiply2D(int** matrixA, int** matrixB, int** matrixC, int dimension);
+
+    //C = A * B for int8 entries, accumulated exactly in int32, with the rows of C split across
+    //OpenMP threads. A is n x m, B is m x p and C must be n x p. Throws std::invalid_argument if
+    //the shapes do not match or if m > INT8_MAX_DEPTH, where int32 could overflow.
+    void multiplyInt8(const IntMatrix<int8_t>& a, const IntMatrix<int8_t>& b, IntMatrix<int32_t>& c,
+                      IntGemmKernel kernel = bestIntGemmKernel());
+
+    //C = A * B for int16 entries, accumulated exactly in int64, with the rows of C split across
+    //OpenMP threads. Throws std::invalid_argument if the shapes do not match.
+    void multiplyInt16(const IntMatrix<int16_t>& a, const IntMatrix<int16_t>& b, IntMatrix<int64_t>& c,
+                       IntGemmKernel kernel = bestIntGemmKernel());
+
+    //The fastest kernel this CPU supports (checked once, at run time)
+    static IntGemmKernel bestIntGemmKernel();
+    static bool supports(IntGemmKernel kernel);
+    static const char* kernelName(IntGemmKernel kernel);
+
+    //Largest depth m for which every int8 product sum fits in int32: m * 128 * 128 <= 2^31 - 1
+    static const int INT8_MAX_DEPTH = 131071;
+
+    //C += A * B on contiguous matrices; A is n x m, B is m x p, C is n x p.
+    template <typename T>
+    void tiledMultiply(const DenseMatrix<T>& matrixA, const DenseMatrix<T>& matrixB, DenseMatrix<T>& matrixC);
+
+    //Tile sizes of tiledMultiply: a TILE_ROWS x TILE_COLS block of C stays in L1/L2 while
+    //TILE_DEPTH rows of B stream through it.
+    static const int TILE_ROWS = 64;
+    static const int TILE_COLS = 256;
+    static const int TILE_DEPTH = 128;
 };
 
-#endif
\ No newline at end of file
+//Tiled, loop-interchanged (i-k-j) multiply. The (row tile, col tile) pairs of C are shared out
+//with a collapsed static schedule, so every thread owns whole tiles of C and needs no locking.
+//Inside a tile, four rows of C are updated per row of B loaded (register blocking) and the
+//innermost loop runs over contiguous columns so it compiles to SIMD fused multiply-adds.
+template <typename T>
+void MatrixMath::tiledMultiply(const DenseMatrix<T>& matrixA, const DenseMatrix<T>& matrixB, DenseMatrix<T>& matrixC){
+    const int n = matrixA.rows();
+    const int m = matrixA.cols();
+    const int p = matrixB.cols();
+
+    #pragma omp parallel for collapse(2) schedule(static)
+    for(int ii = 0; ii < n; ii += TILE_ROWS){
+        for(int jj = 0; jj < p; jj += TILE_COLS){
+            const int iEnd = std::min(ii + TILE_ROWS, n);
+            const int jEnd = std::min(jj + TILE_COLS, p);
+            for(int kk = 0; kk < m; kk += TILE_DEPTH){
+                const int kEnd = std::min(kk + TILE_DEPTH, m);
+                int i = ii;
+                for(; i + 4 <= iEnd; i += 4){
+                    T* c0 = matrixC.row(i);
+                    T* c1 = matrixC.row(i + 1);
+                    T* c2 = matrixC.row(i + 2);
+                    T* c3 = matrixC.row(i + 3);
+                    for(int k = kk; k < kEnd; k++){
+                        const T a0 = matrixA(i, k);
+                        const T a1 = matrixA(i + 1, k);
+                        const T a2 = matrixA(i + 2, k);
+                        const T a3 = matrixA(i + 3, k);
+                        const T* b = matrixB.row(k);
+                        #pragma omp simd
+                        for(int j = jj; j < jEnd; j++){
+                            c0[j] += a0 * b[j];
+                            c1[j] += a1 * b[j];
+                            c2[j] += a2 * b[j];
+                            c3[j] += a3 * b[j];
+                        }
+                    }
+                }
+                for(; i < iEnd; i++){
+                    T* c = matrixC.row(i);
+                    for(int k = kk; k < kEnd; k++){
+                        const T a = matrixA(i, k);
+                        const T* b = matrixB.row(k);
+                        #pragma omp simd
+                        for(int j = jj; j < jEnd; j++){
+                            c[j] += a * b[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,358 @@
+#include "include/MatrixMath.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+//The SIMD kernels are compiled for their instruction set with GCC target pragmas and picked
+//at run time, so the binary still runs on CPUs without AVX2 or AVX-512.
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define INTGEMM_X86
+#include <immintrin.h>
+#endif
+
+namespace{
+
+//Cache blocking of blockedMultiply: BLOCK_DEPTH elements of a row of A and of BLOCK_COLS
+//columns of B stay in L1/L2 while every row of A is multiplied with them. A multiple of
+//IntMatrix::STRIDE_ALIGN, so every block is a whole number of SIMD steps.
+const int BLOCK_DEPTH = 2048;
+const int BLOCK_COLS = 64;
+
+//Reference kernel: plain loops with the same widening accumulator as the SIMD kernels
+template <typename TIn, typename TOut>
+struct ScalarKernel{
+    static const int ROWS = 2;
+    static const int COLS = 4;
+
+    template <int MR, int NR>
+    static void tile(const TIn* a, int aStride, const TIn* b, int bStride, int depth, TOut* c, int cStride){
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                TOut sum = 0;
+                for(int k = 0; k < depth; k++){
+                    sum += (TOut)a[r * aStride + k] * (TOut)b[s * bStride + k];
+                }
+                c[r * cStride + s] += sum;
+            }
+        }
+    }
+};
+
+#ifdef INTGEMM_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+//vpmaddwd multiplies 16 pairs of int16 and adds neighbouring products into 8 int32 lanes.
+//int8 is sign-extended to int16 on load; the int32 lanes cannot overflow below INT8_MAX_DEPTH.
+struct Avx2Int8Kernel{
+    static const int ROWS = 2;
+    static const int COLS = 4;
+
+    static __m256i load(const int8_t* p){
+        return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)p));
+    }
+
+    template <int MR, int NR>
+    static void tile(const int8_t* a, int aStride, const int8_t* b, int bStride, int depth, int32_t* c, int cStride){
+        __m256i acc[MR][NR];
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                acc[r][s] = _mm256_setzero_si256();
+            }
+        }
+        for(int k = 0; k < depth; k += 16){
+            __m256i av[MR];
+            __m256i bv[NR];
+            for(int r = 0; r < MR; r++){
+                av[r] = load(a + r * aStride + k);
+            }
+            for(int s = 0; s < NR; s++){
+                bv[s] = load(b + s * bStride + k);
+            }
+            for(int r = 0; r < MR; r++){
+                for(int s = 0; s < NR; s++){
+                    acc[r][s] = _mm256_add_epi32(acc[r][s], _mm256_madd_epi16(av[r], bv[s]));
+                }
+            }
+        }
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                alignas(32) int32_t lanes[8];
+                _mm256_store_si256((__m256i*)lanes, acc[r][s]);
+                int32_t sum = 0;
+                for(int l = 0; l < 8; l++){
+                    sum += lanes[l];
+                }
+                c[r * cStride + s] += sum;
+            }
+        }
+    }
+};
+
+//int16 products are widened to int64 after every vpmaddwd. A pair sum lies in
+//[-2^31 + 2^16, 2^31], so it only wraps when all four inputs are -32768; subtracting 2^15
+//first makes it fit in int32 exactly, and the offset is added back once per tile.
+struct Avx2Int16Kernel{
+    static const int ROWS = 2;
+    static const int COLS = 4;
+
+    template <int MR, int NR>
+    static void tile(const int16_t* a, int aStride, const int16_t* b, int bStride, int depth, int64_t* c, int cStride){
+        const __m256i offset = _mm256_set1_epi32(32768);
+        __m256i acc[MR][NR];
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                acc[r][s] = _mm256_setzero_si256();
+            }
+        }
+        for(int k = 0; k < depth; k += 16){
+            __m256i av[MR];
+            __m256i bv[NR];
+            for(int r = 0; r < MR; r++){
+                av[r] = _mm256_loadu_si256((const __m256i*)(a + r * aStride + k));
+            }
+            for(int s = 0; s < NR; s++){
+                bv[s] = _mm256_loadu_si256((const __m256i*)(b + s * bStride + k));
+            }
+            for(int r = 0; r < MR; r++){
+                for(int s = 0; s < NR; s++){
+                    const __m256i pairs = _mm256_sub_epi32(_mm256_madd_epi16(av[r], bv[s]), offset);
+                    const __m256i low = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs));
+                    const __m256i high = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1));
+                    acc[r][s] = _mm256_add_epi64(acc[r][s], _mm256_add_epi64(low, high));
+                }
+            }
+        }
+        const int64_t correction = (int64_t)(depth / 2) * 32768;
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                alignas(32) int64_t lanes[4];
+                _mm256_store_si256((__m256i*)lanes, acc[r][s]);
+                c[r * cStride + s] += lanes[0] + lanes[1] + lanes[2] + lanes[3] + correction;
+            }
+        }
+    }
+};
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512vnni")
+//GCC 12's AVX-512 headers trip -Wmaybe-uninitialized on their own _mm256_undefined_si256
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+//vpdpwssd fuses vpmaddwd with the int32 accumulation; with 32 zmm registers the tile is 4x4.
+struct Avx512Int8Kernel{
+    static const int ROWS = 4;
+    static const int COLS = 4;
+
+    static __m512i load(const int8_t* p){
+        return _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)p));
+    }
+
+    template <int MR, int NR>
+    static void tile(const int8_t* a, int aStride, const int8_t* b, int bStride, int depth, int32_t* c, int cStride){
+        __m512i acc[MR][NR];
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                acc[r][s] = _mm512_setzero_si512();
+            }
+        }
+        for(int k = 0; k < depth; k += 32){
+            __m512i av[MR];
+            __m512i bv[NR];
+            for(int r = 0; r < MR; r++){
+                av[r] = load(a + r * aStride + k);
+            }
+            for(int s = 0; s < NR; s++){
+                bv[s] = load(b + s * bStride + k);
+            }
+            for(int r = 0; r < MR; r++){
+                for(int s = 0; s < NR; s++){
+                    acc[r][s] = _mm512_dpwssd_epi32(acc[r][s], av[r], bv[s]);
+                }
+            }
+        }
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                alignas(64) int32_t lanes[16];
+                _mm512_store_si512((void*)lanes, acc[r][s]);
+                int32_t sum = 0;
+                for(int l = 0; l < 16; l++){
+                    sum += lanes[l];
+                }
+                c[r * cStride + s] += sum;
+            }
+        }
+    }
+};
+
+//Same offset-and-widen scheme as Avx2Int16Kernel, but AVX-512 has 64-bit arithmetic shifts,
+//so the even and odd int32 lanes are sign-extended in place. vpdpwssd is not used because
+//its int32 accumulator could overflow for int16 inputs.
+struct Avx512Int16Kernel{
+    static const int ROWS = 4;
+    static const int COLS = 4;
+
+    template <int MR, int NR>
+    static void tile(const int16_t* a, int aStride, const int16_t* b, int bStride, int depth, int64_t* c, int cStride){
+        const __m512i offset = _mm512_set1_epi32(32768);
+        __m512i acc[MR][NR];
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                acc[r][s] = _mm512_setzero_si512();
+            }
+        }
+        for(int k = 0; k < depth; k += 32){
+            __m512i av[MR];
+            __m512i bv[NR];
+            for(int r = 0; r < MR; r++){
+                av[r] = _mm512_loadu_si512((const void*)(a + r * aStride + k));
+            }
+            for(int s = 0; s < NR; s++){
+                bv[s] = _mm512_loadu_si512((const void*)(b + s * bStride + k));
+            }
+            for(int r = 0; r < MR; r++){
+                for(int s = 0; s < NR; s++){
+                    const __m512i pairs = _mm512_sub_epi32(_mm512_madd_epi16(av[r], bv[s]), offset);
+                    const __m512i even = _mm512_srai_epi64(_mm512_slli_epi64(pairs, 32), 32);
+                    const __m512i odd = _mm512_srai_epi64(pairs, 32);
+                    acc[r][s] = _mm512_add_epi64(acc[r][s], _mm512_add_epi64(even, odd));
+                }
+            }
+        }
+        const int64_t correction = (int64_t)(depth / 2) * 32768;
+        for(int r = 0; r < MR; r++){
+            for(int s = 0; s < NR; s++){
+                alignas(64) int64_t lanes[8];
+                _mm512_store_si512((void*)lanes, acc[r][s]);
+                int64_t sum = correction;
+                for(int l = 0; l < 8; l++){
+                    sum += lanes[l];
+                }
+                c[r * cStride + s] += sum;
+            }
+        }
+    }
+};
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+//Calls Kernel::tile with the edge tile shape as template arguments, so the accumulators of
+//every shape are fixed-size arrays the compiler keeps in registers.
+template <class Kernel, int MR, typename TIn, typename TOut>
+void tileColumns(int nr, const TIn* a, int aStride, const TIn* b, int bStride, int depth, TOut* c, int cStride){
+    switch(nr){
+        case 1: Kernel::template tile<MR, 1>(a, aStride, b, bStride, depth, c, cStride); break;
+        case 2: Kernel::template tile<MR, 2>(a, aStride, b, bStride, depth, c, cStride); break;
+        case 3: Kernel::template tile<MR, 3>(a, aStride, b, bStride, depth, c, cStride); break;
+        default: Kernel::template tile<MR, 4>(a, aStride, b, bStride, depth, c, cStride); break;
+    }
+}
+
+template <class Kernel, typename TIn, typename TOut>
+void tileDispatch(int mr, int nr, const TIn* a, int aStride, const TIn* b, int bStride, int depth, TOut* c, int cStride){
+    switch(mr){
+        case 1: tileColumns<Kernel, 1>(nr, a, aStride, b, bStride, depth, c, cStride); break;
+        case 2: tileColumns<Kernel, 2>(nr, a, aStride, b, bStride, depth, c, cStride); break;
+        case 3: tileColumns<Kernel, 3>(nr, a, aStride, b, bStride, depth, c, cStride); break;
+        default: tileColumns<Kernel, 4>(nr, a, aStride, b, bStride, depth, c, cStride); break;
+    }
+}
+
+//C = A * B with B already transposed, so that both operands of every dot product are
+//contiguous, zero-padded rows. Kernel::ROWS x Kernel::COLS tiles of C are accumulated over
+//BLOCK_DEPTH slices of the depth, one BLOCK_COLS panel of B at a time.
+template <class Kernel, typename TIn, typename TOut>
+void blockedMultiply(const IntMatrix<TIn>& a, const IntMatrix<TIn>& bt, IntMatrix<TOut>& c){
+    const int n = a.rows();
+    const int p = bt.rows();
+    const int paddedDepth = a.stride();
+    for(int i = 0; i < n; i++){
+        std::fill(c.row(i), c.row(i) + c.stride(), TOut(0));
+    }
+    for(int kk = 0; kk < paddedDepth; kk += BLOCK_DEPTH){
+        const int depth = std::min(BLOCK_DEPTH, paddedDepth - kk);
+        for(int jj = 0; jj < p; jj += BLOCK_COLS){
+            const int jEnd = std::min(jj + BLOCK_COLS, p);
+            for(int i = 0; i < n; i += Kernel::ROWS){
+                const int mr = std::min(Kernel::ROWS, n - i);
+                for(int j = jj; j < jEnd; j += Kernel::COLS){
+                    const int nr = std::min(Kernel::COLS, jEnd - j);
+                    tileDispatch<Kernel>(mr, nr, a.row(i) + kk, a.stride(), bt.row(j) + kk, bt.stride(), depth, &c(i, j), c.stride());
+                }
+            }
+        }
+    }
+}
+
+template <typename TIn, typename TOut>
+void checkShapes(const IntMatrix<TIn>& a, const IntMatrix<TIn>& b, const IntMatrix<TOut>& c, IntGemmKernel kernel){
+    if(a.cols() != b.rows() || c.rows() != a.rows() || c.cols() != b.cols()){
+        throw std::invalid_argument("integer GEMM: matrix shapes do not match");
+    }
+    if(!MatrixMath::supports(kernel)){
+        throw std::invalid_argument(std::string("integer GEMM: this CPU does not support the ") + MatrixMath::kernelName(kernel) + " kernel");
+    }
+}
+
+}
+
+void MatrixMath::multiplyInt8(const IntMatrix<int8_t>& a, const IntMatrix<int8_t>& b, IntMatrix<int32_t>& c, IntGemmKernel kernel){
+    checkShapes(a, b, c, kernel);
+    if(a.cols() > INT8_MAX_DEPTH){
+        throw std::invalid_argument("integer GEMM: int8 depth too large for int32 accumulation");
+    }
+    const IntMatrix<int8_t> bt = b.transposed();
+    switch(kernel){
+#ifdef INTGEMM_X86
+        case IntGemmKernel::Avx512Vnni: blockedMultiply<Avx512Int8Kernel>(a, bt, c); break;
+        case IntGemmKernel::Avx2: blockedMultiply<Avx2Int8Kernel>(a, bt, c); break;
+#endif
+        default: blockedMultiply<ScalarKernel<int8_t, int32_t> >(a, bt, c); break;
+    }
+}
+
+void MatrixMath::multiplyInt16(const IntMatrix<int16_t>& a, const IntMatrix<int16_t>& b, IntMatrix<int64_t>& c, IntGemmKernel kernel){
+    checkShapes(a, b, c, kernel);
+    const IntMatrix<int16_t> bt = b.transposed();
+    switch(kernel){
+#ifdef INTGEMM_X86
+        case IntGemmKernel::Avx512Vnni: blockedMultiply<Avx512Int16Kernel>(a, bt, c); break;
+        case IntGemmKernel::Avx2: blockedMultiply<Avx2Int16Kernel>(a, bt, c); break;
+#endif
+        default: blockedMultiply<ScalarKernel<int16_t, int64_t> >(a, bt, c); break;
+    }
+}
+
+bool MatrixMath::supports(IntGemmKernel kernel){
+    switch(kernel){
+        case IntGemmKernel::Scalar:
+            return true;
+#ifdef INTGEMM_X86
+        case IntGemmKernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case IntGemmKernel::Avx512Vnni:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni");
+#endif
+        default:
+            return false;
+    }
+}
+
+IntGemmKernel MatrixMath::bestIntGemmKernel(){
+    static const IntGemmKernel best = supports(IntGemmKernel::Avx512Vnni) ? IntGemmKernel::Avx512Vnni
+                                    : supports(IntGemmKernel::Avx2) ? IntGemmKernel::Avx2
+                                    : IntGemmKernel::Scalar;
+    return best;
+}
+
+const char* MatrixMath::kernelName(IntGemmKernel kernel){
+    switch(kernel){
+        case IntGemmKernel::Avx2: return "AVX2";
+        case IntGemmKernel::Avx512Vnni: return "AVX-512 VNNI";
+        default: return "scalar";
+    }
+}
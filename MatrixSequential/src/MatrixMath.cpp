@@ -1,4 +1,4 @@
-#include "include\MatrixMath.h"
+#include "include/MatrixMath.h"
 
 MatrixMath::MatrixMath(){}
 
@@ -22,11 +22,12 @@ int** MatrixMath::multiply2D(int **a, int **b, int rowA, int colB, int m){
     for(int i = 0; i < rowA; i++){
        c[i] = new int[colB];
        for(int j = 0; j < colB; j++){
+           int sum = 0;
            for(int k = 0; k < m; k++){
-               c[i][j] += a[i][k] * b[k][j];
+               sum += a[i][k] * b[k][j];
            }
+           c[i][j] = sum;
        }
    }
    return c;
 }
-
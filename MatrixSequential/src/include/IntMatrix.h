@@ -0,0 +1,60 @@
+#ifndef INTMATRIX_H
+#define INTMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Row-major integer matrix in one contiguous buffer. Every row is padded with zeros to a
+//multiple of STRIDE_ALIGN elements, so the integer GEMM kernels can read whole SIMD vectors
+//of any row without a remainder loop: row i starts at data() + i*stride().
+template <typename T>
+class IntMatrix{
+
+public:
+    static const int STRIDE_ALIGN = 64;
+
+    IntMatrix(int rows, int cols) : nRows(rows), nCols(cols),
+        nStride((cols + STRIDE_ALIGN - 1) / STRIDE_ALIGN * STRIDE_ALIGN),
+        values((size_t)rows * nStride, T(0)){}
+
+    //Copy of a jagged row-pointer array of the given shape; values are converted with a plain cast
+    static IntMatrix<T> fromJagged(int** a, int rows, int cols){
+        IntMatrix<T> result(rows, cols);
+        for(int i = 0; i < rows; i++){
+            for(int j = 0; j < cols; j++){
+                result(i, j) = (T)a[i][j];
+            }
+        }
+        return result;
+    }
+
+    //Copy with rows and columns swapped
+    IntMatrix<T> transposed() const{
+        IntMatrix<T> result(nCols, nRows);
+        for(int i = 0; i < nRows; i++){
+            for(int j = 0; j < nCols; j++){
+                result(j, i) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    int stride() const { return nStride; }
+
+    T* row(int i) { return values.data() + (size_t)i * nStride; }
+    const T* row(int i) const { return values.data() + (size_t)i * nStride; }
+
+    T& operator()(int i, int j) { return values[(size_t)i * nStride + j]; }
+    const T& operator()(int i, int j) const { return values[(size_t)i * nStride + j]; }
+
+private:
+    int nRows;
+    int nCols;
+    int nStride;
+    std::vector<T> values;
+};
+
+#endif
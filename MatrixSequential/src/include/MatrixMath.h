@@ -1,6 +1,16 @@
 #ifndef MATRIXMATH_H
 #define MATRIXMATH_H
 
+#include <cstdint>
+#include "IntMatrix.h"
+
+//Instruction set used by the integer GEMM kernels
+enum class IntGemmKernel{
+    Scalar,
+    Avx2,       //vpmaddwd on 256-bit vectors
+    Avx512Vnni  //vpdpwssd (int8) and vpmaddwd (int16) on 512-bit vectors
+};
+
 class MatrixMath{
 
 
@@ -8,8 +18,28 @@ public:
     MatrixMath();
 
     int** add2D(int **a, int **b, int row, int col);
+    //The product is accumulated and returned in int, so it overflows for large entries;
+    //use multiplyInt8/multiplyInt16 for exact widening products.
     int** multiply2D(int **a, int **b, int rowA, int colB, int m);
 
+    //C = A * B for int8 entries, accumulated exactly in int32. A is n x m, B is m x p and
+    //C must be n x p. Throws std::invalid_argument if the shapes do not match or if
+    //m > INT8_MAX_DEPTH, where int32 could overflow.
+    void multiplyInt8(const IntMatrix<int8_t>& a, const IntMatrix<int8_t>& b, IntMatrix<int32_t>& c,
+                      IntGemmKernel kernel = bestIntGemmKernel());
+
+    //C = A * B for int16 entries, accumulated exactly in int64. Throws std::invalid_argument
+    //if the shapes do not match.
+    void multiplyInt16(const IntMatrix<int16_t>& a, const IntMatrix<int16_t>& b, IntMatrix<int64_t>& c,
+                       IntGemmKernel kernel = bestIntGemmKernel());
+
+    //The fastest kernel this CPU supports (checked once, at run time)
+    static IntGemmKernel bestIntGemmKernel();
+    static bool supports(IntGemmKernel kernel);
+    static const char* kernelName(IntGemmKernel kernel);
+
+    //Largest depth m for which every int8 product sum fits in int32: m * 128 * 128 <= 2^31 - 1
+    static const int INT8_MAX_DEPTH = 131071;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,96 +2,182 @@
 #define MESSAGEQUEUEHPP
 
 #include <list>
+#include <deque>
+#include <functional>
 #include <shared_mutex>
 #include <mutex>
+#include <vector>
 #include "MessageQueueItem.hpp"
 
 template <typename TMessage>
 class Client;
 
+/**
+ * @brief Message counts of one client: messages routed to it so far, and messages it has taken (next or drain).
+ */
+struct ClientTraffic
+{
+    std::size_t delivered = 0;
+    std::size_t received = 0;
+};
+
+/**
+ * @brief A queue that routes every message to the clients subscribed to its tag.
+ *
+ * A sender attaches a tag to each message (e.g. its block index), and each client subscribes with a predicate on
+ * tags; by default a client accepts every tag. On enqueue the message is routed once into the inbox of every
+ * subscribed client other than its sender, so a client only ever looks at the messages it asked for, in the order
+ * they were enqueued. A client that subscribes late also receives the matching messages enqueued before it.
+ */
 template <typename TMessage>
 class MessageQueue
 {
 private:
+    using Item = typename std::list<MessageQueueItem<TMessage>>::const_iterator;
+
+    struct Subscriber
+    {
+        std::function<bool(std::size_t)> accepts;
+        std::deque<Item> inbox;
+        ClientTraffic traffic;
+    };
+
     std::list<MessageQueueItem<TMessage>> list{};
+    std::deque<Subscriber> subscribers{};
     std::shared_mutex mutex;
-    std::size_t nextClientId = 0;
+
+    /**
+     * @brief Put a message into the inbox of a subscriber if it accepts it. Called with the mutex held exclusively.
+     */
+    void route(Item item, std::size_t clientId)
+    {
+        Subscriber &subscriber = subscribers[clientId];
+        if (item->clientId != clientId && subscriber.accepts(item->tag))
+        {
+            subscriber.inbox.push_back(item);
+            ++subscriber.traffic.delivered;
+        }
+    };
+
+    /**
+     * @brief Pop the oldest message of a subscriber's inbox. Called with the mutex held exclusively, since it
+     * changes the inbox and the traffic counts.
+     */
+    const TMessage take(Subscriber &subscriber)
+    {
+        const TMessage content = subscriber.inbox.front()->content;
+        subscriber.inbox.pop_front();
+        ++subscriber.traffic.received;
+        return content;
+    };
 
 public:
     MessageQueue()
     {
-        list.emplace_back(TMessage(), -1);
     }
 
+    /**
+     * @brief A client that receives every message but its own.
+     */
     Client<TMessage> getClient()
+    {
+        return getClient([](std::size_t)
+                         { return true; });
+    };
+
+    /**
+     * @brief A client that receives the messages, other than its own, whose tag satisfies subscription.
+     */
+    Client<TMessage> getClient(std::function<bool(std::size_t)> subscription)
     {
         std::unique_lock lock(mutex);
-        Client<TMessage> client(nextClientId, list.begin());
-        ++nextClientId;
-        return client;
+        const std::size_t clientId = subscribers.size();
+        subscribers.push_back(Subscriber{std::move(subscription), {}, {}});
+        for (Item item = list.begin(); item != list.end(); ++item)
+        {
+            route(item, clientId);
+        }
+        return Client<TMessage>(clientId);
     };
 
-    void enqueue(const TMessage content, const Client<TMessage> &client)
+    void enqueue(const TMessage content, const Client<TMessage> &client, std::size_t tag = 0)
     {
         std::unique_lock lock(mutex);
-        list.emplace_back(content, client.clientId);
+        list.emplace_back(content, client.clientId, tag);
+        const Item item = std::prev(list.end());
+        for (std::size_t clientId = 0; clientId != subscribers.size(); ++clientId)
+        {
+            route(item, clientId);
+        }
     };
 
+    /**
+     * @brief Whether a message is available to the client. Only reads, so it shares the lock with other readers;
+     * next and drain take it exclusively.
+     */
     bool hasNext(Client<TMessage> &client)
     {
         std::shared_lock lock(mutex);
-        if (list.empty())
-        {
-            return false;
-        }
-        return client.hasNext(list.begin(), list.end());
+        return !subscribers[client.clientId].inbox.empty();
     };
 
     const TMessage next(Client<TMessage> &client)
     {
-        std::shared_lock lock(mutex);
-        if (list.empty())
+        std::unique_lock lock(mutex);
+        Subscriber &subscriber = subscribers[client.clientId];
+        if (subscriber.inbox.empty())
         {
             return TMessage();
         }
-        return client.consume(list.begin(), list.end());
+        return take(subscriber);
     };
-};
-
-template <typename TMessage>
-class Client
-{
-    friend class MessageQueue<TMessage>;
-
-private:
-    std::size_t clientId;
-    typename std::list<MessageQueueItem<TMessage>>::iterator it;
-    bool consumed = true;
 
-    void advance(typename std::list<MessageQueueItem<TMessage>>::iterator beg, typename std::list<MessageQueueItem<TMessage>>::iterator end)
+    /**
+     * @brief Append every message currently available to the client to out, in queue order, under a single lock.
+     *
+     * @return The number of messages appended; 0 if none was available.
+     */
+    std::size_t drain(Client<TMessage> &client, std::vector<TMessage> &out)
     {
-        while (consumed && std::next(it) != end)
+        std::unique_lock lock(mutex);
+        Subscriber &subscriber = subscribers[client.clientId];
+        const std::size_t count = subscriber.inbox.size();
+        while (!subscriber.inbox.empty())
         {
-            ++it;
-            consumed = (it->clientId == clientId);
+            out.push_back(take(subscriber));
         }
+        return count;
     };
 
-    const TMessage consume(typename std::list<MessageQueueItem<TMessage>>::iterator beg, typename std::list<MessageQueueItem<TMessage>>::iterator end)
+    /**
+     * @brief The message counts of a client so far.
+     */
+    ClientTraffic traffic(const Client<TMessage> &client)
     {
-        advance(beg, end);
-        consumed = true;
-        return it->content;
+        std::unique_lock lock(mutex);
+        return subscribers[client.clientId].traffic;
     };
 
-    bool hasNext(typename std::list<MessageQueueItem<TMessage>>::iterator beg, typename std::list<MessageQueueItem<TMessage>>::iterator end)
+    /**
+     * @brief The number of messages enqueued by all clients so far.
+     */
+    std::size_t published()
     {
-        advance(beg, end);
-        return !consumed;
+        std::shared_lock lock(mutex);
+        return list.size();
     };
+};
+
+template <typename TMessage>
+class Client
+{
+    friend class MessageQueue<TMessage>;
+
+private:
+    std::size_t clientId;
 
 public:
-    Client(std::size_t clientId, typename std::list<MessageQueueItem<TMessage>>::iterator it) : clientId(clientId), it(it){};
+    explicit Client(std::size_t clientId) : clientId(clientId){};
 };
 
 #endif
@@ -6,7 +6,8 @@ struct MessageQueueItem
 {
     const TMessage content;
     const std::size_t clientId;
-    MessageQueueItem(const TMessage content, std::size_t clientId) : content(content), clientId(clientId){};
+    const std::size_t tag;
+    MessageQueueItem(const TMessage content, std::size_t clientId, std::size_t tag) : content(content), clientId(clientId), tag(tag){};
 };
 
 #endif
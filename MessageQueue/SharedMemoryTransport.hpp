@@ -0,0 +1,187 @@
+#ifndef SHAREDMEMORYTRANSPORTHPP
+#define SHAREDMEMORYTRANSPORTHPP
+
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Transport.hpp"
+
+/**
+ * @brief Transport between processes on one host through a POSIX shared-memory log of message slots.
+ *
+ * The region holds a header and capacity slots. A publisher reserves the next slot with an atomic increment,
+ * copies its message in and then sets the slot's ready flag; every rank reads the slots in order, waiting for each
+ * ready flag and skipping its own messages. Slots are never reused, so the capacity must cover every message of
+ * the run (N messages for an N by N Cholesky factorization).
+ *
+ * One process creates the region with create() before the ranks attach by name; remove() unlinks it.
+ *
+ * @tparam TScalar The scalar type (trivially copyable)
+ */
+template <typename TScalar>
+class SharedMemoryTransport : public Transport<TScalar>
+{
+private:
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared-memory atomics must be lock-free");
+
+    struct Header
+    {
+        std::atomic<std::uint64_t> reserved;
+        std::uint64_t capacity;
+        std::uint64_t messageLength;
+    };
+
+    struct SlotHeader
+    {
+        std::atomic<std::uint32_t> ready;
+        std::uint32_t origin;
+    };
+
+    std::uint32_t rank;
+    void *region;
+    std::size_t regionBytes;
+    std::uint64_t cursor = 0;
+
+    static std::size_t slotBytes(std::size_t messageLength)
+    {
+        const std::size_t bytes = sizeof(SlotHeader) + messageLength * sizeof(TScalar);
+        return (bytes + 63) / 64 * 64;
+    };
+
+    static std::size_t totalBytes(std::size_t capacity, std::size_t messageLength)
+    {
+        return 64 + capacity * slotBytes(messageLength);
+    };
+
+    Header &header() const
+    {
+        return *static_cast<Header *>(region);
+    };
+
+    SlotHeader &slot(std::uint64_t index) const
+    {
+        return *reinterpret_cast<SlotHeader *>(static_cast<char *>(region) + 64 + index * slotBytes(this->messageLength()));
+    };
+
+    TScalar *slotData(std::uint64_t index) const
+    {
+        return reinterpret_cast<TScalar *>(&slot(index) + 1);
+    };
+
+    static void *map(const std::string &name, int flags, std::size_t &bytes)
+    {
+        const int fd = ::shm_open(name.c_str(), flags, 0600);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open shared memory " + name + ": " + std::strerror(errno));
+        }
+        if ((flags & O_CREAT) && ::ftruncate(fd, bytes) != 0)
+        {
+            const std::string error = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Cannot size shared memory " + name + ": " + error);
+        }
+        struct stat status;
+        ::fstat(fd, &status);
+        bytes = status.st_size;
+        void *address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED)
+        {
+            throw std::runtime_error("Cannot map shared memory " + name + ": " + std::strerror(errno));
+        }
+        return address;
+    };
+
+public:
+    /**
+     * @brief Create (or recreate) the shared region for capacity messages of messageLength scalars.
+     *
+     * @param name The POSIX shared-memory name, e.g. "/cholesky_1234".
+     */
+    static void create(const std::string &name, std::size_t capacity, std::size_t messageLength)
+    {
+        std::size_t bytes = totalBytes(capacity, messageLength);
+        void *address = map(name, O_RDWR | O_CREAT | O_TRUNC, bytes);
+        Header *created = new (address) Header();
+        created->reserved.store(0);
+        created->capacity = capacity;
+        created->messageLength = messageLength;
+        for (std::size_t i = 0; i != capacity; ++i)
+        {
+            SlotHeader *slot = new (static_cast<char *>(address) + 64 + i * slotBytes(messageLength)) SlotHeader();
+            slot->ready.store(0);
+        }
+        ::munmap(address, bytes);
+    };
+
+    /**
+     * @brief Unlink the shared region; ranks that are attached keep their mapping.
+     */
+    static void remove(const std::string &name)
+    {
+        ::shm_unlink(name.c_str());
+    };
+
+    /**
+     * @brief Attach rank to the region created under name.
+     */
+    SharedMemoryTransport(const std::string &name, std::size_t rank, std::size_t messageLength) : Transport<TScalar>(messageLength), rank((std::uint32_t)rank), regionBytes(0)
+    {
+        region = map(name, O_RDWR, regionBytes);
+        if (header().messageLength != messageLength)
+        {
+            ::munmap(region, regionBytes);
+            throw std::runtime_error("Shared memory " + name + " was created for another message length");
+        }
+    };
+
+    ~SharedMemoryTransport()
+    {
+        ::munmap(region, regionBytes);
+    };
+
+    void publish(const TScalar *message) override
+    {
+        const std::uint64_t index = header().reserved.fetch_add(1);
+        if (index >= header().capacity)
+        {
+            throw std::runtime_error("Shared-memory transport is full");
+        }
+        std::memcpy(slotData(index), message, this->messageLength() * sizeof(TScalar));
+        slot(index).origin = rank;
+        slot(index).ready.store(1, std::memory_order_release);
+    };
+
+    void receive(TScalar *message) override
+    {
+        while (true)
+        {
+            if (cursor >= header().capacity)
+            {
+                throw std::runtime_error("Shared-memory transport has no more messages");
+            }
+            SlotHeader &next = slot(cursor);
+            while (next.ready.load(std::memory_order_acquire) == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }
+            ++cursor;
+            if (next.origin != rank)
+            {
+                std::memcpy(message, slotData(cursor - 1), this->messageLength() * sizeof(TScalar));
+                return;
+            }
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef TCPTRANSPORTHPP
+#define TCPTRANSPORTHPP
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <stdexcept>
+#include <condition_variable>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "Transport.hpp"
+
+/**
+ * @brief Transport between processes over TCP, in a star around rank 0.
+ *
+ * Rank 0 listens on the given port and every other rank connects to it. Rank 0 relays each incoming message to all
+ * ranks but its origin while holding one mutex, and appends it to its own inbox under the same mutex, so every rank
+ * sees the same order. Each rank drains its socket on a receiver thread, which keeps the relay from blocking on a
+ * full socket buffer.
+ *
+ * Frames are a 32-bit origin rank followed by messageLength() scalars in host byte order, so all ranks must share
+ * the scalar representation.
+ *
+ * @tparam TScalar The scalar type (trivially copyable)
+ */
+template <typename TScalar>
+class TcpTransport : public Transport<TScalar>
+{
+private:
+    std::uint32_t rank;
+    std::vector<int> peers{};
+    std::vector<std::thread> receivers{};
+
+    std::mutex sendMutex;
+    std::mutex inboxMutex;
+    std::condition_variable inboxChanged;
+    std::deque<std::vector<TScalar>> inbox{};
+    std::size_t nOpenPeers = 0;
+
+    static void writeAll(int fd, const void *data, std::size_t bytes)
+    {
+        const char *position = static_cast<const char *>(data);
+        while (bytes != 0)
+        {
+            const ssize_t count = ::send(fd, position, bytes, MSG_NOSIGNAL);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                throw std::runtime_error(std::string("TCP send failed: ") + std::strerror(errno));
+            }
+            position += count;
+            bytes -= count;
+        }
+    };
+
+    /**
+     * @brief Read exactly bytes bytes; returns false if the peer closed the connection first.
+     */
+    static bool readAll(int fd, void *data, std::size_t bytes)
+    {
+        char *position = static_cast<char *>(data);
+        while (bytes != 0)
+        {
+            const ssize_t count = ::recv(fd, position, bytes, 0);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+            position += count;
+            bytes -= count;
+        }
+        return true;
+    };
+
+    void sendFrame(int fd, std::uint32_t origin, const TScalar *message)
+    {
+        writeAll(fd, &origin, sizeof(origin));
+        writeAll(fd, message, this->messageLength() * sizeof(TScalar));
+    };
+
+    /**
+     * @brief Receive frames from one peer until it disconnects. On rank 0 every frame is also relayed.
+     */
+    void receiveFrom(int fd)
+    {
+        std::vector<TScalar> message(this->messageLength());
+        std::uint32_t origin;
+        while (readAll(fd, &origin, sizeof(origin)) && readAll(fd, message.data(), message.size() * sizeof(TScalar)))
+        {
+            std::lock_guard<std::mutex> sendLock(sendMutex);
+            if (rank == 0)
+            {
+                for (std::size_t peer = 0; peer != peers.size(); ++peer)
+                {
+                    if (peer + 1 != origin)
+                    {
+                        sendFrame(peers[peer], origin, message.data());
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> inboxLock(inboxMutex);
+            inbox.push_back(message);
+            inboxChanged.notify_all();
+        }
+        std::lock_guard<std::mutex> inboxLock(inboxMutex);
+        --nOpenPeers;
+        inboxChanged.notify_all();
+    };
+
+    void startReceivers()
+    {
+        nOpenPeers = peers.size();
+        for (int fd : peers)
+        {
+            receivers.push_back(std::thread(&TcpTransport::receiveFrom, this, fd));
+        }
+    };
+
+    static void setNoDelay(int fd)
+    {
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    };
+
+public:
+    /**
+     * @brief Connect rank to the others; returns once rank 0 has accepted every rank.
+     *
+     * @param rank This rank, in [0, nRanks).
+     * @param nRanks The number of ranks.
+     * @param host The host of rank 0 (ignored on rank 0).
+     * @param port The port rank 0 listens on.
+     * @param messageLength The number of scalars per message.
+     * @param connectTimeoutSeconds How long ranks other than 0 retry while rank 0 is not listening yet.
+     */
+    TcpTransport(std::size_t rank, std::size_t nRanks, const std::string &host, std::uint16_t port, std::size_t messageLength, int connectTimeoutSeconds = 30) : Transport<TScalar>(messageLength), rank((std::uint32_t)rank)
+    {
+        if (rank == 0)
+        {
+            const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            address.sin_port = htons(port);
+            if (::bind(listener, (sockaddr *)&address, sizeof(address)) != 0 || ::listen(listener, (int)nRanks) != 0)
+            {
+                const std::string error = std::strerror(errno);
+                ::close(listener);
+                throw std::runtime_error("Cannot listen on port " + std::to_string(port) + ": " + error);
+            }
+            // peers[r - 1] is the connection to rank r.
+            peers.assign(nRanks - 1, -1);
+            for (std::size_t accepted = 0; accepted + 1 < nRanks; ++accepted)
+            {
+                const int fd = ::accept(listener, nullptr, nullptr);
+                std::uint32_t peerRank = 0;
+                if (fd < 0 || !readAll(fd, &peerRank, sizeof(peerRank)) || peerRank == 0 || peerRank >= nRanks)
+                {
+                    ::close(listener);
+                    throw std::runtime_error("Bad TCP handshake");
+                }
+                setNoDelay(fd);
+                peers[peerRank - 1] = fd;
+            }
+            ::close(listener);
+        }
+        else
+        {
+            addrinfo hints{};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo *resolved = nullptr;
+            if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &resolved) != 0)
+            {
+                throw std::runtime_error("Cannot resolve " + host);
+            }
+            int fd = -1;
+            for (int attempt = 0; fd < 0 && attempt != 100 * connectTimeoutSeconds; ++attempt)
+            {
+                fd = ::socket(AF_INET, SOCK_STREAM, 0);
+                if (::connect(fd, resolved->ai_addr, resolved->ai_addrlen) != 0)
+                {
+                    ::close(fd);
+                    fd = -1;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+            ::freeaddrinfo(resolved);
+            if (fd < 0)
+            {
+                throw std::runtime_error("Cannot connect to " + host + ":" + std::to_string(port));
+            }
+            setNoDelay(fd);
+            writeAll(fd, &this->rank, sizeof(this->rank));
+            peers.push_back(fd);
+        }
+        startReceivers();
+    };
+
+    ~TcpTransport()
+    {
+        for (int fd : peers)
+        {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        for (auto &receiver : receivers)
+        {
+            receiver.join();
+        }
+        for (int fd : peers)
+        {
+            ::close(fd);
+        }
+    };
+
+    void publish(const TScalar *message) override
+    {
+        std::lock_guard<std::mutex> sendLock(sendMutex);
+        for (int fd : peers)
+        {
+            sendFrame(fd, rank, message);
+        }
+    };
+
+    void receive(TScalar *message) override
+    {
+        std::unique_lock<std::mutex> inboxLock(inboxMutex);
+        inboxChanged.wait(inboxLock, [this]()
+                          { return !inbox.empty() || nOpenPeers == 0; });
+        if (inbox.empty())
+        {
+            throw std::runtime_error("TCP transport closed");
+        }
+        std::copy(inbox.front().begin(), inbox.front().end(), message);
+        inbox.pop_front();
+    };
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef TRANSPORTHPP
+#define TRANSPORTHPP
+
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include "MessageQueue.hpp"
+
+/**
+ * @brief One rank's endpoint of a broadcast channel for fixed-length messages of scalars.
+ *
+ * Every message published by a rank is delivered to every other rank (never back to the publisher), and all ranks
+ * receive the messages in the same order. This is the contract of MessageQueue, made independent of where the
+ * ranks run: see InProcessTransport, SharedMemoryTransport and TcpTransport.
+ *
+ * @tparam TScalar The scalar type
+ */
+template <typename TScalar>
+class Transport
+{
+private:
+    std::size_t length;
+
+public:
+    Transport(std::size_t messageLength) : length(messageLength){};
+
+    virtual ~Transport() = default;
+
+    Transport(const Transport &) = delete;
+    Transport &operator=(const Transport &) = delete;
+
+    /**
+     * @brief The number of scalars in every message.
+     */
+    std::size_t messageLength() const
+    {
+        return length;
+    };
+
+    /**
+     * @brief Send messageLength() scalars to every other rank.
+     */
+    virtual void publish(const TScalar *message) = 0;
+
+    /**
+     * @brief Block until the next message from another rank arrives and copy its messageLength() scalars out.
+     */
+    virtual void receive(TScalar *message) = 0;
+};
+
+/**
+ * @brief Transport between threads of one process, on top of a shared MessageQueue (one endpoint per thread).
+ */
+template <typename TScalar>
+class InProcessTransport : public Transport<TScalar>
+{
+private:
+    MessageQueue<std::vector<TScalar>> &messageQueue;
+    Client<std::vector<TScalar>> client;
+
+public:
+    InProcessTransport(MessageQueue<std::vector<TScalar>> &messageQueue, std::size_t messageLength) : Transport<TScalar>(messageLength), messageQueue(messageQueue), client(messageQueue.getClient()){};
+
+    void publish(const TScalar *message) override
+    {
+        messageQueue.enqueue(std::vector<TScalar>(message, message + this->messageLength()), client);
+    };
+
+    void receive(TScalar *message) override
+    {
+        while (!messageQueue.hasNext(client))
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+        const std::vector<TScalar> content = messageQueue.next(client);
+        std::copy(content.begin(), content.end(), message);
+    };
+};
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef QRHPP
+#define QRHPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+#include "../BackSubstitutionParallel/BackSubstitution.hpp"
+
+/**
+ * @brief Columns of the target handled per pass of qrApplyTranspose, so that the NB by qrUpdateTileCols block of
+ * V^T * C stays in L2 while the rows stream past it.
+ */
+constexpr std::size_t qrUpdateTileCols = 256;
+
+/**
+ * @brief Entry r of the Householder vector of column firstCol + p, as stored by qrPanel: zero above the diagonal,
+ * an implied one on it and the stored entries below it.
+ */
+template <typename TScalar>
+TScalar reflectorEntry(const TScalar *row, std::size_t r, std::size_t firstCol, std::size_t p)
+{
+    if (r < firstCol + p)
+    {
+        return 0;
+    }
+    return r == firstCol + p ? (TScalar)1 : row[firstCol + p];
+}
+
+/**
+ * @brief Factor columns firstCol to lastCol - 1 of rows firstCol to M - 1 (the panel) with unblocked Householder
+ * reflections, as in LAPACK's geqr2.
+ *
+ * Reflector j is H_j = I - tau[j] * v * v^T with v[j] = 1; the rest of v overwrites the column below the diagonal,
+ * and R[j][j] = beta overwrites the diagonal. The reflectors are only applied to the rest of the panel.
+ */
+template <typename TScalar, std::size_t M, std::size_t N>
+void qrPanel(Matrix<TScalar, M, N> &mat, std::vector<TScalar> &tau, std::size_t firstCol, std::size_t lastCol)
+{
+    std::vector<TScalar> w(lastCol);
+    for (std::size_t j = firstCol; j != lastCol; ++j)
+    {
+        TScalar *pivotRow = mat.rowData(j);
+        const TScalar alpha = pivotRow[j];
+        TScalar sigma = 0;
+        for (std::size_t r = j + 1; r != M; ++r)
+        {
+            const TScalar x = mat.rowData(r)[j];
+            sigma += x * x;
+        }
+        if (sigma == 0)
+        {
+            tau[j] = 0;
+            continue;
+        }
+        const TScalar norm = std::sqrt(alpha * alpha + sigma);
+        const TScalar beta = alpha > 0 ? -norm : norm;
+        tau[j] = (beta - alpha) / beta;
+        const TScalar scale = 1 / (alpha - beta);
+        for (std::size_t r = j + 1; r != M; ++r)
+        {
+            mat.rowData(r)[j] *= scale;
+        }
+        pivotRow[j] = beta;
+
+        // w = tau * v^T * A(j:, j+1:lastCol), then A(j:, j+1:lastCol) -= v * w.
+        for (std::size_t c = j + 1; c != lastCol; ++c)
+        {
+            w[c] = pivotRow[c];
+        }
+        for (std::size_t r = j + 1; r != M; ++r)
+        {
+            const TScalar *row = mat.rowData(r);
+            const TScalar v = row[j];
+            for (std::size_t c = j + 1; c != lastCol; ++c)
+            {
+                w[c] += v * row[c];
+            }
+        }
+        for (std::size_t c = j + 1; c != lastCol; ++c)
+        {
+            w[c] *= tau[j];
+            pivotRow[c] -= w[c];
+        }
+        for (std::size_t r = j + 1; r != M; ++r)
+        {
+            TScalar *row = mat.rowData(r);
+            const TScalar v = row[j];
+            for (std::size_t c = j + 1; c != lastCol; ++c)
+            {
+                row[c] -= v * w[c];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Form the upper-triangular T of the compact WY representation H_0 * H_1 * ... * H_{NB-1} = I - V * T * V^T
+ * of the reflectors of the panel starting at firstCol, as in LAPACK's larft (forward, columnwise).
+ */
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t NB>
+void qrBlockReflector(const Matrix<TScalar, M, N> &mat, const std::vector<TScalar> &tau, std::size_t firstCol, Matrix<TScalar, NB, NB> &t)
+{
+    // gram = V^T * V (upper triangle), accumulated row by row of V.
+    Matrix<TScalar, NB, NB> gram(0);
+    std::vector<TScalar> v(NB);
+    for (std::size_t r = firstCol; r != M; ++r)
+    {
+        const TScalar *row = mat.rowData(r);
+        const std::size_t active = std::min(r - firstCol + 1, NB);
+        for (std::size_t p = 0; p != active; ++p)
+        {
+            v[p] = reflectorEntry(row, r, firstCol, p);
+        }
+        for (std::size_t q = 0; q != active; ++q)
+        {
+            TScalar *gramRow = gram.rowData(q);
+            for (std::size_t p = q + 1; p != active; ++p)
+            {
+                gramRow[p] += v[q] * v[p];
+            }
+        }
+    }
+
+    t = Matrix<TScalar, NB, NB>(0);
+    for (std::size_t j = 0; j != NB; ++j)
+    {
+        const TScalar tauJ = tau[firstCol + j];
+        t.set(j, j, tauJ);
+        for (std::size_t i = 0; i != j; ++i)
+        {
+            TScalar sum = 0;
+            for (std::size_t l = i; l != j; ++l)
+            {
+                sum += t.get(i, l) * gram.get(l, j);
+            }
+            t.set(i, j, -tauJ * sum);
+        }
+    }
+}
+
+/**
+ * @brief C = Q^T * C = (I - V * T^T * V^T) * C for the block reflector of the panel starting at firstCol, where C is
+ * rows firstCol to M - 1 and columns firstTargetCol to NC - 1 of target.
+ *
+ * Both W = V^T * C and C -= V * W are matrix products with four rows of C per pass; the columns of C are split
+ * across threads, and every entry sees the same sequence of operations for any number of threads. target may be
+ * qr itself, as long as the columns of C lie right of the panel.
+ */
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t NB, std::size_t NC>
+void qrApplyTranspose(const Matrix<TScalar, M, N> &qr, std::size_t firstCol, const Matrix<TScalar, NB, NB> &t, Matrix<TScalar, M, NC> &target, std::size_t firstTargetCol)
+{
+    parallelForRange(NC - firstTargetCol, 4 * NB * (M - firstCol), [&qr, firstCol, &t, &target, firstTargetCol](std::size_t begin, std::size_t end)
+                     {
+                         std::vector<std::vector<TScalar>> w(NB, std::vector<TScalar>(qrUpdateTileCols));
+                         const std::size_t lastBlockedRow = firstCol + (M - firstCol) / 4 * 4;
+                         for (std::size_t firstTileCol = firstTargetCol + begin; firstTileCol < firstTargetCol + end; firstTileCol += qrUpdateTileCols)
+                         {
+                             const std::size_t width = std::min(qrUpdateTileCols, firstTargetCol + end - firstTileCol);
+                             for (auto &wRow : w)
+                             {
+                                 std::fill(wRow.begin(), wRow.begin() + width, 0);
+                             }
+
+                             // W = V^T * C
+                             std::size_t r = firstCol;
+                             for (; r != lastBlockedRow; r += 4)
+                             {
+                                 const TScalar *v0 = qr.rowData(r);
+                                 const TScalar *v1 = qr.rowData(r + 1);
+                                 const TScalar *v2 = qr.rowData(r + 2);
+                                 const TScalar *v3 = qr.rowData(r + 3);
+                                 const TScalar *c0 = target.rowData(r) + firstTileCol;
+                                 const TScalar *c1 = target.rowData(r + 1) + firstTileCol;
+                                 const TScalar *c2 = target.rowData(r + 2) + firstTileCol;
+                                 const TScalar *c3 = target.rowData(r + 3) + firstTileCol;
+                                 for (std::size_t p = 0; p != std::min(r - firstCol + 4, NB); ++p)
+                                 {
+                                     const TScalar a0 = reflectorEntry(v0, r, firstCol, p);
+                                     const TScalar a1 = reflectorEntry(v1, r + 1, firstCol, p);
+                                     const TScalar a2 = reflectorEntry(v2, r + 2, firstCol, p);
+                                     const TScalar a3 = reflectorEntry(v3, r + 3, firstCol, p);
+                                     TScalar *wRow = w[p].data();
+                                     for (std::size_t j = 0; j != width; ++j)
+                                     {
+                                         wRow[j] += a0 * c0[j] + a1 * c1[j] + a2 * c2[j] + a3 * c3[j];
+                                     }
+                                 }
+                             }
+                             for (; r != M; ++r)
+                             {
+                                 const TScalar *v0 = qr.rowData(r);
+                                 const TScalar *c0 = target.rowData(r) + firstTileCol;
+                                 for (std::size_t p = 0; p != std::min(r - firstCol + 1, NB); ++p)
+                                 {
+                                     const TScalar a0 = reflectorEntry(v0, r, firstCol, p);
+                                     TScalar *wRow = w[p].data();
+                                     for (std::size_t j = 0; j != width; ++j)
+                                     {
+                                         wRow[j] += a0 * c0[j];
+                                     }
+                                 }
+                             }
+
+                             // W = T^T * W, bottom row first so that the rows above are still unchanged.
+                             for (std::size_t step = 0; step != NB; ++step)
+                             {
+                                 const std::size_t p = NB - 1 - step;
+                                 TScalar *wRow = w[p].data();
+                                 const TScalar diagonal = t.get(p, p);
+                                 for (std::size_t j = 0; j != width; ++j)
+                                 {
+                                     wRow[j] *= diagonal;
+                                 }
+                                 for (std::size_t q = 0; q != p; ++q)
+                                 {
+                                     const TScalar tqp = t.get(q, p);
+                                     const TScalar *wOther = w[q].data();
+                                     for (std::size_t j = 0; j != width; ++j)
+                                     {
+                                         wRow[j] += tqp * wOther[j];
+                                     }
+                                 }
+                             }
+
+                             // C -= V * W
+                             r = firstCol;
+                             for (; r != lastBlockedRow; r += 4)
+                             {
+                                 const TScalar *v0 = qr.rowData(r);
+                                 const TScalar *v1 = qr.rowData(r + 1);
+                                 const TScalar *v2 = qr.rowData(r + 2);
+                                 const TScalar *v3 = qr.rowData(r + 3);
+                                 TScalar *c0 = target.rowData(r) + firstTileCol;
+                                 TScalar *c1 = target.rowData(r + 1) + firstTileCol;
+                                 TScalar *c2 = target.rowData(r + 2) + firstTileCol;
+                                 TScalar *c3 = target.rowData(r + 3) + firstTileCol;
+                                 for (std::size_t p = 0; p != std::min(r - firstCol + 4, NB); ++p)
+                                 {
+                                     const TScalar a0 = reflectorEntry(v0, r, firstCol, p);
+                                     const TScalar a1 = reflectorEntry(v1, r + 1, firstCol, p);
+                                     const TScalar a2 = reflectorEntry(v2, r + 2, firstCol, p);
+                                     const TScalar a3 = reflectorEntry(v3, r + 3, firstCol, p);
+                                     const TScalar *wRow = w[p].data();
+                                     for (std::size_t j = 0; j != width; ++j)
+                                     {
+                                         c0[j] -= a0 * wRow[j];
+                                         c1[j] -= a1 * wRow[j];
+                                         c2[j] -= a2 * wRow[j];
+                                         c3[j] -= a3 * wRow[j];
+                                     }
+                                 }
+                             }
+                             for (; r != M; ++r)
+                             {
+                                 const TScalar *v0 = qr.rowData(r);
+                                 TScalar *c0 = target.rowData(r) + firstTileCol;
+                                 for (std::size_t p = 0; p != std::min(r - firstCol + 1, NB); ++p)
+                                 {
+                                     const TScalar a0 = reflectorEntry(v0, r, firstCol, p);
+                                     const TScalar *wRow = w[p].data();
+                                     for (std::size_t j = 0; j != width; ++j)
+                                     {
+                                         c0[j] -= a0 * wRow[j];
+                                     }
+                                 }
+                             }
+                         }
+                     });
+}
+
+/**
+ * @brief Blocked Householder QR factorization, A = Q * R, in place.
+ *
+ * For every block column of width NB: factor the panel (qrPanel), form the T of its compact WY representation
+ * (qrBlockReflector) and apply Q^T to the trailing matrix (qrApplyTranspose), which carries all but a fraction
+ * NB / N of the 2 M N^2 - 2/3 N^3 flops as two matrix products and runs on all cores. Unlike the normal equations
+ * A^T * A, this never squares the condition number of A.
+ *
+ * On return the upper triangle of the first N rows holds R, the Householder vectors lie below the diagonal
+ * (unit entries implied), and blockReflectors holds the T of every panel for qrApplyTranspose.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam M Number of rows
+ * @tparam N Number of columns; at most M.
+ * @tparam NB Panel width. Must divide N.
+ * @param mat The matrix A, overwritten with R and the Householder vectors.
+ * @param tau Receives the N reflector coefficients.
+ * @param blockReflectors Receives the N / NB triangular factors T.
+ */
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t NB>
+void qrFactor(Matrix<TScalar, M, N> &mat, std::vector<TScalar> &tau, std::vector<Matrix<TScalar, NB, NB>> &blockReflectors)
+{
+    static_assert(N <= M, "QR needs at least as many rows as columns");
+    static_assert(N % NB == 0, "NB must divide N");
+    tau.assign(N, 0);
+    blockReflectors.assign(N / NB, Matrix<TScalar, NB, NB>(0));
+    for (std::size_t firstCol = 0; firstCol != N; firstCol += NB)
+    {
+        const std::size_t lastCol = firstCol + NB;
+        qrPanel(mat, tau, firstCol, lastCol);
+        Matrix<TScalar, NB, NB> &t = blockReflectors[firstCol / NB];
+        qrBlockReflector(mat, tau, firstCol, t);
+        if (lastCol != N)
+        {
+            qrApplyTranspose(mat, firstCol, t, mat, lastCol);
+        }
+    }
+}
+
+/**
+ * @brief Solve the least-squares problem min |A * X - B| from the factorization of qrFactor: apply Q^T to B block
+ * by block and solve R * X = (Q^T * B)(0:N) with the parallel back substitution (N / NBlock threads).
+ *
+ * A must have full column rank; a zero on the diagonal of R makes the solution infinite.
+ *
+ * @return Whether the back substitution completed.
+ */
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t NB, std::size_t NBlock, std::size_t K>
+bool leastSquaresSolve(const Matrix<TScalar, M, N> &qr, const std::vector<Matrix<TScalar, NB, NB>> &blockReflectors, const Matrix<TScalar, M, K> &rhs, Matrix<TScalar, N, K> &result, bool deterministic = false)
+{
+    Matrix<TScalar, M, K> transformedRhs = rhs;
+    for (std::size_t block = 0; block != N / NB; ++block)
+    {
+        qrApplyTranspose(qr, block * NB, blockReflectors[block], transformedRhs, 0);
+    }
+
+    Matrix<TScalar, N, N> upper;
+    qr.rowsInto(0, upper);
+    Matrix<TScalar, N, K> upperRhs;
+    transformedRhs.rowsInto(0, upperRhs);
+    return backSubstitutionParallel<TScalar, N, NBlock, K>(upper, upperRhs, result, deterministic);
+}
+
+#endif
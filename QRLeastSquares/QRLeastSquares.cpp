@@ -0,0 +1,84 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "QR.hpp"
+
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t K>
+void generateLeastSquaresInputs(Matrix<TScalar, M, N> &mat, Matrix<TScalar, M, K> &rhs)
+{
+    mat = randomNormal<TScalar, M, N>(11830, NormalStream, 1.0);
+    rhs = randomNormal<TScalar, M, K>(11831, NormalStream, 1.0);
+}
+
+/**
+ * @brief Factor an M by N matrix with panel width NB, solve the least-squares problem for K right hand sides with
+ * N / NBlock back-substitution threads, and report the time and GFLOP/s of each phase (2 M N^2 - 2/3 N^3 flops for
+ * the factorization, 4 M N K - N^2 K for applying Q^T and solving with R).
+ */
+template <typename TScalar, std::size_t M, std::size_t N, std::size_t NB, std::size_t NBlock, std::size_t K>
+void computeLeastSquares(const Matrix<TScalar, M, N> &mat, const Matrix<TScalar, M, K> &rhs, VerificationMode verification)
+{
+    Matrix<TScalar, M, N> qr = mat;
+    std::vector<TScalar> tau;
+    std::vector<Matrix<TScalar, NB, NB>> blockReflectors;
+
+    auto timerStart = std::chrono::steady_clock::now();
+    qrFactor<TScalar, M, N, NB>(qr, tau, blockReflectors);
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> factorSeconds = timerStop - timerStart;
+
+    Matrix<TScalar, N, K> result;
+    timerStart = std::chrono::steady_clock::now();
+    const bool solved = leastSquaresSolve<TScalar, M, N, NB, NBlock, K>(qr, blockReflectors, rhs, result);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> solveSeconds = timerStop - timerStart;
+    if (!solved)
+    {
+        std::cout << "FATAL ERROR: parallel back substitution aborted unexpectedly" << std::endl;
+        return;
+    }
+
+    auto verifyStart = std::chrono::steady_clock::now();
+    TScalar residual = leastSquaresResidual(mat, rhs, result, verification);
+    auto verifyStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> verifyMilliseconds = verifyStop - verifyStart;
+    int verifyCount = 1000 * verifyMilliseconds.count();
+
+    std::cout << "Blocked Householder QR least squares, M = " << M << ", N = " << N << ", NB = " << NB << ", K = " << K << ", solve p = " << N / NBlock << std::endl;
+    std::cout << "Factorization milliseconds: " << (int)(1000 * factorSeconds.count()) << std::endl;
+    std::cout << "Factorization GFLOP/s: " << (2.0 * M * N * N - 2.0 / 3.0 * N * N * N) / factorSeconds.count() / 1e9 << std::endl;
+    std::cout << "Solve milliseconds: " << (int)(1000 * solveSeconds.count()) << std::endl;
+    std::cout << "Solve GFLOP/s: " << (4.0 * M * N * K - 1.0 * N * N * K) / solveSeconds.count() / 1e9 << std::endl;
+    printResidual(residual, verification);
+    std::cout << "Verification milliseconds: " << verifyCount << std::endl;
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+template <std::size_t M, std::size_t N, std::size_t NB, std::size_t NBlock, std::size_t K>
+void calculateLeastSquares(VerificationMode verification)
+{
+    Matrix<float, M, N> mat;
+    Matrix<float, M, K> rhs;
+    generateLeastSquaresInputs(mat, rhs);
+    computeLeastSquares<float, M, N, NB, NBlock, K>(mat, rhs, verification);
+}
+
+int main(int argc, char **argv)
+{
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+
+    calculateLeastSquares<2048, 1024, 32, 128, 16>(verification);
+    calculateLeastSquares<2048, 1024, 64, 128, 16>(verification);
+    calculateLeastSquares<2048, 1024, 128, 128, 16>(verification);
+    // A square system is consistent: its least-squares residual vanishes.
+    calculateLeastSquares<1024, 1024, 64, 128, 16>(verification);
+
+    calculateLeastSquares<4096, 2048, 64, 256, 16>(verification);
+    calculateLeastSquares<4096, 2048, 128, 256, 16>(verification);
+}
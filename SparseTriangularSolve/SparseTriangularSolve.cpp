@@ -0,0 +1,68 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/SparseMatrix.hpp"
+#include "../Matrix/Verification.hpp"
+#include "../Matrix/TestMatrices.hpp"
+#include "../BackSubstitutionParallel/BackSubstitution.hpp"
+#include "SparseTriangularSolve.hpp"
+
+/**
+ * @brief Solve a random sparse upper-triangular system with the dense parallel back substitution (N / NBlock
+ * threads) and with the level-scheduled sparse solver, whose analysis is done once and reused for nSolves solves.
+ */
+template <typename TScalar, std::size_t N, std::size_t NBlock, std::size_t K>
+void compareSparseSolve(double density, std::size_t nSolves, VerificationMode verification)
+{
+    const Matrix<TScalar, N, N> dense = randomSparseUpperTriangular<TScalar, N>(11832, density);
+    const Matrix<TScalar, N, K> rhs = randomNormal<TScalar, N, K>(11833, NormalStream, 1.0);
+    const SparseMatrix<TScalar, N, N> sparse(dense);
+
+    Matrix<TScalar, N, K> denseResult;
+    auto timerStart = std::chrono::steady_clock::now();
+    const bool denseSolved = backSubstitutionParallel<TScalar, N, NBlock, K>(dense, rhs, denseResult);
+    auto timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> denseSeconds = timerStop - timerStart;
+
+    timerStart = std::chrono::steady_clock::now();
+    const SparseTriangularSolver<TScalar, N> solver(sparse, Triangle::Upper);
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> analysisSeconds = timerStop - timerStart;
+
+    Matrix<TScalar, N, K> sparseResult;
+    bool sparseSolved = true;
+    timerStart = std::chrono::steady_clock::now();
+    for (std::size_t solve = 0; solve != nSolves; ++solve)
+    {
+        sparseSolved = sparseSolved && solver.solve(sparse, rhs, sparseResult);
+    }
+    timerStop = std::chrono::steady_clock::now();
+    std::chrono::duration<double> sparseSeconds = (timerStop - timerStart) / nSolves;
+
+    std::cout << "Sparse upper-triangular solve, N = " << N << ", K = " << K << ", density " << 100.0 * sparse.nonZeros() / (N * N) << "%" << std::endl;
+    if (!denseSolved || !sparseSolved)
+    {
+        std::cout << "FATAL ERROR: triangular solve failed" << std::endl;
+        return;
+    }
+    std::cout << "Level sets: " << solver.levels() << " (" << (double)N / solver.levels() << " rows per level)" << std::endl;
+    std::cout << "Dense milliseconds (p = " << N / NBlock << "): " << (int)(1000 * denseSeconds.count()) << std::endl;
+    printResidual(solveResidual(dense, rhs, denseResult, verification), verification);
+    std::cout << "Analysis milliseconds: " << 1000 * analysisSeconds.count() << std::endl;
+    std::cout << "Sparse milliseconds (mean of " << nSolves << " solves): " << 1000 * sparseSeconds.count() << std::endl;
+    printResidual(solveResidual(dense, rhs, sparseResult, verification), verification);
+    std::cout << "---------------------------" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    constexpr VerificationMode verification = VerificationMode::Freivalds;
+
+    compareSparseSolve<float, 2048, 256, 16>(0.05, 10, verification);
+    compareSparseSolve<float, 2048, 256, 16>(0.01, 10, verification);
+    compareSparseSolve<float, 4096, 512, 16>(0.01, 10, verification);
+    compareSparseSolve<float, 4096, 512, 16>(0.001, 10, verification);
+}
@@ -0,0 +1,174 @@
+#ifndef SPARSETRIANGULARSOLVEHPP
+#define SPARSETRIANGULARSOLVEHPP
+
+#include <vector>
+#include <algorithm>
+
+#include "../Matrix/Matrix.hpp"
+#include "../Matrix/SparseMatrix.hpp"
+
+/**
+ * @brief Which triangle of a sparse matrix a triangular solve uses; entries in the other triangle are ignored.
+ */
+enum class Triangle
+{
+    Lower,
+    Upper
+};
+
+/**
+ * @brief Level-scheduled solver for sparse triangular systems A * X = B, with A in CSR layout.
+ *
+ * The constructor analyzes the structure of A once: unknown i depends on every unknown j with A[i][j] != 0 on the
+ * solving side of the diagonal, and its level is one more than the highest level it depends on. All unknowns of one
+ * level are independent, so solve() goes through the levels in order and splits each level's rows across threads.
+ * The analysis only depends on the structure, so one solver serves any number of solves with matrices of the same
+ * structure (e.g. refactorizations with new values) and any right hand sides.
+ *
+ * Every unknown is computed from its row in CSR order, so the result does not depend on the number of threads.
+ *
+ * @tparam TScalar The scalar type
+ * @tparam N Matrix size
+ */
+template <typename TScalar, std::size_t N>
+class SparseTriangularSolver
+{
+private:
+    Triangle triangle;
+    std::vector<std::size_t> structurePointers;
+    std::vector<std::size_t> structureIndices;
+    std::vector<std::size_t> diagonalPositions;
+    std::vector<std::size_t> levelPointers{};
+    std::vector<std::size_t> levelRows;
+    bool hasDiagonal = true;
+
+public:
+    /**
+     * @brief Analyze the structure of mat into level sets; the values of mat are not used.
+     */
+    SparseTriangularSolver(const SparseMatrix<TScalar, N, N> &mat, Triangle triangle) : triangle(triangle), structurePointers(mat.pointers()), structureIndices(mat.indices()), diagonalPositions(N), levelRows(N)
+    {
+        const std::vector<std::size_t> &pointers = structurePointers;
+        const std::vector<std::size_t> &indices = structureIndices;
+        std::vector<std::size_t> levels(N, 0);
+        std::size_t nLevels = 0;
+        for (std::size_t step = 0; step != N; ++step)
+        {
+            const std::size_t i = (triangle == Triangle::Upper) ? N - 1 - step : step;
+            std::size_t level = 0;
+            diagonalPositions[i] = pointers[i + 1];
+            for (std::size_t k = pointers[i]; k != pointers[i + 1]; ++k)
+            {
+                const std::size_t j = indices[k];
+                if (j == i)
+                {
+                    diagonalPositions[i] = k;
+                }
+                else if ((j > i) == (triangle == Triangle::Upper))
+                {
+                    level = std::max(level, levels[j] + 1);
+                }
+            }
+            hasDiagonal = hasDiagonal && diagonalPositions[i] != pointers[i + 1];
+            levels[i] = level;
+            nLevels = std::max(nLevels, level + 1);
+        }
+
+        // Counting sort of the rows by level; rows stay in increasing order within a level.
+        levelPointers.assign(nLevels + 1, 0);
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            ++levelPointers[levels[i] + 1];
+        }
+        for (std::size_t level = 0; level != nLevels; ++level)
+        {
+            levelPointers[level + 1] += levelPointers[level];
+        }
+        std::vector<std::size_t> next(levelPointers.begin(), levelPointers.end() - 1);
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            levelRows[next[levels[i]]++] = i;
+        }
+    };
+
+    /**
+     * @brief The number of level sets, i.e. the length of the longest dependency chain; N / levels() is the average
+     * number of rows that can be solved in parallel.
+     */
+    std::size_t levels() const
+    {
+        return levelPointers.size() - 1;
+    };
+
+    /**
+     * @brief Whether every row stores its diagonal entry; solve() refuses matrices without.
+     */
+    bool structurallyNonsingular() const
+    {
+        return hasDiagonal;
+    };
+
+    /**
+     * @brief Whether mat has the structure this solver was built for.
+     */
+    bool matches(const SparseMatrix<TScalar, N, N> &mat) const
+    {
+        return mat.pointers() == structurePointers && mat.indices() == structureIndices;
+    };
+
+    /**
+     * @brief Solve A * X = B, level by level.
+     *
+     * @tparam K Number of right hand sides
+     * @param mat The matrix A; must have the analyzed structure.
+     * @param rhs The right hand sides B
+     * @param result The solution X
+     * @return false if mat does not match the analyzed structure or a diagonal entry is missing.
+     */
+    template <std::size_t K>
+    bool solve(const SparseMatrix<TScalar, N, N> &mat, const Matrix<TScalar, N, K> &rhs, Matrix<TScalar, N, K> &result) const
+    {
+        if (!hasDiagonal || !matches(mat))
+        {
+            return false;
+        }
+        const std::vector<std::size_t> &pointers = mat.pointers();
+        const std::vector<std::size_t> &indices = mat.indices();
+        const std::vector<TScalar> &values = mat.values();
+        const std::size_t workPerRow = K * (mat.nonZeros() / N + 1);
+        for (std::size_t level = 0; level != levels(); ++level)
+        {
+            const std::size_t firstRow = levelPointers[level];
+            parallelForRange(levelPointers[level + 1] - firstRow, workPerRow, [this, &pointers, &indices, &values, &rhs, &result, firstRow](std::size_t begin, std::size_t end)
+                             {
+                                 for (std::size_t position = firstRow + begin; position != firstRow + end; ++position)
+                                 {
+                                     const std::size_t i = levelRows[position];
+                                     TScalar *resultRow = result.rowData(i);
+                                     std::copy(rhs.rowData(i), rhs.rowData(i) + K, resultRow);
+                                     for (std::size_t k = pointers[i]; k != pointers[i + 1]; ++k)
+                                     {
+                                         const std::size_t j = indices[k];
+                                         if (j != i && (j > i) == (triangle == Triangle::Upper))
+                                         {
+                                             const TScalar value = values[k];
+                                             const TScalar *solvedRow = result.rowData(j);
+                                             for (std::size_t n = 0; n != K; ++n)
+                                             {
+                                                 resultRow[n] -= value * solvedRow[n];
+                                             }
+                                         }
+                                     }
+                                     const TScalar diagonal = values[diagonalPositions[i]];
+                                     for (std::size_t n = 0; n != K; ++n)
+                                     {
+                                         resultRow[n] /= diagonal;
+                                     }
+                                 }
+                             });
+        }
+        return true;
+    };
+};
+
+#endif